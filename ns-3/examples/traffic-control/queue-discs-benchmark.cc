@@ -46,6 +46,10 @@
 //    /NodeList/0/ApplicationList/2/$ns3::V4Ping/Rtt=112 ms
 //    /NodeList/0/ApplicationList/2/$ns3::V4Ping/Rtt=111 ms
 //
+// followed by the number of events executed, the wall clock time taken by the
+// simulation and the number of events whose memory was allocated or recycled
+// (see the EventImplPool global value, e.g., --EventImplPool=false).
+//
 // The files output will consist of a trace file with bytes in queue and of a trace file for limits
 // (when BQL is enabled) both for bottleneck NetDevice on n2, two files with upload and download
 // goodput for flows configuration and a file with flow monitor stats.
@@ -303,7 +307,14 @@ int main (int argc, char *argv[])
   flowMonitor = flowHelper.InstallAll();
 
   Simulator::Stop (Seconds (stopTime));
+  SystemWallClockMs clock;
+  clock.Start ();
   Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  std::cout << Simulator::GetEventCount () << " events in " << elapsed << " ms, "
+            << EventImpl::GetAllocatedCount () << " events allocated, "
+            << EventImpl::GetRecycledCount () << " recycled" << std::endl;
 
   flowMonitor->SerializeToXmlFile(queueDiscType + "-flowMonitor.xml", true, true);
 
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup scheduler
+ * Measure the latency of the events scheduled by background threads in a
+ * realtime simulation.
+ *
+ * Background threads, standing for the reader threads of FdNetDevice or
+ * TapBridge, call Simulator::ScheduleWithContext at a fixed rate, while the
+ * main thread executes a population of pending events (hold model). For each
+ * event scheduled by a background thread, the program measures the time taken
+ * by the ScheduleWithContext call and the delay between the call and the
+ * execution of the event, and reports their percentiles:
+ *
+ *   ./waf --run "realtime-jitter-benchmark --threads=4 --rate=10000"
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RealtimeJitterBenchmark");
+
+namespace {
+
+/** The realtime simulator. */
+Ptr<RealtimeSimulatorImpl> g_impl;
+/** The delays between the scheduling and the execution of the events, in ns. */
+std::vector<int64_t> g_latencies;
+/** The delays between the events of the hold model. */
+Ptr<UniformRandomVariable> g_holdDelay;
+
+/**
+ * An event scheduled by a background thread: its timestamp is the real time
+ * at which it was scheduled.
+ */
+void
+Receive (void)
+{
+  g_latencies.push_back ((g_impl->RealtimeNow () - Simulator::Now ()).GetNanoSeconds ());
+}
+
+/** An event of the hold model, which schedules the next one. */
+void
+Hold (void)
+{
+  Simulator::Schedule (NanoSeconds (g_holdDelay->GetInteger ()), &Hold);
+}
+
+/** A background thread, which schedules events at a fixed rate. */
+class Producer
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param context The context of the events.
+   * \param rate The number of events per second.
+   * \param duration The duration of the transmission.
+   */
+  Producer (uint32_t context, double rate, Time duration);
+  /** The thread entry point. */
+  void Run (void);
+  /** The durations of the ScheduleWithContext calls, in ns. */
+  std::vector<int64_t> m_durations;
+
+private:
+  uint32_t m_context;   //!< The context of the events
+  double m_rate;        //!< The number of events per second
+  Time m_duration;      //!< The duration of the transmission
+};
+
+Producer::Producer (uint32_t context, double rate, Time duration)
+  : m_context (context),
+    m_rate (rate),
+    m_duration (duration)
+{
+}
+
+void
+Producer::Run (void)
+{
+  typedef std::chrono::steady_clock Clock;
+  std::chrono::nanoseconds period (static_cast<int64_t> (1e9 / m_rate));
+  Clock::time_point next = Clock::now ();
+  Clock::time_point end = next + std::chrono::nanoseconds (m_duration.GetNanoSeconds ());
+  while (next < end)
+    {
+      std::this_thread::sleep_until (next);
+      Clock::time_point start = Clock::now ();
+      Simulator::ScheduleWithContext (m_context, Seconds (0), MakeEvent (&Receive));
+      m_durations.push_back (std::chrono::duration_cast<std::chrono::nanoseconds> (Clock::now () - start).count ());
+      next += period;
+    }
+}
+
+/**
+ * Print the percentiles of a set of durations.
+ *
+ * \param name The name of the durations.
+ * \param values The durations, in ns.
+ */
+void
+PrintPercentiles (std::string name, std::vector<int64_t> values)
+{
+  if (values.empty ())
+    {
+      std::cout << name << ": no sample" << std::endl;
+      return;
+    }
+  std::sort (values.begin (), values.end ());
+  double percentiles[] = { 50, 90, 99, 99.9 };
+  const char *labels[] = { "p50", "p90", "p99", "p99.9" };
+  std::cout << name << " (us):" << std::fixed << std::setprecision (1);
+  for (uint32_t i = 0; i < sizeof (percentiles) / sizeof (percentiles[0]); i++)
+    {
+      std::size_t index = static_cast<std::size_t> (percentiles[i] / 100 * (values.size () - 1));
+      std::cout << " " << labels[i] << "=" << values[index] / 1000.0;
+    }
+  std::cout << " max=" << values.back () / 1000.0 << std::endl;
+}
+
+}  // unnamed namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t threads = 2;
+  double rate = 5000;
+  uint32_t pending = 100;
+  Time holdDelay = MilliSeconds (2);
+  Time duration = Seconds (2);
+
+  CommandLine cmd;
+  cmd.AddValue ("threads", "Number of background threads", threads);
+  cmd.AddValue ("rate", "Number of events per second scheduled by each background thread", rate);
+  cmd.AddValue ("pending", "Number of pending events of the hold model", pending);
+  cmd.AddValue ("holdDelay", "Maximum delay between the events of the hold model", holdDelay);
+  cmd.AddValue ("duration", "Duration of the simulation", duration);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+  g_impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+
+  g_holdDelay = CreateObject<UniformRandomVariable> ();
+  g_holdDelay->SetAttribute ("Max", DoubleValue (holdDelay.GetNanoSeconds ()));
+  for (uint32_t i = 0; i < pending; i++)
+    {
+      Simulator::Schedule (NanoSeconds (g_holdDelay->GetInteger ()), &Hold);
+    }
+
+  std::vector<Producer> producers;
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      producers.push_back (Producer (i, rate, duration));
+    }
+  std::vector<Ptr<SystemThread> > systemThreads;
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      systemThreads.push_back (Create<SystemThread> (MakeCallback (&Producer::Run, &producers[i])));
+      systemThreads.back ()->Start ();
+    }
+
+  // leave some time to execute the last events
+  Simulator::Stop (duration + MilliSeconds (100));
+  Simulator::Run ();
+  std::vector<int64_t> durations;
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      systemThreads[i]->Join ();
+      durations.insert (durations.end (), producers[i].m_durations.begin (), producers[i].m_durations.end ());
+    }
+
+  std::cout << Simulator::GetEventCount () << " events executed, "
+            << g_latencies.size () << " of " << durations.size ()
+            << " events of the background threads" << std::endl;
+  PrintPercentiles ("ScheduleWithContext duration", durations);
+  PrintPercentiles ("Scheduling to execution delay", g_latencies);
+
+  g_impl = 0;
+  Simulator::Destroy ();
+  return 0;
+}
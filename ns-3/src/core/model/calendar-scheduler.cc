@@ -97,7 +97,7 @@ CalendarScheduler::Hash (uint64_t ts) const
 }
 
 void
-CalendarScheduler::DoInsert (const Event &ev)
+CalendarScheduler::InsertInBucket (const Event &ev)
 {
   NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
   // calculate bucket index.
@@ -118,21 +118,29 @@ CalendarScheduler::DoInsert (const Event &ev)
 }
 
 void
-CalendarScheduler::Insert (const Event &ev)
+CalendarScheduler::DoInsert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
-  DoInsert (ev);
+  if (ev.key.m_ts < m_lastPrio)
+    {
+      // earlier than the last event removed, e.g., after the events marked
+      // as removed have been skipped: search from this event
+      m_lastPrio = ev.key.m_ts;
+      m_lastBucket = Hash (ev.key.m_ts);
+      m_bucketTop = (ev.key.m_ts / m_width + 1) * m_width;
+    }
+  InsertInBucket (ev);
   m_qSize++;
   ResizeUp ();
 }
 bool
-CalendarScheduler::IsEmpty (void) const
+CalendarScheduler::DoIsEmpty (void) const
 {
   NS_LOG_FUNCTION (this);
   return m_qSize == 0;
 }
 Scheduler::Event
-CalendarScheduler::PeekNext (void) const
+CalendarScheduler::DoPeekNext (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (!IsEmpty ());
@@ -167,7 +175,7 @@ CalendarScheduler::PeekNext (void) const
 }
 
 Scheduler::Event
-CalendarScheduler::DoRemoveNext (void)
+CalendarScheduler::RemoveEarliest (void)
 {
   NS_LOG_FUNCTION (this);
 
@@ -214,12 +222,12 @@ CalendarScheduler::DoRemoveNext (void)
 }
 
 Scheduler::Event
-CalendarScheduler::RemoveNext (void)
+CalendarScheduler::DoRemoveNext (void)
 {
   NS_LOG_FUNCTION (this << m_lastBucket << m_bucketTop);
   NS_ASSERT (!IsEmpty ());
 
-  Scheduler::Event ev = DoRemoveNext ();
+  Scheduler::Event ev = RemoveEarliest ();
   NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts <<
                 ", key=" << ev.key.m_uid <<
                 ", from bucket=" << m_lastBucket);
@@ -229,7 +237,7 @@ CalendarScheduler::RemoveNext (void)
 }
 
 void
-CalendarScheduler::Remove (const Event &ev)
+CalendarScheduler::DoRemove (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   NS_ASSERT (!IsEmpty ());
@@ -307,13 +315,13 @@ CalendarScheduler::CalculateNewWidth (void)
   // gather requested events
   for (uint32_t i = 0; i < nSamples; i++)
     {
-      samples.push_back (DoRemoveNext ());
+      samples.push_back (RemoveEarliest ());
     }
   // put them back
   for (std::list<Scheduler::Event>::const_iterator i = samples.begin ();
        i != samples.end (); ++i)
     {
-      DoInsert (*i);
+      InsertInBucket (*i);
     }
 
   // restore state.
@@ -367,7 +375,7 @@ CalendarScheduler::DoResize (uint32_t newSize, uint64_t newWidth)
       Bucket::iterator end = oldBuckets[i].end ();
       for (Bucket::iterator j = oldBuckets[i].begin (); j != end; ++j)
         {
-          DoInsert (*j);
+          InsertInBucket (*j);
         }
     }
   delete [] oldBuckets;
@@ -67,14 +67,14 @@ public:
   /** Destructor. */
   virtual ~CalendarScheduler ();
 
+private:
   // Inherited
-  virtual void Insert (const Scheduler::Event &ev);
-  virtual bool IsEmpty (void) const;
-  virtual Scheduler::Event PeekNext (void) const;
-  virtual Scheduler::Event RemoveNext (void);
-  virtual void Remove (const Scheduler::Event &ev);
+  virtual void DoInsert (const Scheduler::Event &ev);
+  virtual bool DoIsEmpty (void) const;
+  virtual Scheduler::Event DoPeekNext (void) const;
+  virtual Scheduler::Event DoRemoveNext (void);
+  virtual void DoRemove (const Scheduler::Event &ev);
 
-private:
   /** Double the number of buckets if necessary. */
   void ResizeUp (void);
   /** Halve the number of buckets if necessary. */
@@ -122,13 +122,13 @@ private:
    *
    * \returns The earliest event.
    */
-  Scheduler::Event DoRemoveNext (void);
+  Scheduler::Event RemoveEarliest (void);
   /**
    * Insert a new event in to the correct bucket.
    *
    * \param [in] ev The new Event.
    */
-  void DoInsert (const Scheduler::Event &ev);
+  void InsertInBucket (const Scheduler::Event &ev);
 
   /** Calendar bucket type: a list of Events. */
   typedef std::list<Scheduler::Event> Bucket;
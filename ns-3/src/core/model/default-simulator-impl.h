@@ -29,6 +29,7 @@
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -95,18 +96,16 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The event with context pushed before this one. */
+    EventWithContext *next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events from a different context, last first.
+   *
+   * The other threads push their events with a compare-and-swap, without
+   * taking a lock, and the main thread takes all of them at once.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  std::atomic<EventWithContext *> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -20,6 +20,10 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "global-value.h"
+#include "boolean.h"
+#include "free-list-pool.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +35,27 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/**
+ * \ingroup events
+ * \brief A global switch to recycle the memory of the events.
+ */
+static GlobalValue g_eventImplPool = GlobalValue ("EventImplPool",
+                                                  "Whether the memory of the deleted events is kept in free lists and reused",
+                                                  BooleanValue (true),
+                                                  MakeBooleanChecker ());
+
+/**
+ * \ingroup events
+ * \return the registry of the pools of the events
+ */
+static FreeListPool::Registry&
+GetEventImplPools (void)
+{
+  // never destroyed, as the pools of the threads may outlive static objects
+  static FreeListPool::Registry *registry = new FreeListPool::Registry (g_eventImplPool);
+  return *registry;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +91,43 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void*
+EventImpl::operator new (std::size_t size)
+{
+  FreeListPool *pool = FreeListPool::Get<EventImpl> (GetEventImplPools ());
+  if (pool == 0)
+    {
+      return ::operator new (FreeListPool::GetBlockSize (size));
+    }
+  return pool->Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  FreeListPool *pool = FreeListPool::Get<EventImpl> (GetEventImplPools ());
+  if (pool == 0)
+    {
+      ::operator delete (p);
+      return;
+    }
+  pool->Release (p, size);
+}
+
+uint64_t
+EventImpl::GetAllocatedCount (void)
+{
+  return GetEventImplPools ().GetAllocatedCount ();
+}
+
+uint64_t
+EventImpl::GetRecycledCount (void)
+{
+  return GetEventImplPools ().GetRecycledCount ();
+}
+
 } // namespace ns3
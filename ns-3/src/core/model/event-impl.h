@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,40 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory for an event.
+   *
+   * Unless disabled through the EventImplPool global value (which is read
+   * when the first event is created), the memory of the events that are
+   * deleted is kept in free lists, one per block size, and reused to create
+   * new events, so that scheduling and executing events of any subclass
+   * (e.g., those created by MakeEvent()) does not involve the system
+   * allocator in steady state. The free lists are provided by FreeListPool,
+   * hence each thread has its own, as events may be scheduled by other
+   * threads than the one of the simulator.
+   *
+   * \param [in] size The size of the event.
+   * \returns A pointer to the allocated memory.
+   */
+  static void* operator new (std::size_t size);
+  /**
+   * Release the memory of an event.
+   *
+   * \param [in] p A pointer to the memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * \returns The number of events whose memory was obtained from the
+   * system allocator.
+   */
+  static uint64_t GetAllocatedCount (void);
+  /**
+   * \returns The number of events created in the memory of deleted events.
+   */
+  static uint64_t GetRecycledCount (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "free-list-pool.h"
+#include "global-value.h"
+#include "boolean.h"
+#include <new>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::FreeListPool implementation.
+ */
+
+namespace ns3 {
+
+FreeListPool::Registry::Registry (const GlobalValue &enabled)
+  : m_enabled (enabled),
+    m_allocated (0),
+    m_recycled (0)
+{
+}
+
+uint64_t
+FreeListPool::Registry::GetAllocatedCount (void)
+{
+  CriticalSection cs (m_mutex);
+  uint64_t count = m_allocated;
+  for (std::set<FreeListPool*>::const_iterator it = m_pools.begin (); it != m_pools.end (); it++)
+    {
+      count += (*it)->m_allocated.load (std::memory_order_relaxed);
+    }
+  return count;
+}
+
+uint64_t
+FreeListPool::Registry::GetRecycledCount (void)
+{
+  CriticalSection cs (m_mutex);
+  uint64_t count = m_recycled;
+  for (std::set<FreeListPool*>::const_iterator it = m_pools.begin (); it != m_pools.end (); it++)
+    {
+      count += (*it)->m_recycled.load (std::memory_order_relaxed);
+    }
+  return count;
+}
+
+FreeListPool::FreeListPool (Registry &registry, bool &destroyed)
+  : m_registry (registry),
+    m_destroyed (destroyed),
+    m_allocated (0),
+    m_recycled (0)
+{
+  BooleanValue enabled;
+  registry.m_enabled.GetValue (enabled);
+  m_enabled = enabled.Get ();
+  for (std::size_t i = 0; i < MAX_BLOCK_SIZE / GRANULE; i++)
+    {
+      m_freeLists[i] = 0;
+      m_nFree[i] = 0;
+    }
+  CriticalSection cs (registry.m_mutex);
+  registry.m_pools.insert (this);
+}
+
+FreeListPool::~FreeListPool ()
+{
+  {
+    CriticalSection cs (m_registry.m_mutex);
+    m_registry.m_pools.erase (this);
+    m_registry.m_allocated += m_allocated;
+    m_registry.m_recycled += m_recycled;
+  }
+  for (std::size_t i = 0; i < MAX_BLOCK_SIZE / GRANULE; i++)
+    {
+      while (m_freeLists[i] != 0)
+        {
+          FreeBlock *block = m_freeLists[i];
+          m_freeLists[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+  m_destroyed = true;
+}
+
+std::size_t
+FreeListPool::GetBlockSize (std::size_t size)
+{
+  // any block may end up in a free list, even if it was not allocated by a pool
+  if (size == 0 || size > MAX_BLOCK_SIZE)
+    {
+      return size;
+    }
+  return ((size - 1) / GRANULE + 1) * GRANULE;
+}
+
+void
+FreeListPool::Increment (Counter &counter)
+{
+  counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void*
+FreeListPool::Allocate (std::size_t size)
+{
+  if (!m_enabled || size == 0 || size > MAX_BLOCK_SIZE)
+    {
+      Increment (m_allocated);
+      return ::operator new (GetBlockSize (size));
+    }
+  std::size_t index = (size - 1) / GRANULE;
+  FreeBlock *block = m_freeLists[index];
+  if (block == 0)
+    {
+      Increment (m_allocated);
+      return ::operator new (GetBlockSize (size));
+    }
+  Increment (m_recycled);
+  m_freeLists[index] = block->next;
+  m_nFree[index]--;
+  return block;
+}
+
+void
+FreeListPool::Release (void *p, std::size_t size)
+{
+  if (!m_enabled || size == 0 || size > MAX_BLOCK_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  std::size_t index = (size - 1) / GRANULE;
+  if (m_nFree[index] >= MAX_FREE_BLOCKS)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock*> (p);
+  block->next = m_freeLists[index];
+  m_freeLists[index] = block;
+  m_nFree[index]++;
+}
+
+} // namespace ns3
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FREE_LIST_POOL_H
+#define FREE_LIST_POOL_H
+
+#include "system-mutex.h"
+#include <atomic>
+#include <cstddef>
+#include <set>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::FreeListPool declaration.
+ */
+
+namespace ns3 {
+
+class GlobalValue;
+
+/**
+ * \ingroup core
+ * \brief Free lists of the blocks of memory used to store the objects of a class
+ *
+ * A class recycling the memory of its objects (and of the objects of its
+ * subclasses) defines its own operator new and operator delete, which call
+ * Allocate and Release on the pool returned by Get.
+ *
+ * Block sizes are rounded up to a multiple of GRANULE bytes and there is a free
+ * list for every block size up to MAX_BLOCK_SIZE bytes. Larger objects are not
+ * pooled. The next pointer of a free block is stored in the block itself.
+ *
+ * Each thread has its own pool, as objects may be created by a thread and
+ * deleted by another one (e.g., the events scheduled by the reader threads of
+ * FdNetDevice). A free list keeps at most MAX_FREE_BLOCKS blocks, so that the
+ * blocks of the objects created by other threads do not accumulate.
+ */
+class FreeListPool
+{
+public:
+  /**
+   * \brief The pools of the threads allocating the objects of a class
+   *
+   * A registry is never destroyed, as the pools of the threads may outlive
+   * static objects.
+   */
+  class Registry
+  {
+  public:
+    /**
+     * \param enabled the global value (a BooleanValue) telling whether the
+     *        memory of the objects is recycled, read when a pool is created
+     */
+    Registry (const GlobalValue &enabled);
+
+    /// \return the number of blocks obtained from the system allocator by all the pools
+    uint64_t GetAllocatedCount (void);
+    /// \return the number of blocks reused by all the pools
+    uint64_t GetRecycledCount (void);
+
+  private:
+    friend class FreeListPool;
+
+    const GlobalValue &m_enabled;       //!< whether the memory of the objects is recycled
+    SystemMutex m_mutex;                //!< protects the registry
+    std::set<FreeListPool*> m_pools;    //!< the pools of the running threads
+    uint64_t m_allocated;               //!< the blocks allocated by the destroyed pools
+    uint64_t m_recycled;                //!< the blocks reused by the destroyed pools
+  };
+
+  ~FreeListPool ();
+
+  /**
+   * \tparam T the class whose objects are stored in the pool
+   * \param registry the registry of the pools of the class
+   * \return the pool of the calling thread, or a null pointer if it has been destroyed
+   */
+  template <typename T>
+  static FreeListPool* Get (Registry &registry);
+
+  /**
+   * \param size the size of the object
+   * \return a block of memory of at least the given size
+   */
+  void* Allocate (std::size_t size);
+  /**
+   * \param p the block of memory
+   * \param size the size of the object stored in the block
+   */
+  void Release (void *p, std::size_t size);
+
+  /**
+   * \param size the size of an object
+   * \return the size of the block which stores the object
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+
+private:
+  /**
+   * \param registry the registry of the pools of the class
+   * \param destroyed set when the pool is destroyed
+   */
+  FreeListPool (Registry &registry, bool &destroyed);
+
+  static const std::size_t GRANULE = 16;           //!< block size granularity
+  static const std::size_t MAX_BLOCK_SIZE = 512;   //!< largest pooled block size
+  static const uint32_t MAX_FREE_BLOCKS = 4096;    //!< largest number of free blocks of a size
+
+  /// A free block
+  struct FreeBlock
+  {
+    FreeBlock *next;   //!< the next free block of the same size
+  };
+
+  /**
+   * A counter updated by the thread of its pool only, and read by any thread.
+   */
+  typedef std::atomic<uint64_t> Counter;
+
+  /**
+   * Increment a counter of the pool.
+   * \param counter the counter
+   */
+  static void Increment (Counter &counter);
+
+  Registry &m_registry;                             //!< the registry of the pool
+  bool &m_destroyed;                                //!< set when the pool is destroyed
+  bool m_enabled;                                   //!< whether blocks are recycled
+  Counter m_allocated;                              //!< the blocks obtained from the system allocator
+  Counter m_recycled;                               //!< the blocks reused
+  FreeBlock *m_freeLists[MAX_BLOCK_SIZE / GRANULE]; //!< the free lists, indexed by block size
+  uint32_t m_nFree[MAX_BLOCK_SIZE / GRANULE];       //!< the lengths of the free lists
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+FreeListPool*
+FreeListPool::Get (Registry &registry)
+{
+  // objects deleted by the destructors of other static objects are freed
+  static thread_local bool destroyed = false;
+  static thread_local FreeListPool pool (registry, destroyed);
+  return destroyed ? 0 : &pool;
+}
+
+} // namespace ns3
+
+#endif /* FREE_LIST_POOL_H */
@@ -32,6 +32,20 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Hash");
 
+Hasher&
+GetStaticHash (void)
+{
+#ifdef NS3_MTP
+  // the hasher keeps state between clear () and GetHash*, so each thread
+  // of a multi-threaded simulation needs its own
+  static thread_local Hasher g_hasher = Hasher ();
+#else
+  static Hasher g_hasher = Hasher ();
+#endif
+  g_hasher.clear ();
+  return g_hasher;
+}
+
 Hasher::Hasher ()
 {
   m_impl = Create <Hash::Function::Murmur3> ();
@@ -181,6 +181,20 @@ private:
  **  Global functions declarations
  ************************************************/
 
+/**
+ * \ingroup hash
+ *
+ * Get a reference to the static global hasher at g_hasher
+ *
+ * The global hasher is cleared before being returned, so that the global
+ * hash functions do not need to create (and allocate) a new Hasher for every
+ * invocation. With multi-threaded simulation (NS3_MTP) each thread has its
+ * own hasher.
+ *
+ * \return Reference to the static Hasher instance.
+ */
+Hasher& GetStaticHash (void);
+
 /**
  * \ingroup hash
  *
@@ -275,28 +289,28 @@ inline
 uint32_t
 Hash32 (const char * buffer, const std::size_t size)
 {
-  return Hasher ().GetHash32 (buffer, size);
+  return GetStaticHash ().GetHash32 (buffer, size);
 }
 
 inline
 uint64_t
 Hash64 (const char * buffer, const std::size_t size)
 {
-  return Hasher ().GetHash64 (buffer, size);
+  return GetStaticHash ().GetHash64 (buffer, size);
 }
 
 inline
 uint32_t
 Hash32 (const std::string s)
 {
-  return Hasher ().GetHash32 (s);
+  return GetStaticHash ().GetHash32 (s);
 }
 
 inline
 uint64_t
 Hash64 (const std::string s)
 {
-  return Hasher ().GetHash64 (s);
+  return GetStaticHash ().GetHash64 (s);
 }
 
 
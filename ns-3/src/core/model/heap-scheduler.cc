@@ -143,17 +143,17 @@ HeapScheduler::Smallest (std::size_t a, std::size_t b) const
 }
 
 bool
-HeapScheduler::IsEmpty (void) const
+HeapScheduler::DoIsEmpty (void) const
 {
   NS_LOG_FUNCTION (this);
   return (m_heap.size () == 1) ? true : false;
 }
 
 void
-HeapScheduler::BottomUp (void)
+HeapScheduler::BottomUp (std::size_t start)
 {
-  NS_LOG_FUNCTION (this);
-  std::size_t index = Last ();
+  NS_LOG_FUNCTION (this << start);
+  std::size_t index = start;
   while (!IsRoot (index)
          && IsLessStrictly (index, Parent (index)))
     {
@@ -199,21 +199,21 @@ HeapScheduler::TopDown (std::size_t start)
 
 
 void
-HeapScheduler::Insert (const Event &ev)
+HeapScheduler::DoInsert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   m_heap.push_back (ev);
-  BottomUp ();
+  BottomUp (Last ());
 }
 
 Scheduler::Event
-HeapScheduler::PeekNext (void) const
+HeapScheduler::DoPeekNext (void) const
 {
   NS_LOG_FUNCTION (this);
   return m_heap[Root ()];
 }
 Scheduler::Event
-HeapScheduler::RemoveNext (void)
+HeapScheduler::DoRemoveNext (void)
 {
   NS_LOG_FUNCTION (this);
   Event next = m_heap[Root ()];
@@ -225,7 +225,7 @@ HeapScheduler::RemoveNext (void)
 
 
 void
-HeapScheduler::Remove (const Event &ev)
+HeapScheduler::DoRemove (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   std::size_t uid = ev.key.m_uid;
@@ -236,7 +236,21 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          if (i == m_heap.size ())
+            {
+              // the last item has been removed
+              return;
+            }
+          // the last item, moved in place of the removed one, may be smaller
+          // than the parent of the removed one
+          if (!IsRoot (i) && IsLessStrictly (i, Parent (i)))
+            {
+              BottomUp (i);
+            }
+          else
+            {
+              TopDown (i);
+            }
           return;
         }
     }
@@ -64,14 +64,14 @@ public:
   /** Destructor. */
   virtual ~HeapScheduler ();
 
+private:
   // Inherited
-  virtual void Insert (const Scheduler::Event &ev);
-  virtual bool IsEmpty (void) const;
-  virtual Scheduler::Event PeekNext (void) const;
-  virtual Scheduler::Event RemoveNext (void);
-  virtual void Remove (const Scheduler::Event &ev);
+  virtual void DoInsert (const Scheduler::Event &ev);
+  virtual bool DoIsEmpty (void) const;
+  virtual Scheduler::Event DoPeekNext (void) const;
+  virtual Scheduler::Event DoRemoveNext (void);
+  virtual void DoRemove (const Scheduler::Event &ev);
 
-private:
   /** Event list type:  vector of Events, managed as a heap. */
   typedef std::vector<Scheduler::Event> BinaryHeap;
 
@@ -151,8 +151,12 @@ private:
    * \param [in] b The second item.
    */
   inline void Exch (std::size_t a, std::size_t b);
-  /** Percolate a newly inserted Last item to its proper position. */ 
-  void BottomUp (void);
+  /**
+   * Percolate an item up to its proper position.
+   *
+   * \param [in] start Starting entry.
+   */
+  void BottomUp (std::size_t start);
   /**
    * Percolate a deletion bubble down the heap.
    *
@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the rungs are never reallocated, so that a bucket can be spread over a
+  // new rung while being referenced
+  m_rungs.reserve (MAX_RUNGS);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetRungStart (const Rung &rung) const
+{
+  if (rung.m_current < rung.m_buckets.size ())
+    {
+      return rung.m_start + rung.m_current * rung.m_width;
+    }
+  // all the buckets of the rung have been consumed
+  return std::numeric_limits<uint64_t>::max ();
+}
+
+uint32_t
+LadderScheduler::GetBucket (const Rung &rung, uint64_t ts) const
+{
+  uint64_t bucket = (ts - rung.m_start) / rung.m_width;
+  if (bucket < rung.m_buckets.size ())
+    {
+      return bucket;
+    }
+  return rung.m_buckets.size () - 1;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= GetRungStart (m_rungs[i]))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::DoInsert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+
+  m_qSize++;
+  uint64_t ts = ev.key.m_ts;
+
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+      return;
+    }
+
+  uint32_t i = FindRung (ts);
+  if (i < m_nRungs)
+    {
+      Rung &rung = m_rungs[i];
+      rung.m_buckets[GetBucket (rung, ts)].push_back (ev);
+      rung.m_nEvents++;
+      return;
+    }
+
+  NS_LOG_LOGIC ("insert in bottom");
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev), ev);
+
+  // as in the original algorithm, a crowded Bottom is spread over a new rung
+  if (m_bottom.size () > THRESHOLD && m_nRungs < MAX_RUNGS
+      && m_bottom.back ().key.m_ts > m_bottom.front ().key.m_ts)
+    {
+      SpawnRungFromBottom ();
+    }
+}
+
+bool
+LadderScheduler::DoIsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::DoPeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+
+  if (m_bottom.empty ())
+    {
+      // refilling Bottom moves events between the tiers without changing
+      // the set of scheduled events
+      const_cast<LadderScheduler *> (this)->FillBottom ();
+    }
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::DoRemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+
+  if (m_bottom.empty ())
+    {
+      FillBottom ();
+    }
+  Event ev = m_bottom.front ();
+  m_bottom.pop_front ();
+
+  if (--m_qSize == 0)
+    {
+      // the rungs are empty, the next events go into Top
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  NS_LOG_DEBUG (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::DoRemove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+
+  uint64_t ts = ev.key.m_ts;
+
+  // the bounds of Top are not updated, they are only required not to be tighter
+  // than the timestamps of the events in Top
+  if (ts >= m_topStart)
+    {
+      RemoveFromBucket (m_top, ev);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          RemoveFromBucket (rung.m_buckets[GetBucket (rung, ts)], ev);
+          rung.m_nEvents--;
+        }
+      else
+        {
+          std::deque<Event>::iterator it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev);
+          NS_ASSERT (it != m_bottom.end () && it->impl == ev.impl);
+          m_bottom.erase (it);
+        }
+    }
+
+  if (--m_qSize == 0)
+    {
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+}
+
+void
+LadderScheduler::RemoveFromBucket (Bucket &events, const Event &ev)
+{
+  for (Bucket::iterator it = events.begin (); it != events.end (); it++)
+    {
+      if (it->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (it->impl == ev.impl);
+          *it = events.back ();
+          events.pop_back ();
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Event " << ev.key.m_uid << " not found");
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t min, uint64_t max)
+{
+  NS_LOG_FUNCTION (this << events.size () << min << max);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && !events.empty () && max >= min);
+
+  if (m_rungs.size () == m_nRungs)
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs++];
+
+  // about one event per bucket, if the timestamps were uniformly distributed
+  rung.m_start = min;
+  rung.m_width = (max - min) / events.size () + 1;
+  rung.m_current = 0;
+  rung.m_nEvents = events.size ();
+  // the buckets of a rung that is no longer used are empty
+  rung.m_buckets.resize ((max - min) / rung.m_width + 1);
+
+  for (Bucket::const_iterator it = events.begin (); it != events.end (); it++)
+    {
+      rung.m_buckets[GetBucket (rung, it->key.m_ts)].push_back (*it);
+    }
+  events.clear ();
+
+  NS_LOG_LOGIC ("rung " << m_nRungs - 1 << ": " << rung.m_buckets.size ()
+                << " buckets of width " << rung.m_width << " from " << min);
+}
+
+void
+LadderScheduler::SpawnRungFromBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Bucket events (m_bottom.begin (), m_bottom.end ());
+  uint64_t min = m_bottom.front ().key.m_ts;
+  uint64_t max = m_bottom.back ().key.m_ts;
+  m_bottom.clear ();
+  SpawnRung (events, min, max);
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty () && m_qSize > 0);
+
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          // the ladder is empty, Top is moved into it
+          NS_ASSERT (!m_top.empty ());
+          m_topStart = m_topMax + 1;
+          if (m_top.size () > THRESHOLD && m_topMax > m_topMin)
+            {
+              SpawnRung (m_top, m_topMin, m_topMax);
+              continue;
+            }
+          std::sort (m_top.begin (), m_top.end ());
+          m_bottom.assign (m_top.begin (), m_top.end ());
+          m_top.clear ();
+          return;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.m_nEvents == 0)
+        {
+          // go back to the rung above, whose current bucket follows the
+          // interval of this rung
+          m_nRungs--;
+          continue;
+        }
+
+      while (rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      Bucket &bucket = rung.m_buckets[rung.m_current++];
+      rung.m_nEvents -= bucket.size ();
+
+      if (bucket.size () > THRESHOLD && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t min = bucket.front ().key.m_ts;
+          uint64_t max = min;
+          for (Bucket::const_iterator it = bucket.begin (); it != bucket.end (); it++)
+            {
+              min = std::min (min, it->key.m_ts);
+              max = std::max (max, it->key.m_ts);
+            }
+          // events with the same timestamp cannot be spread over buckets
+          if (max > min)
+            {
+              SpawnRung (bucket, min, max);
+              continue;
+            }
+        }
+
+      std::sort (bucket.begin (), bucket.end ());
+      m_bottom.assign (bucket.begin (), bucket.end ());
+      bucket.clear ();
+      return;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+#include <deque>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (ACM TOMACS, 2005). The events are kept in three tiers:
+ *
+ *  - Top, an unsorted list of the events far in the future, i.e., whose
+ *    timestamp is not smaller than the start of Top;
+ *  - the Ladder, a stack of at most MAX_RUNGS rungs, each an array of
+ *    unsorted buckets covering consecutive time intervals of the same
+ *    width. The buckets of a rung cover the interval of the bucket of the
+ *    rung above (or the interval of the events moved from Top, for the
+ *    first rung) that was too crowded to be sorted;
+ *  - Bottom, a sorted list of the events to be executed next.
+ *
+ * Events are inserted in constant time into Top or into the bucket of the
+ * first rung whose current bucket does not start after them. Bottom is only
+ * refilled once empty, by moving the first non-empty bucket of the last rung
+ * into it, sorted, if the bucket holds at most THRESHOLD events or, otherwise,
+ * by spreading the events of the bucket over a new rung. Top is moved into the
+ * first rung when the ladder is empty. The cost of sorting is hence amortized
+ * over small buckets, whatever the distribution of the timestamps, unlike the
+ * calendar queue, whose bucket width is tuned by resizing heuristics.
+ *
+ * Events with the same timestamp cannot be spread over buckets and are sorted
+ * in Bottom by their unique id, so that they are executed in the same order
+ * as with the other schedulers.
+ *
+ * Removing an event requires a search of the tier (and bucket) it belongs to,
+ * which is a binary search in Bottom and a linear search of Top or of a bucket.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  /** Maximum number of events in a bucket that is sorted into Bottom. */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs of the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+private:
+  // Inherited
+  virtual void DoInsert (const Scheduler::Event &ev);
+  virtual bool DoIsEmpty (void) const;
+  virtual Scheduler::Event DoPeekNext (void) const;
+  virtual Scheduler::Event DoRemoveNext (void);
+  virtual void DoRemove (const Scheduler::Event &ev);
+
+  /** Bucket type: an unsorted vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** Timestamp at the start of the first bucket. */
+    uint64_t m_start;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t m_width;
+    /** Index of the current bucket, the previous ones being empty. */
+    uint32_t m_current;
+    /** Number of events in the rung. */
+    uint32_t m_nEvents;
+    /** The buckets. The last one also holds the events beyond its end. */
+    std::vector<Bucket> m_buckets;
+  };
+
+  /**
+   * Get the timestamp from which the events are inserted into a rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The start of the current bucket of the rung.
+   */
+  inline uint64_t GetRungStart (const Rung &rung) const;
+  /**
+   * Get the bucket of a rung an event belongs to.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ts The timestamp of the event.
+   * \returns The index of the bucket.
+   */
+  inline uint32_t GetBucket (const Rung &rung, uint64_t ts) const;
+  /**
+   * Get the rung an event belongs to.
+   *
+   * \param [in] ts The timestamp of the event, smaller than the start of Top.
+   * \returns The index of the rung, or the number of rungs if the event
+   *          belongs to Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Add a rung to the ladder and spread the given events over its buckets.
+   *
+   * \param [in] events The events, which are moved into the new rung.
+   * \param [in] min The smallest timestamp of the events.
+   * \param [in] max The largest timestamp of the events.
+   */
+  void SpawnRung (Bucket &events, uint64_t min, uint64_t max);
+  /** Spread the events of Bottom over a new rung. */
+  void SpawnRungFromBottom (void);
+  /** Refill Bottom, which must be empty, with the next events. */
+  void FillBottom (void);
+  /**
+   * Remove an event from an unsorted list.
+   *
+   * \param [in] events The list.
+   * \param [in] ev The event.
+   */
+  void RemoveFromBucket (Bucket &events, const Scheduler::Event &ev);
+
+  /** The events far in the future. */
+  Bucket m_top;
+  /** The smallest timestamp of the events in Top, if any. */
+  uint64_t m_topMin;
+  /** The largest timestamp of the events in Top, if any. */
+  uint64_t m_topMax;
+  /** The events whose timestamp is not smaller than this one go into Top. */
+  uint64_t m_topStart;
+  /** The rungs, the first m_nRungs of which are in use. */
+  std::vector<Rung> m_rungs;
+  /** The number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The next events, sorted. */
+  std::deque<Scheduler::Event> m_bottom;
+  /** Number of events in the scheduler. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
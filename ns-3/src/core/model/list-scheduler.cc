@@ -57,9 +57,15 @@ ListScheduler::~ListScheduler ()
 }
 
 void
-ListScheduler::Insert (const Event &ev)
+ListScheduler::DoInsert (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
+  if (m_events.empty () || m_events.back ().key < ev.key)
+    {
+      // the latest event, e.g., when the event list is rebuilt
+      m_events.push_back (ev);
+      return;
+    }
   for (EventsI i = m_events.begin (); i != m_events.end (); i++)
     {
       if (ev.key < i->key)
@@ -71,20 +77,20 @@ ListScheduler::Insert (const Event &ev)
   m_events.push_back (ev);
 }
 bool
-ListScheduler::IsEmpty (void) const
+ListScheduler::DoIsEmpty (void) const
 {
   NS_LOG_FUNCTION (this);
   return m_events.empty ();
 }
 Scheduler::Event
-ListScheduler::PeekNext (void) const
+ListScheduler::DoPeekNext (void) const
 {
   NS_LOG_FUNCTION (this);
   return m_events.front ();
 }
 
 Scheduler::Event
-ListScheduler::RemoveNext (void)
+ListScheduler::DoRemoveNext (void)
 {
   NS_LOG_FUNCTION (this);
   Event next = m_events.front ();
@@ -93,7 +99,7 @@ ListScheduler::RemoveNext (void)
 }
 
 void
-ListScheduler::Remove (const Event &ev)
+ListScheduler::DoRemove (const Event &ev)
 {
   NS_LOG_FUNCTION (this << &ev);
   for (EventsI i = m_events.begin (); i != m_events.end (); i++)
@@ -57,14 +57,14 @@ public:
   /** Destructor. */
   virtual ~ListScheduler ();
 
+private:
   // Inherited
-  virtual void Insert (const Scheduler::Event &ev);
-  virtual bool IsEmpty (void) const;
-  virtual Scheduler::Event PeekNext (void) const;
-  virtual Scheduler::Event RemoveNext (void);
-  virtual void Remove (const Scheduler::Event &ev);
+  virtual void DoInsert (const Scheduler::Event &ev);
+  virtual bool DoIsEmpty (void) const;
+  virtual Scheduler::Event DoPeekNext (void) const;
+  virtual Scheduler::Event DoRemoveNext (void);
+  virtual void DoRemove (const Scheduler::Event &ev);
 
-private:
   /** Event list type: a simple list of Events. */
   typedef std::list<Scheduler::Event> Events;
   /** Events iterator. */
@@ -33,6 +33,7 @@
 #include "enum.h"
 
 
+#include <algorithm>
 #include <cmath>
 
 
@@ -91,6 +92,7 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
+  m_eventsWithContext = 0;
 
   m_main = SystemThread::Self();
 
@@ -108,6 +110,7 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -209,6 +212,15 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
       { 
         CriticalSection cs (m_mutex);
+        //
+        // This resets the synchronizer so that any future event will cause it
+        // to interrupt.  It is done before moving the events scheduled by the
+        // other threads into the event list, so that an event pushed after
+        // that does interrupt the wait below.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
+
         //
         // Since we are in realtime mode, the time to delay has got to be the 
         // difference between the current realtime and the timestamp of the next 
@@ -249,15 +261,6 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
           {
             tsDelay = tsNext - tsNow;
           }
-
-        //
-        // We've figured out how long we need to delay in order to pace the 
-        // simulation time with the real time.  We're going to sleep, but need
-        // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
-        //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -325,8 +328,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // We do know we're waiting for an event, so there had better be an event on the 
     // event queue.  Let's pull it off.  When we release the critical section, the
     // event we're working on won't be on the list and so subsequent operations won't
-    // mess with us.
+    // mess with us.  An event pushed by another thread may have come due in
+    // the meantime.
     //
+    ProcessEventsWithContext ();
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
     next = m_events->RemoveNext ();
@@ -401,7 +406,8 @@ RealtimeSimulatorImpl::IsFinished (void) const
   bool rc;
   {
     CriticalSection cs (m_mutex);
-    rc = m_events->IsEmpty () || m_stop;
+    rc = (m_events->IsEmpty () && m_eventsWithContext.load (std::memory_order_relaxed) == 0)
+      || m_stop;
   }
 
   return rc;
@@ -431,8 +437,12 @@ RealtimeSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
 
   m_stop = false;
-  m_running = true;
-  m_synchronizer->SetOrigin (m_currentTs);
+  {
+    // the other threads read the clock base in a critical section
+    CriticalSection cs (m_mutex);
+    m_running = true;
+    m_synchronizer->SetOrigin (m_currentTs);
+  }
 
   // Sleep until signalled
   uint64_t tsNow = 0;
@@ -444,6 +454,9 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        // be interrupted by the events pushed from now on
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -476,9 +489,9 @@ RealtimeSimulatorImpl::Run (void)
 
     NS_ASSERT_MSG (m_events->IsEmpty () == false || m_unscheduledEvents == 0,
                    "RealtimeSimulatorImpl::Run(): Empty queue and unprocessed events");
-  }
 
-  m_running = false;
+    m_running = false;
+  }
 }
 
 bool
@@ -544,24 +557,26 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
-  {
-    CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // Only the clock is read in the critical section, the event is pushed
+      // without the lock.
+      // 
+      uint64_t ts;
       {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
+        CriticalSection cs (m_mutex);
         ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
       }
+      PushEventWithContext (context, ts + delay.GetTimeStep (), impl);
+      return;
+    }
 
+  {
+    CriticalSection cs (m_mutex);
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
     ev.impl = impl;
@@ -610,6 +625,17 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      uint64_t ts;
+      {
+        CriticalSection cs (m_mutex);
+        ts = m_synchronizer->GetCurrentRealtime ();
+      }
+      PushEventWithContext (context, ts + time.GetTimeStep (), impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -618,6 +644,7 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
     Scheduler::Event ev;
     ev.impl = impl;
     ev.key.m_ts = ts;
+    ev.key.m_context = context;
     ev.key.m_uid = m_uid;
     m_uid++;
     m_unscheduledEvents++;
@@ -637,13 +664,25 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
+
+  //
+  // If the simulator is running, we're pacing and have a meaningful 
+  // realtime clock.  If we're not, then m_currentTs is were we stopped.
+  // 
+  if (!SystemThread::Equals (m_main))
+    {
+      uint64_t ts;
+      {
+        CriticalSection cs (m_mutex);
+        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+      }
+      PushEventWithContext (context, ts, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
-    //
-    // If the simulator is running, we're pacing and have a meaningful 
-    // realtime clock.  If we're not, then m_currentTs is were we stopped.
-    // 
     uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
     NS_ASSERT_MSG (ts >= m_currentTs, 
                    "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time < m_currentTs");
@@ -666,6 +705,58 @@ RealtimeSimulatorImpl::ScheduleRealtimeNow (EventImpl *impl)
   ScheduleRealtimeNowWithContext (GetContext (), impl);
 }
 
+void
+RealtimeSimulatorImpl::PushEventWithContext (uint32_t context, uint64_t ts, EventImpl *impl)
+{
+  EventWithContext *ev = new EventWithContext;
+  ev->context = context;
+  ev->timestamp = ts;
+  ev->event = impl;
+  ev->next = m_eventsWithContext.load (std::memory_order_relaxed);
+  while (!m_eventsWithContext.compare_exchange_weak (ev->next, ev,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed))
+    {
+    }
+  m_synchronizer->Signal ();
+}
+
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.load (std::memory_order_relaxed) == 0)
+    {
+      return;
+    }
+
+  // take all the events at once and restore their scheduling order
+  EventWithContext *pushed = m_eventsWithContext.exchange (0, std::memory_order_acquire);
+  EventWithContext *event = 0;
+  while (pushed != 0)
+    {
+      EventWithContext *next = pushed->next;
+      pushed->next = event;
+      event = pushed;
+      pushed = next;
+    }
+  while (event != 0)
+    {
+      Scheduler::Event ev;
+      ev.impl = event->event;
+      // the other threads read the clock before pushing the event, so the
+      // event may be stamped slightly before the event being executed
+      ev.key.m_ts = std::max (event->timestamp, m_currentTs);
+      ev.key.m_context = event->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+      EventWithContext *next = event->next;
+      delete event;
+      event = next;
+    }
+}
+
 Time
 RealtimeSimulatorImpl::RealtimeNow (void) const
 {
@@ -31,6 +31,7 @@
 #include "log.h"
 #include "system-mutex.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -173,6 +174,19 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Push an event scheduled by another thread than the main one.
+   *
+   * \param [in] context The event context.
+   * \param [in] ts The timestep of the event.
+   * \param [in] impl The event implementation.
+   */
+  void PushEventWithContext (uint32_t context, uint64_t ts, EventImpl *impl);
+  /**
+   * Move the events pushed by the other threads into the event list.
+   * Should be called from the main thread with #m_mutex locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -182,7 +196,10 @@ private:
   DestroyEvents m_destroyEvents;
   /** Has the stopping condition been reached? */
   bool m_stop;
-  /** Is the simulator currently running. */
+  /**
+   * Is the simulator currently running.
+   * Written by the main thread with #m_mutex locked.
+   */
   bool m_running;
 
   /**
@@ -207,6 +224,25 @@ private:
   uint64_t m_eventCount;
   /**@}*/
 
+  /** Wrap an event with its execution context. */
+  struct EventWithContext {
+    /** The event context. */
+    uint32_t context;
+    /** Event timestamp. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+    /** The event with context pushed before this one. */
+    EventWithContext *next;
+  };
+  /**
+   * The events scheduled by the other threads, last first.
+   *
+   * The other threads push their events with a compare-and-swap, without
+   * taking #m_mutex, and the main thread takes all of them at once.
+   */
+  std::atomic<EventWithContext *> m_eventsWithContext;
+
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
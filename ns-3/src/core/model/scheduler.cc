@@ -19,9 +19,14 @@
  */
 
 #include "scheduler.h"
+#include "event-impl.h"
+#include "boolean.h"
+#include "double.h"
 #include "assert.h"
 #include "log.h"
 
+#include <vector>
+
 /**
  * \file
  * \ingroup scheduler
@@ -34,6 +39,14 @@ NS_LOG_COMPONENT_DEFINE ("Scheduler");
 
 NS_OBJECT_ENSURE_REGISTERED (Scheduler);
 
+Scheduler::Scheduler ()
+  : m_lazyRemove (false),
+    m_compactionThreshold (0.5),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 Scheduler::~Scheduler ()
 {
   NS_LOG_FUNCTION (this);
@@ -45,8 +58,138 @@ Scheduler::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Scheduler")
     .SetParent<Object> ()
     .SetGroupName ("Core")
+    .AddAttribute ("LazyRemove",
+                   "Whether the removed events are only marked as removed, "
+                   "and skipped when they reach the head of the event list.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Scheduler::m_lazyRemove),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CompactionThreshold",
+                   "The fraction of the event list marked as removed above which "
+                   "the event list is rebuilt without these events (used with LazyRemove).",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&Scheduler::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
+void
+Scheduler::Insert (const Event &ev)
+{
+  DoInsert (ev);
+  m_size++;
+}
+
+bool
+Scheduler::IsEmpty (void) const
+{
+  // the event list is emptied when only marked events are left
+  return DoIsEmpty ();
+}
+
+Scheduler::Event
+Scheduler::PeekNext (void) const
+{
+  if (!m_removed.empty ())
+    {
+      // removing the marked events does not change the scheduled events
+      const_cast<Scheduler *> (this)->RemoveMarked ();
+    }
+  return DoPeekNext ();
+}
+
+Scheduler::Event
+Scheduler::RemoveNext (void)
+{
+  Event ev = DoRemoveNext ();
+  m_size--;
+  while (Unmark (ev))
+    {
+      ev.impl->Unref ();
+      ev = DoRemoveNext ();
+      m_size--;
+    }
+  if (!m_removed.empty () && m_removed.size () == m_size)
+    {
+      Compact ();
+    }
+  return ev;
+}
+
+void
+Scheduler::Remove (const Event &ev)
+{
+  if (!m_lazyRemove)
+    {
+      DoRemove (ev);
+      m_size--;
+      return;
+    }
+  // keep the event alive until it leaves the event list. The simulator
+  // cancels the removed events anyway: the marked events are only looked
+  // up if they are cancelled.
+  ev.impl->Ref ();
+  ev.impl->Cancel ();
+  m_removed.insert (ev.key.m_uid);
+  if (m_removed.size () > m_compactionThreshold * m_size
+      || m_removed.size () == m_size)
+    {
+      Compact ();
+    }
+}
+
+bool
+Scheduler::Unmark (const Event &ev)
+{
+  if (m_removed.empty () || !ev.impl->IsCancelled ())
+    {
+      return false;
+    }
+  return m_removed.erase (ev.key.m_uid) > 0;
+}
+
+void
+Scheduler::RemoveMarked (void)
+{
+  while (!DoIsEmpty ())
+    {
+      Event ev = DoPeekNext ();
+      if (!Unmark (ev))
+        {
+          return;
+        }
+      DoRemoveNext ();
+      m_size--;
+      ev.impl->Unref ();
+    }
+}
+
+void
+Scheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_size << m_removed.size ());
+  std::vector<Event> events;
+  events.reserve (m_size - m_removed.size ());
+  while (!DoIsEmpty ())
+    {
+      Event ev = DoRemoveNext ();
+      if (Unmark (ev))
+        {
+          ev.impl->Unref ();
+        }
+      else
+        {
+          events.push_back (ev);
+        }
+    }
+  NS_ASSERT (m_removed.empty ());
+  // insert the events in time order, as the simulator does
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      DoInsert (*i);
+    }
+  m_size = events.size ();
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <unordered_set>
 #include "object.h"
 
 /**
@@ -54,6 +55,19 @@ class EventImpl;
  * you need to create a subclass of this base class and implement
  * all the pure virtual methods defined here.
  *
+ * If the LazyRemove attribute is set, Remove does not search the event
+ * list: the event is only marked as removed (and cancelled), and skipped
+ * when it reaches the head of the event list. When the marked events exceed a fraction
+ * of the event list (the CompactionThreshold attribute), the event list
+ * is rebuilt without them. This makes the removal of events, e.g., of
+ * timers which are cancelled and rescheduled, independent of the number
+ * of pending events, at the cost of keeping the removed events in the
+ * event list for a while. Events are executed in the same order in both
+ * modes. As the marked events are removed from the head of the event
+ * list ahead of time, and the event list is rebuilt by removing all its
+ * events and inserting the remaining ones again in time order, a scheduler
+ * must accept events earlier than the last one it removed.
+ *
  * The only tricky aspect of this API is the memory management of
  * the EventImpl pointer which is a member of the Event data structure.
  * The lifetime of this pointer is assumed to always be longer than
@@ -95,6 +109,8 @@ public:
     EventKey key;          /**< Key for sorting and ordering Events. */
   };
 
+  /** Constructor. */
+  Scheduler ();
   /** Destructor. */
   virtual ~Scheduler () = 0;
 
@@ -103,13 +119,13 @@ public:
    *
    * \param [in] ev Event to store in the event list
    */
-  virtual void Insert (const Event &ev) = 0;
+  void Insert (const Event &ev);
   /**
    * Test if the schedule is empty.
    *
    * \returns \c true if the event list is empty and \c false otherwise.
    */
-  virtual bool IsEmpty (void) const = 0;
+  bool IsEmpty (void) const;
   /**
    * Get a pointer to the next event.
    *
@@ -118,7 +134,45 @@ public:
    * \returns A pointer to the next earliest event. The caller
    *      takes ownership of the returned pointer.
    */
-  virtual Event PeekNext (void) const = 0;
+  Event PeekNext (void) const;
+  /**
+   * Remove the earliest event from the event list.
+   *
+   * This method cannot be invoked if the list is empty.
+   *
+   * \return The Event.
+   */
+  Event RemoveNext (void);
+  /**
+   * Remove a specific event from the event list.
+   *
+   * This method cannot be invoked if the list is empty.
+   *
+   * \param [in] ev The event to remove
+   */
+  void Remove (const Event &ev);
+
+private:
+  /**
+   * Insert a new Event in the schedule.
+   *
+   * \param [in] ev Event to store in the event list
+   */
+  virtual void DoInsert (const Event &ev) = 0;
+  /**
+   * Test if the schedule is empty.
+   *
+   * \returns \c true if the event list is empty and \c false otherwise.
+   */
+  virtual bool DoIsEmpty (void) const = 0;
+  /**
+   * Get the next event.
+   *
+   * This method cannot be invoked if the list is empty.
+   *
+   * \returns The next earliest event.
+   */
+  virtual Event DoPeekNext (void) const = 0;
   /**
    * Remove the earliest event from the event list.
    *
@@ -126,7 +180,7 @@ public:
    *
    * \return The Event.
    */
-  virtual Event RemoveNext (void) = 0;
+  virtual Event DoRemoveNext (void) = 0;
   /**
    * Remove a specific event from the event list.
    *
@@ -134,7 +188,24 @@ public:
    *
    * \param [in] ev The event to remove
    */
-  virtual void Remove (const Event &ev) = 0;
+  virtual void DoRemove (const Event &ev) = 0;
+
+  /**
+   * Clear the mark of an event.
+   *
+   * \param [in] ev The event.
+   * \returns \c true if the event was marked as removed.
+   */
+  bool Unmark (const Event &ev);
+  /** Remove the events marked as removed from the head of the event list. */
+  void RemoveMarked (void);
+  /** Rebuild the event list without the events marked as removed. */
+  void Compact (void);
+
+  bool m_lazyRemove;                    //!< Whether Remove only marks the events
+  double m_compactionThreshold;         //!< The fraction of marked events which triggers a compaction
+  uint32_t m_size;                      //!< The number of events in the event list, marked or not
+  std::unordered_set<uint32_t> m_removed; //!< The uids of the events marked as removed
 };
 
 /**
@@ -28,6 +28,9 @@
 #include "unused.h"
 #include <stdint.h>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 /**
  * \file
@@ -68,6 +71,10 @@ namespace ns3 {
  *      to the object it manages exist anymore.
  *
  * Interesting users of this class include ns3::Object as well as ns3::Packet.
+ *
+ * When ns-3 is configured with --enable-mtp, the reference count is
+ * atomic, so that objects can be shared by the threads of the
+ * ns3::MultiThreadedSimulatorImpl.
  */
 template <typename T, typename PARENT = empty, typename DELETER = DefaultDeleter<T> >
 class SimpleRefCount : public PARENT
@@ -105,7 +112,11 @@ public:
   inline void Ref (void) const
   {
     NS_ASSERT (m_count < std::numeric_limits<uint32_t>::max());
+#ifdef NS3_MTP
+    m_count.fetch_add (1, std::memory_order_relaxed);
+#else
     m_count++;
+#endif
   }
   /**
    * Decrement the reference count. This method should not be called
@@ -115,8 +126,12 @@ public:
    */
   inline void Unref (void) const
   {
+#ifdef NS3_MTP
+    if (m_count.fetch_sub (1, std::memory_order_acq_rel) == 1)
+#else
     m_count--;
     if (m_count == 0)
+#endif
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
@@ -141,7 +156,11 @@ private:
    * Note we make this mutable so that the const methods can still
    * change it.
    */
+#ifdef NS3_MTP
+  mutable std::atomic<uint32_t> m_count;
+#else
   mutable uint32_t m_count;
+#endif
 };
 
 } // namespace ns3
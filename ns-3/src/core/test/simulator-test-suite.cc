@@ -23,6 +23,13 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/event-impl.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -461,6 +468,175 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventOrderTestCase : public TestCase
+{
+public:
+  SimulatorEventOrderTestCase (ObjectFactory schedulerFactory, bool lazyRemove = false);
+  virtual void DoRun (void);
+  void Run (ObjectFactory schedulerFactory, std::vector<std::pair<uint64_t, uint32_t> > *order);
+  void Hold (uint32_t id);
+  Time GetDelay (void);
+  ObjectFactory m_schedulerFactory;
+  Ptr<UniformRandomVariable> m_rng;
+  std::vector<EventId> m_events;
+  std::vector<std::pair<uint64_t, uint32_t> > *m_order;
+  uint32_t m_nextId;
+};
+
+SimulatorEventOrderTestCase::SimulatorEventOrderTestCase (ObjectFactory schedulerFactory, bool lazyRemove)
+  : TestCase ("Check that the events are executed in the same order with " +
+              schedulerFactory.GetTypeId ().GetName () +
+              (lazyRemove ? " with lazy removal" : "") + " and ns3::MapScheduler"),
+    m_schedulerFactory (schedulerFactory)
+{
+  if (lazyRemove)
+    {
+      // compact often, so that the removed events are also dropped
+      // before they reach the head of the event list
+      m_schedulerFactory.Set ("LazyRemove", BooleanValue (true));
+      m_schedulerFactory.Set ("CompactionThreshold", DoubleValue (0.05));
+    }
+}
+
+Time
+SimulatorEventOrderTestCase::GetDelay (void)
+{
+  // skewed delays: many events at the same time, most in the near future,
+  // some far in the future
+  double u = m_rng->GetValue ();
+  if (u < 0.3)
+    {
+      return Seconds (0);
+    }
+  if (u < 0.9)
+    {
+      return NanoSeconds (m_rng->GetInteger (1, 1000));
+    }
+  return NanoSeconds (m_rng->GetInteger (1, 10000000));
+}
+
+void
+SimulatorEventOrderTestCase::Hold (uint32_t id)
+{
+  m_order->push_back (std::make_pair (Simulator::Now ().GetTimeStep (), id));
+  if (m_nextId >= 50000)
+    {
+      return;
+    }
+  m_events[m_rng->GetInteger (0, m_events.size () - 1)] =
+    Simulator::Schedule (GetDelay (), &SimulatorEventOrderTestCase::Hold, this, m_nextId++);
+  if (m_rng->GetValue () < 0.1)
+    {
+      // remove a pending event, and replace it
+      EventId &ev = m_events[m_rng->GetInteger (0, m_events.size () - 1)];
+      if (!ev.IsExpired ())
+        {
+          Simulator::Remove (ev);
+          ev = Simulator::Schedule (GetDelay (), &SimulatorEventOrderTestCase::Hold, this, m_nextId++);
+        }
+    }
+}
+
+void
+SimulatorEventOrderTestCase::Run (ObjectFactory schedulerFactory, std::vector<std::pair<uint64_t, uint32_t> > *order)
+{
+  Simulator::SetScheduler (schedulerFactory);
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  m_order = order;
+  m_events.clear ();
+  for (m_nextId = 0; m_nextId < 5000; m_nextId++)
+    {
+      m_events.push_back (Simulator::Schedule (GetDelay (), &SimulatorEventOrderTestCase::Hold, this, m_nextId));
+    }
+  Simulator::Run ();
+  m_events.clear ();
+  Simulator::Destroy ();
+}
+
+void
+SimulatorEventOrderTestCase::DoRun (void)
+{
+  std::vector<std::pair<uint64_t, uint32_t> > order;
+  std::vector<std::pair<uint64_t, uint32_t> > reference;
+
+  Run (m_schedulerFactory, &order);
+  Run (ObjectFactory ("ns3::MapScheduler"), &reference);
+
+  NS_TEST_ASSERT_MSG_EQ (order.size (), reference.size (), "a different number of events has been executed");
+  for (uint32_t i = 0; i < order.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (order[i].first, reference[i].first, "event " << i << " executed at a different time");
+      NS_TEST_ASSERT_MSG_EQ (order[i].second, reference[i].second, "event " << i << " executed in a different order");
+    }
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event0 (void);
+  void Event1 (uint32_t a);
+  void Event3 (uint32_t a, double b, Time c);
+  uint32_t m_count;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the memory of the events is recycled")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Event0 (void)
+{
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Event1, this, 1);
+}
+
+void
+SimulatorEventPoolTestCase::Event1 (uint32_t a)
+{
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Event3, this, a, 2.0, Seconds (3));
+}
+
+void
+SimulatorEventPoolTestCase::Event3 (uint32_t a, double b, Time c)
+{
+  if (++m_count < 1000)
+    {
+      Simulator::ScheduleNow (&SimulatorEventPoolTestCase::Event0, this);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  BooleanValue enabled;
+  GlobalValue::GetValueByName ("EventImplPool", enabled);
+
+  m_count = 0;
+  uint64_t allocated = EventImpl::GetAllocatedCount ();
+  uint64_t recycled = EventImpl::GetRecycledCount ();
+  Simulator::Schedule (Seconds (0), &SimulatorEventPoolTestCase::Event0, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1000u, "not all the events have been executed");
+
+  // three events per iteration, of different sizes
+  uint64_t created = EventImpl::GetAllocatedCount () - allocated + EventImpl::GetRecycledCount () - recycled;
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (created, 3000u, "events have not been counted");
+  if (enabled.Get ())
+    {
+      NS_TEST_EXPECT_MSG_LT (EventImpl::GetAllocatedCount () - allocated, 10u,
+                             "the memory of the events has not been recycled");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (EventImpl::GetRecycledCount (), recycled,
+                             "the memory of the events has been recycled");
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +653,29 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory, true), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory, true), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory, true), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory, true), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory, true), TestCase::QUICK);
+
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
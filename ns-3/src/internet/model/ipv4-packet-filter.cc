@@ -24,8 +24,6 @@
 #include "ns3/log.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
-#include "ns3/tcp-header.h"
-#include "ns3/udp-header.h"
 #include "ipv4-queue-disc-item.h"
 #include "ipv4-packet-filter.h"
 
@@ -73,6 +71,11 @@ DRRIpv4PacketFilter::GetTypeId (void)
     .SetParent<Ipv4PacketFilter> ()
     .SetGroupName ("Internet")
     .AddConstructor<DRRIpv4PacketFilter> ()
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DRRIpv4PacketFilter::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
     ;
   return tid;
 }
@@ -91,40 +94,6 @@ int32_t
 DRRIpv4PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
 {
   NS_LOG_FUNCTION (this << item);
-  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
-
-    if (!ipv4Item)
-      {
-        NS_LOG_DEBUG ("No match");
-        return PacketFilter::PF_NO_MATCH;
-      }
-
-  Ipv4Header hdr = ipv4Item->GetHeader ();
-  Ipv4Address src = hdr.GetSource ();
-  Ipv4Address dest = hdr.GetDestination ();
-  uint8_t prot = hdr.GetProtocol ();
-  uint16_t fragOffset = hdr.GetFragmentOffset ();
-
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
-  uint16_t srcPort = 0;
-  uint16_t destPort = 0;
-
-  Ptr<Packet> pkt = ipv4Item->GetPacket ();
-
-
-  if (prot == 6 && fragOffset == 0) // TCP
-    {
-        pkt->PeekHeader (tcpHdr);
-        srcPort = tcpHdr.GetSourcePort ();
-        destPort = tcpHdr.GetDestinationPort ();
-    }
-  else if (prot == 17 && fragOffset == 0) // UDP
-    {
-        pkt->PeekHeader (udpHdr);
-        srcPort = udpHdr.GetSourcePort ();
-        destPort = udpHdr.GetDestinationPort ();
-    }
 
   //---------------------------------------------------------------------------//
   /* This is as per the ns2 code. Only uses the source address. Or if specified,
@@ -144,24 +113,12 @@ DRRIpv4PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
 
 
   //---------------------------------------------------------------------------//
-  
-  /* This is a modified version of the hash function in the fq-codel ns3 code. Probably a more robust hash function
-   * calculated using a variety of parameters */
-
-    uint8_t buf[13];
-    src.Serialize (buf);
-    dest.Serialize (buf + 4);
-    buf[8] = prot;
-    buf[9] = (srcPort >> 8) & 0xff;
-    buf[10] = srcPort & 0xff;
-    buf[11] = (destPort >> 8) & 0xff;
-    buf[12] = destPort & 0xff;
-    
-    /* murmur3 used in fq-codel */
-    uint32_t hash = Hash32 ((char*) buf, 13);
-
-  //******************************************************************//
-  
+
+  /* The murmur3 hash of the 5-tuple, as in fq-codel. The ports are read from
+   * the packet buffer and the hash is cached in the item, so that it is computed
+   * once even if the packet is classified multiple times */
+  uint32_t hash = item->Hash (m_perturbation);
+
   NS_LOG_DEBUG ("Found Ipv4 packet; hash value " << hash);
 
   return hash;
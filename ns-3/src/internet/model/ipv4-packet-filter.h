@@ -71,6 +71,7 @@ public:
 private:
   virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
 
+  uint32_t m_perturbation;   //!< hash perturbation value
 };
 
 } // namespace ns3
@@ -24,8 +24,6 @@
 #include "ns3/log.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
-#include "ns3/tcp-header.h"
-#include "ns3/udp-header.h"
 #include "ipv6-queue-disc-item.h"
 #include "ipv6-packet-filter.h"
 
@@ -73,6 +71,11 @@ DRRIpv6PacketFilter::GetTypeId (void)
     .SetParent<Ipv6PacketFilter> ()
     .SetGroupName ("Internet")
     .AddConstructor<DRRIpv6PacketFilter> ()
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DRRIpv6PacketFilter::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -91,52 +94,10 @@ int32_t
 DRRIpv6PacketFilter::DoClassify (Ptr< QueueDiscItem > item) const
 {
   NS_LOG_FUNCTION (this << item);
-  Ptr<Ipv6QueueDiscItem> ipv6Item = DynamicCast<Ipv6QueueDiscItem> (item);
-
-  if (!ipv6Item)
-    {
-      NS_LOG_DEBUG ("No match");
-      return PacketFilter::PF_NO_MATCH;
-    }
-
-  Ipv6Header hdr = ipv6Item->GetHeader ();
-  Ipv6Address src = hdr.GetSourceAddress ();
-  Ipv6Address dest = hdr.GetDestinationAddress ();
-  uint8_t prot = hdr.GetNextHeader ();
-
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
-  uint16_t srcPort = 0;
-  uint16_t destPort = 0;
-
-  Ptr<Packet> pkt = ipv6Item->GetPacket ();
-
-  if (prot == 6) // TCP
-    {
-      pkt->PeekHeader (tcpHdr);
-      srcPort = tcpHdr.GetSourcePort ();
-      destPort = tcpHdr.GetDestinationPort ();
-    }
-  else if (prot == 17) // UDP
-    {
-      pkt->PeekHeader (udpHdr);
-      srcPort = udpHdr.GetSourcePort ();
-      destPort = udpHdr.GetDestinationPort ();
-    }
-
-  /* serialize the 5-tuple and the perturbation in buf */
-  uint8_t buf[37];
-  src.Serialize (buf);
-  dest.Serialize (buf + 16);
-  buf[32] = prot;
-  buf[33] = (srcPort >> 8) & 0xff;
-  buf[34] = srcPort & 0xff;
-  buf[35] = (destPort >> 8) & 0xff;
-  buf[36] = destPort & 0xff;
-
-
-  /* Linux calculates the jhash2 (jenkins hash), we calculate the murmur3 */
-  uint32_t hash = Hash32 ((char*) buf, 37);
+
+  /* Linux calculates the jhash2 (jenkins hash), we calculate the murmur3. The
+   * ports are read from the packet buffer and the hash is cached in the item */
+  uint32_t hash = item->Hash (m_perturbation);
 
   NS_LOG_DEBUG ("Found Ipv6 packet; hash " << hash);
 
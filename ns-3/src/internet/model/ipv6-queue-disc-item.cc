@@ -17,9 +17,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/hash.h"
 #include "ipv6-queue-disc-item.h"
-#include "ns3/tcp-header.h"
-#include "ns3/udp-header.h"
 
 namespace ns3 {
 
@@ -29,7 +28,10 @@ Ipv6QueueDiscItem::Ipv6QueueDiscItem (Ptr<Packet> p, const Address& addr,
                                       uint16_t protocol, const Ipv6Header & header)
   : QueueDiscItem (p, addr, protocol),
     m_header (header),
-    m_headerAdded (false)
+    m_headerAdded (false),
+    m_hash (0),
+    m_hashPerturbation (0),
+    m_hashValid (false)
 {
 }
 
@@ -115,31 +117,27 @@ Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
 {
   NS_LOG_FUNCTION (this << perturbation);
 
+  // the hash is computed once, even if the packet is classified multiple times
+  if (m_hashValid && m_hashPerturbation == perturbation)
+    {
+      return m_hash;
+    }
+
   Ipv6Address src = m_header.GetSourceAddress ();
   Ipv6Address dest = m_header.GetDestinationAddress ();
   uint8_t prot = m_header.GetNextHeader ();
 
-  TcpHeader tcpHdr;
-  UdpHeader udpHdr;
   uint16_t srcPort = 0;
   uint16_t destPort = 0;
 
-  if (prot == 6) // TCP
-    {
-      GetPacket ()->PeekHeader (tcpHdr);
-      srcPort = tcpHdr.GetSourcePort ();
-      destPort = tcpHdr.GetDestinationPort ();
-    }
-  else if (prot == 17) // UDP
-    {
-      GetPacket ()->PeekHeader (udpHdr);
-      srcPort = udpHdr.GetSourcePort ();
-      destPort = udpHdr.GetDestinationPort ();
-    }
   if (prot != 6 && prot != 17)
     {
       NS_LOG_WARN ("Unknown transport protocol, no port number included in hash computation");
     }
+  else
+    {
+      GetTransportPorts (srcPort, destPort);
+    }
 
   /* serialize the 5-tuple and the perturbation in buf */
   uint8_t buf[41];
@@ -161,7 +159,35 @@ Ipv6QueueDiscItem::Hash (uint32_t perturbation) const
 
   NS_LOG_DEBUG ("Found Ipv6 packet; hash of the five tuple " << hash);
 
+  m_hash = hash;
+  m_hashPerturbation = perturbation;
+  m_hashValid = true;
   return hash;
 }
 
+bool
+Ipv6QueueDiscItem::GetTransportPorts (uint16_t &srcPort, uint16_t &destPort) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint8_t prot = m_header.GetNextHeader ();
+  if (prot != 6 && prot != 17)
+    {
+      return false;
+    }
+
+  // both the TCP and the UDP header start with the source and destination ports
+  uint32_t offset = (m_headerAdded ? m_header.GetSerializedSize () : 0);
+  uint8_t buf[44];
+  NS_ASSERT (offset + 4 <= sizeof (buf));
+  if (GetPacket ()->CopyData (buf, offset + 4) < offset + 4)
+    {
+      return false;
+    }
+
+  srcPort = (buf[offset] << 8) | buf[offset + 1];
+  destPort = (buf[offset + 2] << 8) | buf[offset + 3];
+  return true;
+}
+
 } // namespace ns3
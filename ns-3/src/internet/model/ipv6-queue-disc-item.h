@@ -94,6 +94,19 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation) const;
 
+  /**
+   * \brief Get the source and destination ports of the packet
+   *
+   * If the transport protocol is either UDP or TCP, the ports are read from
+   * the first bytes of the packet buffer, without deserializing the transport
+   * header
+   *
+   * \param srcPort the source port
+   * \param destPort the destination port
+   * \return true if the ports have been read, false otherwise
+   */
+  bool GetTransportPorts (uint16_t &srcPort, uint16_t &destPort) const;
+
 private:
   /**
    * \brief Default constructor
@@ -117,6 +130,9 @@ private:
 
   Ipv6Header m_header;  //!< The IPv6 header.
   bool m_headerAdded;   //!< True if the header has already been added to the packet.
+  mutable uint32_t m_hash;              //!< The last computed hash of the 5-tuple.
+  mutable uint32_t m_hashPerturbation;  //!< The perturbation used to compute m_hash.
+  mutable bool m_hashValid;             //!< True if m_hash has been computed.
 };
 
 } // namespace ns3
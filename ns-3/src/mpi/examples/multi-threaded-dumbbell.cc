@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Many dumbbells, each with a DRR bottleneck, simulated by the
+ * multi-threaded simulator:
+ *
+ *   l0 ---+                        +--- r0
+ *         |     10Mb/s, 10ms       |
+ *   l1 ---+-- a ============== b --+--- r1
+ *         |  DRRQueueDisc          |
+ *   ...  -+   100Mb/s, 1ms        +-  ...
+ *
+ * Each left leaf sends a TCP bulk transfer to the matching right leaf. The
+ * nodes of a dumbbell have contiguous ids, so that the dumbbells are spread
+ * over the partitions of the simulator, whose lookahead is the delay of the
+ * access links between partitions. Compare the wall clock times of:
+ *
+ *   ./waf --run "multi-threaded-dumbbell --threads=1"
+ *   ./waf --run "multi-threaded-dumbbell --threads=8"
+ *   ./waf --run "multi-threaded-dumbbell --multiThreaded=0"
+ *
+ * The partitions are executed in parallel only if ns-3 is configured with
+ * --enable-mtp.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MultiThreadedDumbbell");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nDumbbells = 200;
+  uint32_t nLeaves = 4;
+  uint32_t threads = 0;
+  double simTime = 5;
+  bool multiThreaded = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("dumbbells", "Number of dumbbells", nDumbbells);
+  cmd.AddValue ("leaves", "Number of leaves on each side of a dumbbell", nLeaves);
+  cmd.AddValue ("threads", "Maximum number of threads (0 for the number of hardware threads)", threads);
+  cmd.AddValue ("simTime", "Simulation time, in seconds", simTime);
+  cmd.AddValue ("multiThreaded", "Use the multi-threaded simulator", multiThreaded);
+  cmd.Parse (argc, argv);
+
+  if (multiThreaded)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::MultiThreadedSimulatorImpl"));
+      Config::SetDefault ("ns3::MultiThreadedSimulatorImpl::MaxThreads", UintegerValue (threads));
+    }
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+
+  TrafficControlHelper tchDRR;
+  uint16_t handle = tchDRR.SetRootQueueDisc ("ns3::DRRQueueDisc");
+  tchDRR.AddPacketFilter (handle, "ns3::DRRIpv4PacketFilter");
+
+  InternetStackHelper internet;
+  Ipv4AddressHelper ipv4 ("10.0.0.0", "255.255.255.252");
+
+  uint16_t port = 50000;
+  ApplicationContainer sources;
+  ApplicationContainer sinks;
+
+  for (uint32_t d = 0; d < nDumbbells; d++)
+    {
+      NodeContainer left;
+      left.Create (nLeaves);
+      NodeContainer routers;
+      routers.Create (2);
+      NodeContainer right;
+      right.Create (nLeaves);
+      internet.Install (left);
+      internet.Install (routers);
+      internet.Install (right);
+
+      NetDeviceContainer devices = bottleneck.Install (routers);
+      tchDRR.Install (devices);
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+
+      for (uint32_t i = 0; i < nLeaves; i++)
+        {
+          ipv4.Assign (access.Install (left.Get (i), routers.Get (0)));
+          ipv4.NewNetwork ();
+          Ipv4InterfaceContainer interfaces = ipv4.Assign (access.Install (routers.Get (1), right.Get (i)));
+          ipv4.NewNetwork ();
+
+          BulkSendHelper source ("ns3::TcpSocketFactory",
+                                 InetSocketAddress (interfaces.GetAddress (1), port));
+          sources.Add (source.Install (left.Get (i)));
+          PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                                 InetSocketAddress (Ipv4Address::GetAny (), port));
+          sinks.Add (sink.Install (right.Get (i)));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  sinks.Start (Seconds (0));
+  sources.Start (Seconds (0.1));
+  Simulator::Stop (Seconds (simTime));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      received += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  std::cout << NodeList::GetNNodes () << " nodes, "
+            << Simulator::GetEventCount () << " events in "
+            << elapsed << " ms" << std::endl;
+  std::cout << "Received " << received << " bytes, "
+            << received * 8 / (simTime - 0.1) / nDumbbells / 1e6
+            << " Mb/s per bottleneck" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,870 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multi-threaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/system-thread.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mpi
+ * ns3::MultiThreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultiThreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultiThreadedSimulatorImpl);
+
+thread_local MultiThreadedSimulatorImpl::Partition *MultiThreadedSimulatorImpl::m_current = 0;
+
+namespace {
+
+/** The timestamp of an empty event list. */
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * Order the received events by timestamp, then by sender, then in the order
+ * they were sent.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \return Whether the first event comes first.
+ */
+template <typename T>
+bool
+ReceivedBefore (const T *a, const T *b)
+{
+  if (a->ev.key.m_ts != b->ev.key.m_ts)
+    {
+      return a->ev.key.m_ts < b->ev.key.m_ts;
+    }
+  if (a->source != b->source)
+    {
+      return a->source < b->source;
+    }
+  return a->seq < b->seq;
+}
+
+/**
+ * Find the group of a node, i.e., the smallest node id of the group.
+ *
+ * \param [in,out] group The parent of each node in its group, the root of a
+ *                  group being its own parent.
+ * \param [in] i The node id.
+ * \return The root of the group of the node.
+ */
+uint32_t
+FindGroup (std::vector<uint32_t> &group, uint32_t i)
+{
+  while (group[i] != i)
+    {
+      // path halving
+      group[i] = group[group[i]];
+      i = group[i];
+    }
+  return i;
+}
+
+} // unnamed namespace
+
+TypeId
+MultiThreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultiThreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultiThreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of partitions, each executed by a thread "
+                   "(0 for the number of hardware threads)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultiThreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ForceParallel",
+                   "Whether the partitions are executed in parallel even if ns-3 is not "
+                   "configured with --enable-mtp, which is only safe if the events of "
+                   "different partitions share no object (e.g., no packet)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiThreadedSimulatorImpl::m_forceParallel),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+MultiThreadedSimulatorImpl::MultiThreadedSimulatorImpl ()
+  : m_maxThreads (0),
+    m_forceParallel (false),
+    m_lookAhead (NO_EVENT),
+    m_nThreads (1),
+    m_nextThread (1),
+    m_windowEnd (0),
+    m_finished (false),
+    m_nWindows (0),
+    m_stop (false),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the main partition holds all the events until the nodes are partitioned
+  Partition *p = new Partition;
+  p->index = 0;
+  p->currentTs = 0;
+  p->currentUid = 0;
+  p->currentContext = Simulator::NO_CONTEXT;
+  // uids are allocated from 4, as in DefaultSimulatorImpl
+  p->uid = 4;
+  p->firstUid = 4;
+  p->lastUid = std::numeric_limits<uint32_t>::max ();
+  p->unscheduledEvents = 0;
+  p->eventCount = 0;
+  p->nextTs = NO_EVENT;
+  p->sent = 0;
+  p->stop = false;
+  p->inbox = 0;
+  m_partitions.push_back (p);
+}
+
+MultiThreadedSimulatorImpl::~MultiThreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultiThreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      Partition *p = *it;
+      Receive (p);
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+      delete p;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultiThreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      Partition *p = *it;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (p->events != 0)
+        {
+          while (!p->events->IsEmpty ())
+            {
+              scheduler->Insert (p->events->RemoveNext ());
+            }
+        }
+      p->events = scheduler;
+    }
+}
+
+uint32_t
+MultiThreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+MultiThreadedSimulatorImpl::Partition *
+MultiThreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_nodePartitions.size ())
+    {
+      return m_partitions[m_nodePartitions[context]];
+    }
+  return m_partitions[0];
+}
+
+MultiThreadedSimulatorImpl::Partition *
+MultiThreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  Partition *p = m_current;
+  return p != 0 ? p : m_partitions[0];
+}
+
+void
+MultiThreadedSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *main = m_partitions[0];
+  uint32_t nNodes = NodeList::GetNNodes ();
+
+  uint32_t nPartitions = m_maxThreads;
+  if (nPartitions == 0)
+    {
+      nPartitions = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  nPartitions = std::min (nPartitions, nNodes);
+
+  // the nodes connected by a channel which is not a point-to-point link with
+  // a positive delay are grouped (union-find), as such a channel may share
+  // state between its nodes or deliver packets without a lookahead
+  std::vector<uint32_t> group (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      group[i] = i;
+    }
+  std::vector<uint64_t> delays;
+  for (ChannelList::Iterator it = ChannelList::Begin (); it != ChannelList::End (); it++)
+    {
+      Ptr<Channel> channel = *it;
+      bool pointToPoint = true;
+      for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+        {
+          pointToPoint = pointToPoint && channel->GetDevice (i)->IsPointToPoint ();
+        }
+      TimeValue delay;
+      if (pointToPoint && channel->GetAttributeFailSafe ("Delay", delay)
+          && delay.Get ().IsStrictlyPositive ())
+        {
+          delays.push_back (delay.Get ().GetTimeStep ());
+          continue;
+        }
+      delays.push_back (0);
+      for (uint32_t i = 1; i < channel->GetNDevices (); i++)
+        {
+          uint32_t a = FindGroup (group, channel->GetDevice (0)->GetNode ()->GetId ());
+          uint32_t b = FindGroup (group, channel->GetDevice (i)->GetNode ()->GetId ());
+          group[std::max (a, b)] = std::min (a, b);
+        }
+    }
+
+  // the groups are assigned to partitions of contiguous node ids, in the order
+  // of their smallest node id, each partition receiving about the same number
+  // of nodes
+  std::vector<uint32_t> groupSize (nNodes, 0);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      groupSize[FindGroup (group, i)]++;
+    }
+  m_nodePartitions.assign (nNodes, 0);
+  uint32_t target = nPartitions > 0 ? (nNodes + nPartitions - 1) / nPartitions : 0;
+  uint32_t current = 0;
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t root = FindGroup (group, i);
+      if (root == i)
+        {
+          if (current == 0 || (size >= target && current < nPartitions))
+            {
+              current++;
+              size = 0;
+            }
+          size += groupSize[i];
+        }
+      // the root of a group is its smallest node id
+      m_nodePartitions[i] = root == i ? current : m_nodePartitions[root];
+    }
+  nPartitions = current;
+
+  // the lookahead is the smallest delay of the links between partitions
+  uint32_t c = 0;
+  for (ChannelList::Iterator it = ChannelList::Begin (); it != ChannelList::End (); it++, c++)
+    {
+      Ptr<Channel> channel = *it;
+      for (uint32_t i = 1; i < channel->GetNDevices () && delays[c] > 0; i++)
+        {
+          if (m_nodePartitions[channel->GetDevice (0)->GetNode ()->GetId ()]
+              != m_nodePartitions[channel->GetDevice (i)->GetNode ()->GetId ()])
+            {
+              m_lookAhead = std::min (m_lookAhead, delays[c]);
+            }
+        }
+    }
+
+  // the uids left are split into a range per partition, so that the uids
+  // of the events are unique across the partitions
+  uint32_t range = (std::numeric_limits<uint32_t>::max () - main->uid) / (nPartitions + 1);
+  main->firstUid = main->uid;
+  main->lastUid = main->uid + range - 1;
+  for (uint32_t i = 1; i <= nPartitions; i++)
+    {
+      Partition *p = new Partition;
+      p->index = i;
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->currentTs = main->currentTs;
+      p->currentUid = 0;
+      p->currentContext = Simulator::NO_CONTEXT;
+      p->firstUid = main->firstUid + i * range;
+      p->lastUid = p->firstUid + range - 1;
+      p->uid = p->firstUid;
+      p->unscheduledEvents = 0;
+      p->eventCount = 0;
+      p->nextTs = NO_EVENT;
+      p->sent = 0;
+      p->stop = false;
+      p->inbox = 0;
+      m_partitions.push_back (p);
+    }
+
+  // move the events of the nodes into their partition
+  Ptr<Scheduler> events = m_schedulerFactory.Create<Scheduler> ();
+  while (!main->events->IsEmpty ())
+    {
+      Scheduler::Event ev = main->events->RemoveNext ();
+      Partition *p = GetPartition (ev.key.m_context);
+      if (p == main)
+        {
+          events->Insert (ev);
+          continue;
+        }
+      main->unscheduledEvents--;
+      p->unscheduledEvents++;
+      p->events->Insert (ev);
+    }
+  main->events = events;
+
+#ifdef NS3_MTP
+  m_nThreads = nPartitions;
+#else
+  m_nThreads = m_forceParallel ? nPartitions : 1;
+#endif
+  if (m_nThreads == 0)
+    {
+      m_nThreads = 1;
+    }
+  NS_LOG_INFO (nNodes << " nodes in " << nPartitions << " partitions executed by "
+                      << m_nThreads << " threads, lookahead " << TimeStep (m_lookAhead));
+}
+
+void
+MultiThreadedSimulatorImpl::Insert (Partition *p, Scheduler::Event &ev)
+{
+  ev.key.m_uid = p->uid;
+  p->uid = p->uid == p->lastUid ? p->firstUid : p->uid + 1;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+}
+
+void
+MultiThreadedSimulatorImpl::Send (Partition *from, Partition *to, const Scheduler::Event &ev)
+{
+  RemoteEvent *remote = new RemoteEvent;
+  remote->ev = ev;
+  remote->source = from->index;
+  remote->seq = from->sent;
+  from->sent++;
+
+  // lock-free push onto the queue of the receiver, which pops all the
+  // events at once, in a round during which no event is sent
+  remote->next = to->inbox.load (std::memory_order_relaxed);
+  while (!to->inbox.compare_exchange_weak (remote->next, remote,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+    {
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::Receive (Partition *p)
+{
+  RemoteEvent *remote = p->inbox.exchange (0, std::memory_order_acquire);
+  if (remote == 0)
+    {
+      return;
+    }
+  while (remote != 0)
+    {
+      p->received.push_back (remote);
+      remote = remote->next;
+    }
+  // the events are sorted, so that their uids do not depend on the
+  // interleaving of the threads
+  std::sort (p->received.begin (), p->received.end (), ReceivedBefore<RemoteEvent>);
+  for (std::vector<RemoteEvent *>::iterator it = p->received.begin (); it != p->received.end (); it++)
+    {
+      Insert (p, (*it)->ev);
+      delete *it;
+    }
+  p->received.clear ();
+}
+
+void
+MultiThreadedSimulatorImpl::ProcessWindow (Partition *p, uint64_t end)
+{
+  m_current = p;
+  // the other partitions do not check whether Stop was called during the
+  // window, so that the events they execute do not depend on the threads
+  while (!p->events->IsEmpty () && !p->stop)
+    {
+      if (p->events->PeekNext ().key.m_ts >= end)
+        {
+          break;
+        }
+      Scheduler::Event next = p->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= p->currentTs);
+      p->unscheduledEvents--;
+      p->eventCount++;
+
+      NS_LOG_LOGIC ("handle " << next.key.m_ts);
+      p->currentTs = next.key.m_ts;
+      p->currentContext = next.key.m_context;
+      p->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+  m_current = 0;
+}
+
+void
+MultiThreadedSimulatorImpl::ProcessMainEvents (void)
+{
+  Partition *main = m_partitions[0];
+  uint64_t ts = main->events->PeekNext ().key.m_ts;
+  while (!main->events->IsEmpty () && main->events->PeekNext ().key.m_ts == ts && !m_stop)
+    {
+      Scheduler::Event next = main->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= main->currentTs);
+      main->unscheduledEvents--;
+      main->eventCount++;
+
+      NS_LOG_LOGIC ("handle main " << next.key.m_ts);
+      main->currentTs = next.key.m_ts;
+      main->currentContext = next.key.m_context;
+      main->currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::GrantWindow (void)
+{
+  Partition *main = m_partitions[0];
+  Receive (main);
+
+  uint64_t next = NO_EVENT;
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      next = std::min (next, m_partitions[i]->nextTs);
+    }
+  uint64_t mainNext = main->events->IsEmpty () ? NO_EVENT : main->events->PeekNext ().key.m_ts;
+
+  if (m_stop || (next == NO_EVENT && mainNext == NO_EVENT))
+    {
+      m_finished = true;
+      return;
+    }
+
+  if (mainNext <= next)
+    {
+      // the events of the main partition are executed alone, and may thus
+      // insert events directly into the other partitions
+      ProcessMainEvents ();
+      m_windowEnd = 0;
+      m_finished = m_stop;
+      return;
+    }
+
+  // the events of a partition cannot affect another partition before the
+  // end of the window
+  m_windowEnd = m_lookAhead >= NO_EVENT - next ? NO_EVENT : next + m_lookAhead;
+  m_windowEnd = std::min (m_windowEnd, mainNext);
+  m_nWindows++;
+}
+
+void
+MultiThreadedSimulatorImpl::Barrier (void)
+{
+  if (m_nThreads == 1)
+    {
+      return;
+    }
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == m_nThreads)
+    {
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.store (generation + 1, std::memory_order_release);
+      return;
+    }
+  // the windows are usually short, hence the threads spin before yielding
+  for (uint32_t spins = 0; m_barrierGeneration.load (std::memory_order_acquire) == generation; spins++)
+    {
+      if (spins >= 1000)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::DoRun (uint32_t thread)
+{
+  while (true)
+    {
+      for (uint32_t i = thread + 1; i < m_partitions.size (); i += m_nThreads)
+        {
+          Partition *p = m_partitions[i];
+          Receive (p);
+          p->nextTs = p->events->IsEmpty () ? NO_EVENT : p->events->PeekNext ().key.m_ts;
+        }
+      Barrier ();
+      if (thread == 0)
+        {
+          GrantWindow ();
+        }
+      Barrier ();
+      if (m_finished)
+        {
+          break;
+        }
+      for (uint32_t i = thread + 1; i < m_partitions.size (); i += m_nThreads)
+        {
+          ProcessWindow (m_partitions[i], m_windowEnd);
+        }
+      Barrier ();
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::DoRunWorker (void)
+{
+  uint32_t thread = m_nextThread.fetch_add (1);
+  DoRun (thread);
+}
+
+bool
+MultiThreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      if (!(*it)->events->IsEmpty () || (*it)->inbox.load () != 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultiThreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_current == 0, "Simulator::Run called by an event");
+
+  if (m_partitions.size () == 1)
+    {
+      CreatePartitions ();
+    }
+  m_stop = false;
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      (*it)->stop = false;
+    }
+  m_finished = false;
+
+  m_nextThread = 1;
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&MultiThreadedSimulatorImpl::DoRunWorker, this));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+  DoRun (0);
+  for (std::vector<Ptr<SystemThread> >::iterator it = m_threads.begin (); it != m_threads.end (); it++)
+    {
+      (*it)->Join ();
+    }
+  m_threads.clear ();
+
+  // the time of the main partition is that of the last event executed
+  Partition *main = m_partitions[0];
+  int unscheduledEvents = 0;
+  for (std::vector<Partition *>::iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      main->currentTs = std::max (main->currentTs, (*it)->currentTs);
+      unscheduledEvents += (*it)->unscheduledEvents;
+    }
+  NS_LOG_INFO (m_nWindows << " windows");
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!IsFinished () || m_stop || unscheduledEvents == 0);
+}
+
+void
+MultiThreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  GetCurrentPartition ()->stop = true;
+  m_stop = true;
+}
+
+void
+MultiThreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  NS_ASSERT_MSG (delay.IsPositive (), "MultiThreadedSimulatorImpl::Stop(): Negative delay");
+
+  // the main partition is executed alone, between windows which do not
+  // extend past its next event: all the partitions thus stop at the same time
+  Partition *from = GetCurrentPartition ();
+  Partition *main = m_partitions[0];
+  Scheduler::Event ev;
+  ev.impl = MakeEvent (&Simulator::Stop);
+  ev.key.m_ts = from->currentTs + delay.GetTimeStep ();
+  ev.key.m_context = from->currentContext;
+  if (from == main)
+    {
+      Insert (main, ev);
+    }
+  else
+    {
+      Send (from, main, ev);
+    }
+}
+
+EventId
+MultiThreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultiThreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *p = GetCurrentPartition ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = p->currentTs + delay.GetTimeStep ();
+  ev.key.m_context = p->currentContext;
+  Insert (p, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultiThreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  Partition *from = GetCurrentPartition ();
+  Partition *to = GetPartition (context);
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = from->currentTs + delay.GetTimeStep ();
+  ev.key.m_context = context;
+
+  // the main partition is executed alone
+  if (to == from || from->index == 0)
+    {
+      Insert (to, ev);
+      return;
+    }
+  NS_ASSERT_MSG (ev.key.m_ts >= m_windowEnd,
+                 "Event scheduled for context " << context << " within the lookahead ("
+                 << TimeStep (m_lookAhead) << ") of context " << from->currentContext);
+  Send (from, to, ev);
+}
+
+EventId
+MultiThreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *p = GetCurrentPartition ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = p->currentTs;
+  ev.key.m_context = p->currentContext;
+  Insert (p, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultiThreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultiThreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+MultiThreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->currentTs);
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (p == GetCurrentPartition () || GetCurrentPartition ()->index == 0,
+                 "Event of context " << id.GetContext () << " removed by another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultiThreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultiThreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < p->currentTs ||
+      (id.GetTs () == p->currentTs &&
+       id.GetUid () <= p->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultiThreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultiThreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+uint64_t
+MultiThreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t eventCount = 0;
+  for (std::vector<Partition *>::const_iterator it = m_partitions.begin (); it != m_partitions.end (); it++)
+    {
+      eventCount += (*it)->eventCount;
+    }
+  return eventCount;
+}
+
+} // namespace ns3
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTI_THREADED_SIMULATOR_IMPL_H
+#define NS3_MULTI_THREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+class SystemThread;
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Multi-threaded simulator implementation using lookahead
+ *
+ * The nodes are split into partitions, each with its own event list,
+ * which are executed in parallel by the threads of a single process,
+ * in time windows granted by a conservative synchronization algorithm.
+ * The nodes connected by channels other than point-to-point links with
+ * a positive delay are kept in the same partition. The nodes are then
+ * assigned to MaxThreads partitions of contiguous node ids, balanced by
+ * number of nodes. The lookahead is the smallest delay of the links
+ * between partitions.
+ *
+ * The simulation proceeds in rounds separated by barriers. The smallest
+ * timestamp of the next events of the partitions plus the lookahead is
+ * the end of the next window, during which the partitions execute their
+ * events independently. An event scheduled by a partition for a node of
+ * another partition cannot take place before the end of the window: it
+ * is sent through a lock-free queue of the target partition, which
+ * inserts the events it received at the next round, sorted by timestamp
+ * and by sender, so that the order of the events does not depend on the
+ * interleaving of the threads. The packets are shared by the partitions,
+ * as in a sequential simulation.
+ *
+ * The events without context (e.g., scheduled before the simulation
+ * starts without a node context) and the events of the nodes created
+ * after the simulation started are executed by the main thread, alone,
+ * between windows. Each partition allocates the uids of its events from
+ * its own range.
+ *
+ * The event of Stop (delay) is executed by the main partition, so that
+ * all the partitions stop after the events before the stop time, as with
+ * the default simulator. Stop () called by an event of a partition stops
+ * that partition at once, but the other partitions complete the current
+ * window, so that the events executed do not depend on the interleaving
+ * of the threads.
+ *
+ * The partitions are only executed in parallel if ns-3 is configured with
+ * --enable-mtp, which makes the reference counts and the free lists of
+ * the packets thread-safe, or if ForceParallel is set. Otherwise, the main
+ * thread executes the windows of the partitions one after the other.
+ */
+class MultiThreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultiThreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultiThreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent by a partition to another one. */
+  struct RemoteEvent
+  {
+    Scheduler::Event ev;    //!< The event, whose uid is set by the receiver
+    uint32_t source;        //!< The index of the sending partition
+    uint64_t seq;           //!< The sequence number of the event in the sending partition
+    RemoteEvent *next;      //!< The next event in the queue of the receiver
+  };
+
+  /** A partition: a set of nodes and their events. */
+  struct Partition
+  {
+    uint32_t index;                     //!< The index of the partition, 0 for the main one
+    Ptr<Scheduler> events;              //!< The event list
+    uint64_t currentTs;                 //!< The timestamp of the current event
+    uint32_t currentUid;                //!< The uid of the current event
+    uint32_t currentContext;            //!< The context of the current event
+    uint32_t uid;                       //!< The next event uid
+    uint32_t firstUid;                  //!< The first uid of the range of the partition
+    uint32_t lastUid;                   //!< The last uid of the range of the partition, followed by the first
+    int unscheduledEvents;              //!< The number of events in the event list
+    uint64_t eventCount;                //!< The number of events executed
+    uint64_t nextTs;                    //!< The timestamp of the next event, at the start of a round
+    uint64_t sent;                      //!< The number of events sent to other partitions
+    bool stop;                          //!< Whether an event of the partition called Stop
+    std::vector<RemoteEvent *> received; //!< The events received at the start of a round
+    char pad1[64];                      //!< Keep the queue in its own cache line
+    std::atomic<RemoteEvent *> inbox;   //!< The events sent by the other partitions, last first
+    char pad2[64];                      //!< Keep the queue in its own cache line
+  };
+
+  /**
+   * Split the nodes into partitions, compute the lookahead and move the
+   * events scheduled so far into the event list of their partition.
+   */
+  void CreatePartitions (void);
+  /**
+   * \param [in] context The context of an event.
+   * \return The partition of the event.
+   */
+  Partition *GetPartition (uint32_t context) const;
+  /** \return The partition whose event is executed by the calling thread. */
+  Partition *GetCurrentPartition (void) const;
+  /**
+   * Insert an event into the event list of a partition.
+   *
+   * \param [in] p The partition.
+   * \param [in,out] ev The event, whose uid is set.
+   */
+  void Insert (Partition *p, Scheduler::Event &ev);
+  /**
+   * Send an event to the queue of another partition.
+   *
+   * \param [in] from The sending partition.
+   * \param [in] to The receiving partition.
+   * \param [in] ev The event.
+   */
+  void Send (Partition *from, Partition *to, const Scheduler::Event &ev);
+  /**
+   * Insert the events received by a partition into its event list.
+   *
+   * \param [in] p The partition.
+   */
+  void Receive (Partition *p);
+  /**
+   * Execute the events of a partition which take place before the end of
+   * the window.
+   *
+   * \param [in] p The partition.
+   * \param [in] end The end of the window.
+   */
+  void ProcessWindow (Partition *p, uint64_t end);
+  /**
+   * Execute the next event of the main partition and the events with the
+   * same timestamp.
+   */
+  void ProcessMainEvents (void);
+  /**
+   * Compute the end of the next window, executing the events of the main
+   * partition if they are the next ones. Called by the main thread only.
+   */
+  void GrantWindow (void);
+  /**
+   * The loop of the rounds of a thread.
+   *
+   * \param [in] thread The index of the thread, 0 for the main one.
+   */
+  void DoRun (uint32_t thread);
+  /** The body of a worker thread. */
+  void DoRunWorker (void);
+  /** Wait for the other threads. */
+  void Barrier (void);
+
+  /** The partition whose event is executed by the calling thread. */
+  static thread_local Partition *m_current;
+
+  typedef std::list<EventId> DestroyEvents;
+  DestroyEvents m_destroyEvents;        //!< The destroy events
+  SystemMutex m_destroyEventsMutex;     //!< Protects the destroy events
+
+  ObjectFactory m_schedulerFactory;     //!< The factory of the event lists
+  uint32_t m_maxThreads;                //!< The maximum number of partitions
+  bool m_forceParallel;                 //!< Whether the partitions are executed in parallel without NS3_MTP
+  std::vector<Partition *> m_partitions; //!< The partitions, the main one first
+  std::vector<uint32_t> m_nodePartitions; //!< The partition of each node
+  uint64_t m_lookAhead;                 //!< The lookahead, in time steps
+  uint32_t m_nThreads;                  //!< The number of threads
+  std::vector<Ptr<SystemThread> > m_threads; //!< The worker threads
+  std::atomic<uint32_t> m_nextThread;   //!< The index of the next worker thread started
+
+  uint64_t m_windowEnd;                 //!< The end of the current window
+  bool m_finished;                      //!< Whether the current Run has finished
+  uint64_t m_nWindows;                  //!< The number of windows
+  std::atomic<bool> m_stop;             //!< Whether Stop has been called
+
+  std::atomic<uint32_t> m_barrierCount; //!< The number of threads at the barrier
+  std::atomic<uint32_t> m_barrierGeneration; //!< The number of barriers passed
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTI_THREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,487 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+
+#include <vector>
+#include <utility>
+#include <set>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \defgroup mpi-test mpi module tests
+ */
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Check that the multi-threaded simulator executes the events of a
+ * ring of nodes, which forward packets to their successor, at the same times
+ * as the default simulator.
+ *
+ * The links of the ring have different delays and a main event without context
+ * injects a packet into a node, so that the nodes, the windows and the main
+ * partition interleave. The simulation is stopped before all the packets have
+ * been forwarded.
+ */
+class MultiThreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param maxThreads The maximum number of threads of the simulator.
+   */
+  MultiThreadedSimulatorRingTestCase (uint32_t maxThreads);
+
+private:
+  virtual void DoRun (void);
+
+  /** The packets received by each node: the time and the size of each packet. */
+  typedef std::vector<std::vector<std::pair<int64_t, uint32_t> > > Log;
+
+  /**
+   * Simulate the ring.
+   *
+   * \param [in] simulatorType The simulator implementation.
+   * \param [out] log The packets received by each node.
+   * \return The time at the end of the simulation.
+   */
+  Time RunRing (std::string simulatorType, Log &log);
+  /**
+   * Receive a packet and forward it after a processing delay, until it is empty.
+   *
+   * \param device The receiving device.
+   * \param packet The packet.
+   * \param protocol The protocol number.
+   * \param from The address of the sender.
+   * \param to The address of the receiver.
+   * \param type The type of the packet.
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+  /**
+   * Send a packet to the successor of a node.
+   *
+   * \param device The sending device.
+   * \param size The size of the packet.
+   */
+  void Send (Ptr<NetDevice> device, uint32_t size);
+  /**
+   * Schedule the sending of a packet by a node, from an event without context.
+   *
+   * \param node The node.
+   * \param size The size of the packet.
+   */
+  void Inject (uint32_t node, uint32_t size);
+
+  uint32_t m_maxThreads;              //!< The maximum number of threads
+  std::vector<Ptr<NetDevice> > m_out; //!< The device of each node towards its successor
+  Log *m_log;                         //!< The log of the current simulation
+};
+
+MultiThreadedSimulatorRingTestCase::MultiThreadedSimulatorRingTestCase (uint32_t maxThreads)
+  : TestCase ("Check the multi-threaded simulator with " + std::to_string (maxThreads) + " threads"),
+    m_maxThreads (maxThreads),
+    m_log (0)
+{
+}
+
+void
+MultiThreadedSimulatorRingTestCase::Send (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 1);
+}
+
+void
+MultiThreadedSimulatorRingTestCase::Inject (uint32_t node, uint32_t size)
+{
+  Simulator::ScheduleWithContext (node, Seconds (0), &MultiThreadedSimulatorRingTestCase::Send,
+                                  this, m_out[node], size);
+}
+
+void
+MultiThreadedSimulatorRingTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                             uint16_t protocol, const Address &from,
+                                             const Address &to, NetDevice::PacketType type)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  (*m_log)[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), packet->GetSize ()));
+  if (packet->GetSize () > 0)
+    {
+      // several packets may be forwarded at the same time
+      Simulator::Schedule (MicroSeconds (10 * (node % 4)),
+                           &MultiThreadedSimulatorRingTestCase::Send, this,
+                           m_out[node], packet->GetSize () - 1);
+    }
+}
+
+Time
+MultiThreadedSimulatorRingTestCase::RunRing (std::string simulatorType, Log &log)
+{
+  const uint32_t nNodes = 24;
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (simulatorType));
+  Ptr<SimulatorImpl> impl = Simulator::GetImplementation ();
+  if (simulatorType == "ns3::MultiThreadedSimulatorImpl")
+    {
+      impl->SetAttribute ("MaxThreads", UintegerValue (m_maxThreads));
+    }
+
+  log.assign (nNodes, std::vector<std::pair<int64_t, uint32_t> > ());
+  m_log = &log;
+  m_out.clear ();
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MicroSeconds (100 * (i % 3 + 1))));
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAttribute ("PointToPointMode", BooleanValue (true));
+          device->SetAttribute ("DataRate", DataRateValue (DataRate ("100Mb/s")));
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          nodes[(i + j) % nNodes]->AddDevice (device);
+          if (j == 0)
+            {
+              m_out.push_back (device);
+            }
+          else
+            {
+              nodes[(i + j) % nNodes]->RegisterProtocolHandler (MakeCallback (&MultiThreadedSimulatorRingTestCase::Receive, this),
+                                                                1, device);
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      for (uint32_t k = 0; k < 3; k++)
+        {
+          Simulator::ScheduleWithContext (i, MicroSeconds (50 * k), &MultiThreadedSimulatorRingTestCase::Send,
+                                          this, m_out[i], 200 + k);
+        }
+    }
+  // an event of the main partition, which schedules an event of a node
+  Simulator::Schedule (MicroSeconds (5555), &MultiThreadedSimulatorRingTestCase::Inject,
+                       this, 7, 100);
+  Simulator::Stop (MilliSeconds (40));
+  Simulator::Run ();
+  Time now = Simulator::Now ();
+
+  m_out.clear ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  return now;
+}
+
+void
+MultiThreadedSimulatorRingTestCase::DoRun (void)
+{
+  Log expected;
+  Time expectedEnd = RunRing ("ns3::DefaultSimulatorImpl", expected);
+  Log log;
+  Time end = RunRing ("ns3::MultiThreadedSimulatorImpl", log);
+
+  NS_TEST_EXPECT_MSG_EQ (end, expectedEnd, "The simulation did not stop at the same time");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (expected[i].size (), 0, "Node " << i << " received no packet");
+      NS_TEST_ASSERT_MSG_EQ (log[i].size (), expected[i].size (),
+                             "Node " << i << " did not receive the same number of packets");
+      for (uint32_t j = 0; j < expected[i].size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (log[i][j].first, expected[i][j].first,
+                                 "Packet " << j << " of node " << i << " not received at the same time");
+          NS_TEST_EXPECT_MSG_EQ (log[i][j].second, expected[i][j].second,
+                                 "Packet " << j << " of node " << i << " not of the same size");
+        }
+    }
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Check that the partitions of the multi-threaded simulator, executed
+ * by several threads, execute the same events as the default simulator, stop
+ * at the same time and allocate unique event uids.
+ *
+ * The events only share the delays of the links of a ring of nodes, not
+ * packets, so that the partitions can be executed in parallel without
+ * --enable-mtp (ForceParallel). Each node forwards tokens to its successor,
+ * through the links, and executes local events. An event of a node stops the
+ * simulation, either after a delay, which is exact, or at once, which stops
+ * the other partitions at the end of the window.
+ */
+class MultiThreadedSimulatorThreadsTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param stopNow Whether the simulation is stopped by Stop (), rather than
+   *                Stop (delay).
+   */
+  MultiThreadedSimulatorThreadsTestCase (bool stopNow);
+
+private:
+  virtual void DoRun (void);
+
+  /** The events executed by each node: the time and the hop count of each event. */
+  typedef std::vector<std::vector<std::pair<int64_t, uint32_t> > > Log;
+
+  /**
+   * Simulate the ring.
+   *
+   * \param [in] simulatorType The simulator implementation.
+   * \param [in] forceParallel Whether the partitions are executed in parallel.
+   * \param [out] log The events executed by each node.
+   * \return The time at the end of the simulation.
+   */
+  Time RunRing (std::string simulatorType, bool forceParallel, Log &log);
+  /**
+   * Forward a token to the successor of a node, and schedule a local event.
+   *
+   * \param node The node.
+   * \param hops The number of hops left.
+   */
+  void Forward (uint32_t node, uint32_t hops);
+  /**
+   * A local event of a node.
+   *
+   * \param node The node.
+   * \param hops The number of hops left of the token which scheduled it.
+   */
+  void Local (uint32_t node, uint32_t hops);
+
+  bool m_stopNow;                          //!< Whether Stop () is called rather than Stop (delay)
+  std::vector<Time> m_delays;              //!< The delay of the link from each node to its successor
+  std::vector<std::vector<uint32_t> > m_uids; //!< The uids of the local events of each node
+  Log *m_log;                              //!< The log of the current simulation
+  int64_t m_stopTs;                        //!< The time Stop () was called at
+};
+
+MultiThreadedSimulatorThreadsTestCase::MultiThreadedSimulatorThreadsTestCase (bool stopNow)
+  : TestCase (std::string ("Check the threads of the multi-threaded simulator with ")
+              + (stopNow ? "Stop ()" : "Stop (delay)")),
+    m_stopNow (stopNow),
+    m_log (0),
+    m_stopTs (0)
+{
+}
+
+void
+MultiThreadedSimulatorThreadsTestCase::Forward (uint32_t node, uint32_t hops)
+{
+  (*m_log)[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), hops));
+  if (hops == 0)
+    {
+      return;
+    }
+  if (node == 5 && hops == 150)
+    {
+      if (m_stopNow)
+        {
+          m_stopTs = Simulator::Now ().GetTimeStep ();
+          Simulator::Stop ();
+        }
+      else
+        {
+          // the events take place at multiples of a microsecond, while the
+          // events of the nodes at the stop time itself would not be executed
+          Simulator::Stop (NanoSeconds (250500));
+        }
+    }
+  uint32_t next = (node + 1) % m_delays.size ();
+  Simulator::ScheduleWithContext (next, m_delays[node], &MultiThreadedSimulatorThreadsTestCase::Forward,
+                                  this, next, hops - 1);
+  EventId id = Simulator::Schedule (MicroSeconds (7 * (node % 3)), &MultiThreadedSimulatorThreadsTestCase::Local,
+                                    this, node, hops);
+  m_uids[node].push_back (id.GetUid ());
+}
+
+void
+MultiThreadedSimulatorThreadsTestCase::Local (uint32_t node, uint32_t hops)
+{
+  (*m_log)[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), 1000 + hops));
+}
+
+Time
+MultiThreadedSimulatorThreadsTestCase::RunRing (std::string simulatorType, bool forceParallel, Log &log)
+{
+  const uint32_t nNodes = 12;
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (simulatorType));
+  Ptr<SimulatorImpl> impl = Simulator::GetImplementation ();
+  if (simulatorType == "ns3::MultiThreadedSimulatorImpl")
+    {
+      impl->SetAttribute ("MaxThreads", UintegerValue (4));
+      impl->SetAttribute ("ForceParallel", BooleanValue (forceParallel));
+    }
+
+  log.assign (nNodes, std::vector<std::pair<int64_t, uint32_t> > ());
+  m_log = &log;
+  m_uids.assign (nNodes, std::vector<uint32_t> ());
+  m_delays.clear ();
+
+  // the links only define the partitions and the lookahead
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      m_delays.push_back (MicroSeconds (100 * (i % 3 + 1)));
+      channel->SetAttribute ("Delay", TimeValue (m_delays[i]));
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAttribute ("PointToPointMode", BooleanValue (true));
+          device->SetChannel (channel);
+          nodes[(i + j) % nNodes]->AddDevice (device);
+        }
+    }
+
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      for (uint32_t k = 0; k < 3; k++)
+        {
+          Simulator::ScheduleWithContext (i, MicroSeconds (50 * k), &MultiThreadedSimulatorThreadsTestCase::Forward,
+                                          this, i, 200 - k);
+        }
+    }
+  Simulator::Run ();
+  Time now = Simulator::Now ();
+
+  std::set<uint32_t> uids;
+  uint32_t nUids = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uids.insert (m_uids[i].begin (), m_uids[i].end ());
+      nUids += m_uids[i].size ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (uids.size (), nUids, "The uids of the events of " << simulatorType << " are not unique");
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  return now;
+}
+
+void
+MultiThreadedSimulatorThreadsTestCase::DoRun (void)
+{
+  Log expected;
+  Time expectedEnd = RunRing ("ns3::DefaultSimulatorImpl", false, expected);
+  int64_t stopTs = m_stopTs;
+  Log log;
+  Time end = RunRing ("ns3::MultiThreadedSimulatorImpl", true, log);
+  NS_TEST_EXPECT_MSG_EQ (m_stopTs, stopTs, "The simulation was not stopped at the same time");
+
+  if (!m_stopNow)
+    {
+      // the partitions stop after the events before the stop time
+      NS_TEST_EXPECT_MSG_EQ (end, expectedEnd, "The simulation did not stop at the same time");
+      for (uint32_t i = 0; i < expected.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (log[i].size (), expected[i].size (),
+                                 "Node " << i << " did not execute the same number of events");
+          for (uint32_t j = 0; j < expected[i].size (); j++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (log[i][j].first, expected[i][j].first,
+                                     "Event " << j << " of node " << i << " not executed at the same time");
+              NS_TEST_EXPECT_MSG_EQ (log[i][j].second, expected[i][j].second,
+                                     "Event " << j << " of node " << i << " not the same");
+            }
+        }
+      return;
+    }
+
+  // the other partitions complete the window of the stop: the events before
+  // the stop are those of the default simulator, and the events after it do
+  // not depend on the threads
+  Log sequential;
+  RunRing ("ns3::MultiThreadedSimulatorImpl", false, sequential);
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      uint32_t j = 0;
+      for (; j < expected[i].size () && expected[i][j].first < stopTs; j++)
+        {
+          NS_TEST_ASSERT_MSG_LT (j, log[i].size (), "Node " << i << " did not execute event " << j);
+          NS_TEST_EXPECT_MSG_EQ (log[i][j].first, expected[i][j].first,
+                                 "Event " << j << " of node " << i << " not executed at the same time");
+          NS_TEST_EXPECT_MSG_EQ (log[i][j].second, expected[i][j].second,
+                                 "Event " << j << " of node " << i << " not the same");
+        }
+      NS_TEST_EXPECT_MSG_EQ ((log[i].size () == j || log[i][j].first >= stopTs), true,
+                             "Node " << i << " executed an extra event before the stop");
+      NS_TEST_EXPECT_MSG_EQ ((log[i] == sequential[i]), true,
+                             "The events of node " << i << " depend on the threads");
+    }
+  // the partition of the node which called Stop stops at once
+  NS_TEST_EXPECT_MSG_EQ (log[5].back ().first, stopTs, "The node which called Stop executed events after it");
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief The multi-threaded simulator TestSuite.
+ */
+class MultiThreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultiThreadedSimulatorTestSuite ();
+};
+
+MultiThreadedSimulatorTestSuite::MultiThreadedSimulatorTestSuite ()
+  : TestSuite ("multi-threaded-simulator", UNIT)
+{
+  AddTestCase (new MultiThreadedSimulatorRingTestCase (1), TestCase::QUICK);
+  AddTestCase (new MultiThreadedSimulatorRingTestCase (2), TestCase::QUICK);
+  AddTestCase (new MultiThreadedSimulatorRingTestCase (4), TestCase::QUICK);
+  AddTestCase (new MultiThreadedSimulatorRingTestCase (7), TestCase::QUICK);
+  AddTestCase (new MultiThreadedSimulatorThreadsTestCase (false), TestCase::QUICK);
+  AddTestCase (new MultiThreadedSimulatorThreadsTestCase (true), TestCase::QUICK);
+}
+
+static MultiThreadedSimulatorTestSuite g_multiThreadedSimulatorTestSuite; //!< Static variable for test initialization
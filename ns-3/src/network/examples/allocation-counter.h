@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Count the heap allocations of a benchmark program
+ *
+ * allocation-counter.cc replaces the global allocation and deallocation
+ * functions of the program it is linked into, hence it is only meant to be
+ * linked into stand-alone benchmark programs, not into a library. Only the
+ * allocations performed between Start and Stop are counted, and the counts
+ * are not thread-safe.
+ */
+class AllocationCounter
+{
+public:
+  /**
+   * Reset the counts and start counting the allocations
+   */
+  static void Start (void);
+  /**
+   * Stop counting the allocations
+   */
+  static void Stop (void);
+  /**
+   * \return the number of allocations counted
+   */
+  static uint64_t GetAllocations (void);
+  /**
+   * \return the number of bytes allocated by the allocations counted
+   */
+  static uint64_t GetBytes (void);
+};
+
+} // namespace ns3
+
+#endif /* ALLOCATION_COUNTER_H */
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program compares the cost of the drop tail queue when its packets are
+// stored in a list (the default) and in a ring buffer. Two access patterns are
+// measured for an increasing queue occupancy: in the steady pattern, the queue
+// holds the given number of packets and every operation is a dequeue followed
+// by an enqueue; in the burst pattern, the queue is repeatedly filled up to the
+// given number of packets and then emptied. The packets are created before the
+// timed operations, so that the reported allocations are those of the queue.
+// Sample usage:  ./waf --run 'queue-benchmark --maxOccupancy=16384'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "allocation-counter.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QueueBenchmark");
+
+/**
+ * Results of a benchmark
+ */
+struct BenchmarkResult
+{
+  double nsPerOp;           //!< the average cost (in nanoseconds) of an operation
+  double allocationsPerOp;  //!< the average number of allocations per operation
+  double bytesPerOp;        //!< the average number of bytes allocated per operation
+};
+
+/**
+ * Measure the cost of the operations on a drop tail queue
+ * \param storage the container storing the packets
+ * \param occupancy the number of packets stored in the queue
+ * \param operations the number of timed operations (enqueues plus dequeues)
+ * \param burst whether to fill and empty the queue (burst pattern) rather than
+ *        keeping its occupancy constant (steady pattern)
+ * \return the results of the benchmark
+ */
+static BenchmarkResult
+RunQueueBench (QueueStorageType storage, uint32_t occupancy, uint32_t operations, bool burst)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetStorage (storage);
+  queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, occupancy + 1));
+
+  std::vector<Ptr<Packet> > packets;
+  packets.reserve (occupancy + 1);
+  for (uint32_t i = 0; i <= occupancy; i++)
+    {
+      packets.push_back (Create<Packet> (1000));
+    }
+
+  // the queue is filled (and emptied) once before the timed operations, as a
+  // queue reaches its peak occupancy in the first instants of a simulation
+  for (uint32_t i = 0; i < occupancy; i++)
+    {
+      queue->Enqueue (packets[i]);
+    }
+  if (burst)
+    {
+      for (uint32_t i = 0; i < occupancy; i++)
+        {
+          queue->Dequeue ();
+        }
+    }
+
+  uint32_t cycles = operations / (burst ? 2 * occupancy : 2);
+  if (cycles == 0)
+    {
+      cycles = 1;
+    }
+  AllocationCounter::Start ();
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t c = 0; c < cycles; c++)
+    {
+      if (burst)
+        {
+          for (uint32_t i = 0; i < occupancy; i++)
+            {
+              queue->Enqueue (packets[i]);
+            }
+          for (uint32_t i = 0; i < occupancy; i++)
+            {
+              queue->Dequeue ();
+            }
+        }
+      else
+        {
+          queue->Enqueue (queue->Dequeue ());
+        }
+    }
+  int64_t elapsed = clock.End ();
+  AllocationCounter::Stop ();
+
+  uint64_t ops = static_cast<uint64_t> (cycles) * (burst ? 2 * occupancy : 2);
+  BenchmarkResult result;
+  result.nsPerOp = elapsed * 1e6 / ops;
+  result.allocationsPerOp = static_cast<double> (AllocationCounter::GetAllocations ()) / ops;
+  result.bytesPerOp = static_cast<double> (AllocationCounter::GetBytes ()) / ops;
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minOccupancy = 1;
+  uint32_t maxOccupancy = 16384;
+  uint32_t operations = 4000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("minOccupancy", "Smallest number of packets in the queue", minOccupancy);
+  cmd.AddValue ("maxOccupancy", "Largest number of packets in the queue", maxOccupancy);
+  cmd.AddValue ("operations", "Number of timed operations", operations);
+  cmd.Parse (argc, argv);
+
+  std::cout << "pattern,storage,occupancy,operations,ns_per_op,allocations_per_op,bytes_per_op" << std::endl;
+  for (uint32_t b = 0; b < 2; b++)
+    {
+      bool burst = (b == 1);
+      for (uint32_t occupancy = minOccupancy; occupancy <= maxOccupancy; occupancy *= 8)
+        {
+          for (uint32_t s = 0; s < 2; s++)
+            {
+              QueueStorageType storage = (s == 0 ? LIST_STORAGE : RING_BUFFER_STORAGE);
+              BenchmarkResult r = RunQueueBench (storage, occupancy, operations, burst);
+              std::cout << (burst ? "burst" : "steady") << "," << (s == 0 ? "list" : "ring")
+                        << "," << occupancy << "," << operations << "," << r.nsPerOp << ","
+                        << r.allocationsPerOp << "," << r.bytesPerOp << std::endl;
+            }
+        }
+    }
+
+  return 0;
+}
@@ -262,8 +262,7 @@ Buffer::operator = (Buffer const&o)
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Recycle (m_data);
         }
@@ -285,8 +284,7 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
@@ -328,8 +326,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (--m_data->m_count == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -373,8 +370,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Buffer::Recycle (m_data);
         }
@@ -24,8 +24,14 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// the free list is not shared by the threads of a multi-threaded simulation
+#ifndef NS3_MTP
 #define BUFFER_FREE_LIST 1
+#endif
 
 namespace ns3 {
 
@@ -663,7 +669,11 @@ private:
      * The reference count of an instance of this data structure.
      * Each buffer which references an instance holds a count.
      */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /**
      * the size of the m_data field below.
      */
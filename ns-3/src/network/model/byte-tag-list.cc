@@ -22,8 +22,14 @@
 #include <vector>
 #include <cstring>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// the free list is not shared by the threads of a multi-threaded simulation
+#ifndef NS3_MTP
 #define USE_FREE_LIST 1
+#endif
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
@@ -40,7 +46,11 @@ NS_LOG_COMPONENT_DEFINE ("ByteTagList");
  */
 struct ByteTagListData {
   uint32_t size;   //!< size of the data
+#ifdef NS3_MTP
+  std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+#else
   uint32_t count;  //!< use counter (for smart deallocation)
+#endif
   uint32_t dirty;  //!< number of bytes actually in use
   uint8_t data[4]; //!< data
 };
@@ -376,8 +386,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
       return;
     }
   g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  if (--data->count == 0)
     {
       if (g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
@@ -414,8 +423,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  if (--data->count == 0)
     {
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
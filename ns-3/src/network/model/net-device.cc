@@ -41,4 +41,19 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBurst (const std::vector<BurstPacket> &burst)
+{
+  NS_LOG_FUNCTION (this << burst.size ());
+  uint32_t nSent = 0;
+  for (auto &p : burst)
+    {
+      if (Send (p.packet, p.dest, p.protocolNumber))
+        {
+          nSent++;
+        }
+    }
+  return nSent;
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -260,6 +261,30 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+
+  /**
+   * \brief A packet to be sent as part of a burst, along with the arguments of Send
+   */
+  struct BurstPacket
+  {
+    Ptr<Packet> packet;        //!< packet sent from above down to Network Device
+    Address dest;              //!< mac address of the destination (already resolved)
+    uint16_t protocolNumber;   //!< type of payload contained in the packet
+  };
+
+  /**
+   * \param burst the packets to send, in transmission order
+   *
+   *  Called from higher layer (typically, the root queue disc performing a bulk
+   *  dequeue) to send a burst of packets into Network Device. This is similar
+   *  to the xmit_more hint of the Linux kernel: devices can override this
+   *  method to queue all the packets first and start the transmission once,
+   *  rather than once per packet. The default implementation calls Send for
+   *  each packet.
+   *
+   * \return the number of packets for which the Send operation succeeded
+   */
+  virtual uint32_t SendBurst (const std::vector<BurstPacket> &burst);
   /**
    * \returns the node base class which contains this network
    *          interface.
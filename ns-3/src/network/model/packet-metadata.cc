@@ -77,8 +77,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -596,6 +595,11 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
+#ifdef NS3_MTP
+  // the free list is not shared by the threads of a multi-threaded simulation
+  PacketMetadata::Deallocate (data);
+  return;
+#endif
   if (!m_enable)
     {
       PacketMetadata::Deallocate (data);
@@ -23,6 +23,9 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -413,7 +416,11 @@ private:
    */
   struct Data {
     /** number of references to this struct Data instance. */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /** size (in bytes) of m_data buffer below */
     uint16_t m_size;
     /** max of the m_used field over all objects which
@@ -722,8 +729,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           PacketMetadata::Recycle (m_data);
         }
@@ -740,8 +746,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
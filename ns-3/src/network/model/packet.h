@@ -34,6 +34,9 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3 {
 
@@ -766,7 +769,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+#else
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
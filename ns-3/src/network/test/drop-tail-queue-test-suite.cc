@@ -19,6 +19,10 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/string.h"
+#include "ns3/object-factory.h"
+#include "ns3/ring-buffer.h"
+#include <iterator>
+#include <list>
 
 using namespace ns3;
 
@@ -83,6 +87,133 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a drop tail queue storing its packets in a ring buffer keeps
+ * them in FIFO order while the buffer grows and its head wraps around, and
+ * when the packets are moved between a list and a ring buffer.
+ */
+class RingBufferDropTailQueueTestCase : public TestCase
+{
+public:
+  RingBufferDropTailQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferDropTailQueueTestCase::RingBufferDropTailQueueTestCase ()
+  : TestCase ("Sanity check on the drop tail queue storing packets in a ring buffer")
+{
+}
+void
+RingBufferDropTailQueueTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::DropTailQueue<Packet>");
+  factory.Set ("MaxSize", StringValue ("40p"));
+  factory.Set ("Storage", StringValue ("RingBuffer"));
+  Ptr<Queue<Packet> > queue = factory.Create<Queue<Packet> > ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStorage (), RING_BUFFER_STORAGE, "The packets should be stored in a ring buffer");
+
+  std::list<Ptr<Packet> > expected;
+
+  // the occupancy oscillates between 0 and 40 packets, so that the buffer grows
+  // to 64 slots and its head moves across the whole buffer
+  for (uint32_t round = 0; round < 6; round++)
+    {
+      for (uint32_t i = 0; i < 45; i++)
+        {
+          Ptr<Packet> p = Create<Packet> (100);
+          bool enqueued = queue->Enqueue (p);
+          NS_TEST_EXPECT_MSG_EQ (enqueued, (expected.size () < 40), "Unexpected result of the enqueue");
+          if (enqueued)
+            {
+              expected.push_back (p);
+            }
+        }
+      for (uint32_t i = 0; i < 37; i++)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_EXPECT_MSG_EQ (p->GetUid (), expected.front ()->GetUid (), "Packets were reordered");
+          expected.pop_front ();
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), expected.size (), "Unexpected number of packets");
+
+      // the packets are moved to the other container without being reordered
+      queue->SetStorage (round % 2 ? RING_BUFFER_STORAGE : LIST_STORAGE);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), expected.front ()->GetUid (), "Unexpected head packet");
+  queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "There should be no packets in there");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "There are really no packets in there");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that inserting and erasing elements at arbitrary positions of a ring
+ * buffer gives the same sequence of elements as a list.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check insertions and removals at arbitrary positions of a ring buffer")
+{
+}
+void
+RingBufferTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> buffer;
+  std::list<uint32_t> list;
+  uint32_t seed = 1;
+
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      uint32_t r = seed >> 16;
+      // insert more often than erase, so that the buffer grows a few times
+      bool insert = list.empty () || (r % 5) < 3;
+      uint32_t pos = (r / 5) % (list.size () + (insert ? 1 : 0));
+
+      RingBuffer<uint32_t>::const_iterator bit = buffer.cbegin ();
+      std::advance (bit, pos);
+      std::list<uint32_t>::iterator lit = list.begin ();
+      std::advance (lit, pos);
+
+      if (insert)
+        {
+          NS_TEST_EXPECT_MSG_EQ (*buffer.insert (bit, i), i, "Wrong element inserted");
+          list.insert (lit, i);
+        }
+      else
+        {
+          bit = buffer.erase (bit);
+          lit = list.erase (lit);
+          NS_TEST_EXPECT_MSG_EQ ((bit == buffer.cend ()), (lit == list.end ()),
+                                 "Wrong iterator returned by erase");
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer.size (), list.size (), "Wrong number of elements");
+    }
+
+  NS_TEST_EXPECT_MSG_EQ ((buffer.capacity () >= buffer.size ()), true, "Wrong capacity");
+  std::list<uint32_t>::const_iterator lit = list.cbegin ();
+  for (RingBuffer<uint32_t>::const_iterator bit = buffer.cbegin (); bit != buffer.cend (); ++bit, ++lit)
+    {
+      NS_TEST_EXPECT_MSG_EQ (*bit, *lit, "Elements are in a different order");
+    }
+
+  buffer.clear ();
+  NS_TEST_EXPECT_MSG_EQ (buffer.empty (), true, "The buffer should be empty");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +227,8 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferDropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
   }
 };
 
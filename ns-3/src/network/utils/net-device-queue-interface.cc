@@ -18,6 +18,7 @@
  * Author: Stefano Avallone <stefano.avallone@.unina.it>
  */
 
+#include <algorithm>
 #include "ns3/abort.h"
 #include "ns3/queue-limits.h"
 #include "ns3/net-device-queue-interface.h"
@@ -43,6 +44,7 @@ NetDeviceQueue::~NetDeviceQueue ()
 
   m_queueLimits = 0;
   m_wakeCallback.Nullify ();
+  m_slotsCallback.Nullify ();
   m_device = 0;
 }
 
@@ -53,6 +55,22 @@ NetDeviceQueue::IsStopped (void) const
   return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetNSlots (uint32_t max) const
+{
+  NS_LOG_FUNCTION (this << max);
+
+  if (IsStopped ())
+    {
+      return 0;
+    }
+  if (m_slotsCallback.IsNull ())
+    {
+      return std::min (max, 1u);
+    }
+  return m_slotsCallback (max);
+}
+
 void
 NetDeviceQueue::Start (void)
 {
@@ -184,8 +202,8 @@ NetDeviceQueueInterface::NetDeviceQueueInterface ()
 {
   NS_LOG_FUNCTION (this);
 
-  // the default select queue callback returns 0
-  m_selectQueueCallback = [] (Ptr<QueueItem> item) { return 0; };
+  // no select queue callback is set by default, in which case the traffic
+  // control layer (or the root queue disc) selects the transmission queue
 }
 
 NetDeviceQueueInterface::~NetDeviceQueueInterface ()
@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -196,11 +197,38 @@ public:
   template <typename QueueType>
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
+  /**
+   * \brief Get the number of packets that can be enqueued before the device
+   *        transmission queue is stopped
+   * \param max the maximum value to return
+   * \return the number of MTU-sized packets (capped at max) that the device queue
+   *         connected through ConnectQueueTraces can store before being stopped.
+   *         If no queue was connected, return 0 if this transmission queue is
+   *         stopped and 1 otherwise.
+   *
+   * Called by queue discs to bound the size of the bursts of packets they send
+   * to the device.
+   */
+  uint32_t GetNSlots (uint32_t max) const;
+
 private:
+  /**
+   * \brief Count the number of packets that can be enqueued before the device
+   *        queue is stopped
+   *
+   * \param queue the device queue
+   * \param max the maximum value to return
+   * \return the number of MTU-sized packets (capped at max) the queue can store
+   *         before being stopped
+   */
+  template <typename QueueType>
+  uint32_t CountSlots (QueueType* queue, uint32_t max);
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
+  Callback<uint32_t, uint32_t> m_slotsCallback;  //!< Callback counting the free slots of the device queue
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
@@ -278,7 +306,8 @@ public:
    * \return the select queue callback.
    *
    * Called by the traffic control layer to get the select queue callback set
-   * by a multi-queue device.
+   * by a multi-queue device. If no callback is set, the packets are sent to
+   * the first transmission queue, unless the root queue disc selects another one.
    */
   SelectQueueCallback GetSelectQueueCallback (void) const;
 
@@ -317,6 +346,8 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+  m_slotsCallback = MakeCallback (&NetDeviceQueue::CountSlots<QueueType>, this)
+                    .Bind (PeekPointer (queue));
 }
 
 template <typename QueueType>
@@ -364,6 +395,27 @@ NetDeviceQueue::PacketDequeued (QueueType* queue, Ptr<const typename QueueType::
     }
 }
 
+template <typename QueueType>
+uint32_t
+NetDeviceQueue::CountSlots (QueueType* queue, uint32_t max)
+{
+  NS_LOG_FUNCTION (this << queue << max);
+
+  NS_ASSERT_MSG (m_device, "Aggregated NetDevice not set");
+  Ptr<Packet> p = Create<Packet> (m_device->GetMtu ());
+
+  // A packet can be enqueued as long as the queue is able to store a packet
+  // of MTU size, otherwise the queue is stopped (see PacketEnqueued)
+  QueueSize size = queue->GetCurrentSize ();
+  uint32_t slots = 0;
+  while (slots < max && size + p <= queue->GetMaxSize ())
+    {
+      size = size + p;
+      slots++;
+    }
+  return slots;
+}
+
 template <typename QueueType>
 void
 NetDeviceQueue::PacketDiscarded (QueueType* queue, Ptr<const typename QueueType::ItemType> item)
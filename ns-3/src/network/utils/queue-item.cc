@@ -21,11 +21,34 @@
 #include "queue-item.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/free-list-pool.h"
+#include <new>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("QueueItem");
 
+/**
+ * \brief A global switch to recycle the memory of the queue disc items.
+ */
+static GlobalValue g_queueDiscItemPool = GlobalValue ("QueueDiscItemPool",
+                                                      "Whether the memory of the deleted queue disc items is kept in free lists and reused",
+                                                      BooleanValue (true),
+                                                      MakeBooleanChecker ());
+
+/**
+ * \return the registry of the pools of the queue disc items
+ */
+static FreeListPool::Registry&
+GetQueueDiscItemPools (void)
+{
+  // never destroyed, as the pools of the threads may outlive static objects
+  static FreeListPool::Registry *registry = new FreeListPool::Registry (g_queueDiscItemPool);
+  return *registry;
+}
+
 QueueItem::QueueItem (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
@@ -87,6 +110,33 @@ QueueDiscItem::~QueueDiscItem()
   NS_LOG_FUNCTION (this);
 }
 
+void*
+QueueDiscItem::operator new (std::size_t size)
+{
+  FreeListPool *pool = FreeListPool::Get<QueueDiscItem> (GetQueueDiscItemPools ());
+  if (pool == 0)
+    {
+      return ::operator new (FreeListPool::GetBlockSize (size));
+    }
+  return pool->Allocate (size);
+}
+
+void
+QueueDiscItem::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  FreeListPool *pool = FreeListPool::Get<QueueDiscItem> (GetQueueDiscItemPools ());
+  if (pool == 0)
+    {
+      ::operator delete (p);
+      return;
+    }
+  pool->Release (p, size);
+}
+
 Address
 QueueDiscItem::GetAddress (void) const
 {
@@ -24,6 +24,7 @@
 #include "ns3/simple-ref-count.h"
 #include <ns3/address.h>
 #include "ns3/nstime.h"
+#include <cstddef>
 
 namespace ns3 {
 
@@ -226,6 +227,28 @@ public:
    */
   virtual uint32_t Hash (uint32_t perturbation = 0) const;
 
+  /**
+   * \brief Allocate the memory for a queue disc item
+   *
+   * Unless disabled through the QueueDiscItemPool global value (which is read
+   * when the first item is created), the memory of the items that are deleted
+   * is kept in free lists, one per block size, and reused to create new items,
+   * so that creating and deleting items of any subclass does not involve the
+   * system allocator in steady state. The free lists are provided by
+   * FreeListPool, hence each thread has its own.
+   *
+   * \param size the size of the item
+   * \return a pointer to the allocated memory
+   */
+  static void* operator new (std::size_t size);
+
+  /**
+   * \brief Release the memory of a queue disc item
+   * \param p a pointer to the memory of the item
+   * \param size the size of the item
+   */
+  static void operator delete (void *p, std::size_t size);
+
 private:
   /**
    * \brief Default constructor
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUEUE_STORAGE_H
+#define QUEUE_STORAGE_H
+
+#include "ns3/ring-buffer.h"
+#include <cstddef>
+#include <iterator>
+#include <list>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * Enumeration of the containers that can store the items of a queue
+ */
+enum QueueStorageType
+{
+  LIST_STORAGE,         //!< a std::list, which allocates a node per item
+  RING_BUFFER_STORAGE   //!< a RingBuffer, which reuses a contiguous array
+};
+
+/**
+ * \ingroup queue
+ *
+ * \brief The container of the items stored in a queue
+ *
+ * The items are stored either in a std::list or in a RingBuffer. The type of
+ * container can be changed at any time, in which case the stored items are
+ * moved to the new container. The iterators of a list are only invalidated
+ * when the element they refer to is erased, while the iterators of a ring
+ * buffer are invalidated by any insertion or removal.
+ */
+template <typename T>
+class QueueStorage
+{
+public:
+  /**
+   * \brief Const iterator over the elements of a QueueStorage
+   */
+  class const_iterator
+  {
+public:
+    /// Iterator category
+    typedef std::bidirectional_iterator_tag iterator_category;
+    /// Type of the elements
+    typedef T value_type;
+    /// Type of the difference between two iterators
+    typedef std::ptrdiff_t difference_type;
+    /// Pointer to an element
+    typedef const T* pointer;
+    /// Reference to an element
+    typedef const T& reference;
+
+    const_iterator ()
+      : m_ring (false)
+    {
+    }
+    /**
+     * Constructor
+     * \param it an iterator of the list
+     */
+    const_iterator (typename std::list<T>::const_iterator it)
+      : m_listIt (it),
+        m_ring (false)
+    {
+    }
+    /**
+     * Constructor
+     * \param it an iterator of the ring buffer
+     */
+    const_iterator (typename RingBuffer<T>::const_iterator it)
+      : m_ringIt (it),
+        m_ring (true)
+    {
+    }
+    /// \return a reference to the element
+    reference operator* () const
+    {
+      return m_ring ? *m_ringIt : *m_listIt;
+    }
+    /// \return a pointer to the element
+    pointer operator-> () const
+    {
+      return &(**this);
+    }
+    /// \return the iterator to the next element
+    const_iterator& operator++ ()
+    {
+      if (m_ring)
+        {
+          ++m_ringIt;
+        }
+      else
+        {
+          ++m_listIt;
+        }
+      return *this;
+    }
+    /// \return the iterator before the increment
+    const_iterator operator++ (int)
+    {
+      const_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+    /// \return the iterator to the previous element
+    const_iterator& operator-- ()
+    {
+      if (m_ring)
+        {
+          --m_ringIt;
+        }
+      else
+        {
+          --m_listIt;
+        }
+      return *this;
+    }
+    /// \return the iterator before the decrement
+    const_iterator operator-- (int)
+    {
+      const_iterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+    /**
+     * \param other the other iterator
+     * \return true if both iterators refer to the same element
+     */
+    bool operator== (const const_iterator &other) const
+    {
+      return m_ring ? m_ringIt == other.m_ringIt : m_listIt == other.m_listIt;
+    }
+    /**
+     * \param other the other iterator
+     * \return true if the iterators refer to different elements
+     */
+    bool operator!= (const const_iterator &other) const
+    {
+      return !(*this == other);
+    }
+
+private:
+    friend class QueueStorage<T>;
+    typename std::list<T>::const_iterator m_listIt;   //!< the iterator of the list
+    typename RingBuffer<T>::const_iterator m_ringIt;  //!< the iterator of the ring buffer
+    bool m_ring;                                      //!< whether the ring buffer is used
+  };
+
+  QueueStorage ()
+    : m_type (LIST_STORAGE)
+  {
+  }
+
+  /**
+   * Set the type of container, moving the stored elements to the new container
+   * \param type the type of container
+   */
+  void SetType (QueueStorageType type)
+  {
+    if (type == m_type)
+      {
+        return;
+      }
+    if (type == RING_BUFFER_STORAGE)
+      {
+        for (typename std::list<T>::const_iterator it = m_list.cbegin (); it != m_list.cend (); ++it)
+          {
+            m_ring.insert (m_ring.cend (), *it);
+          }
+        m_list.clear ();
+      }
+    else
+      {
+        for (typename RingBuffer<T>::const_iterator it = m_ring.cbegin (); it != m_ring.cend (); ++it)
+          {
+            m_list.push_back (*it);
+          }
+        m_ring.clear ();
+      }
+    m_type = type;
+  }
+  /// \return the type of container
+  QueueStorageType GetType (void) const
+  {
+    return m_type;
+  }
+
+  /// \return a const iterator to the first element
+  const_iterator cbegin (void) const
+  {
+    return m_type == RING_BUFFER_STORAGE ? const_iterator (m_ring.cbegin ())
+                                         : const_iterator (m_list.cbegin ());
+  }
+  /// \return a const iterator past the last element
+  const_iterator cend (void) const
+  {
+    return m_type == RING_BUFFER_STORAGE ? const_iterator (m_ring.cend ())
+                                         : const_iterator (m_list.cend ());
+  }
+  /// \return the number of stored elements
+  std::size_t size (void) const
+  {
+    return m_type == RING_BUFFER_STORAGE ? m_ring.size () : m_list.size ();
+  }
+  /// \return true if no element is stored
+  bool empty (void) const
+  {
+    return m_type == RING_BUFFER_STORAGE ? m_ring.empty () : m_list.empty ();
+  }
+  /**
+   * Insert an element before the given position
+   * \param pos the position
+   * \param value the element
+   * \return an iterator to the inserted element
+   */
+  const_iterator insert (const_iterator pos, const T &value)
+  {
+    if (m_type == RING_BUFFER_STORAGE)
+      {
+        return const_iterator (m_ring.insert (pos.m_ringIt, value));
+      }
+    return const_iterator (typename std::list<T>::const_iterator (m_list.insert (pos.m_listIt, value)));
+  }
+  /**
+   * Erase the element at the given position
+   * \param pos the position
+   * \return an iterator to the element following the erased one
+   */
+  const_iterator erase (const_iterator pos)
+  {
+    if (m_type == RING_BUFFER_STORAGE)
+      {
+        return const_iterator (m_ring.erase (pos.m_ringIt));
+      }
+    return const_iterator (typename std::list<T>::const_iterator (m_list.erase (pos.m_listIt)));
+  }
+
+private:
+  QueueStorageType m_type;  //!< the type of container
+  std::list<T> m_list;      //!< the list storing the elements
+  RingBuffer<T> m_ring;     //!< the ring buffer storing the elements
+};
+
+} // namespace ns3
+
+#endif /* QUEUE_STORAGE_H */
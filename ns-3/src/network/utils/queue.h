@@ -31,6 +31,8 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/queue-storage.h"
+#include "ns3/enum.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -238,6 +240,15 @@ private:
  * methods in doing so, to ensure that appropriate trace sources are called
  * and statistics are maintained.
  *
+ * The Storage attribute selects the container of the items. A list allocates
+ * a node for every enqueued item, while a ring buffer stores the items in a
+ * contiguous array that is reused once it has grown to the peak occupancy of
+ * the queue. Both containers support inserting and removing items at any
+ * position, but the iterators of a ring buffer are invalidated by every
+ * insertion or removal, hence subclasses that remove items while iterating
+ * over the queue (e.g., WifiMacQueue) continue from the position of the next
+ * item returned by DoRemove.
+ *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
  * of the templates included in this file. Thus, do not include queue.h but add
@@ -295,13 +306,25 @@ public:
    */
   void Flush (void);
 
+  /**
+   * Set the type of container storing the items. The items currently stored
+   * in the queue, if any, are moved to the new container.
+   * \param type the type of container
+   */
+  void SetStorage (QueueStorageType type);
+
+  /**
+   * \return the type of container storing the items
+   */
+  QueueStorageType GetStorage (void) const;
+
   /// Define ItemType as the type of the stored elements
   typedef Item ItemType;
 
 protected:
 
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename QueueStorage<Ptr<Item> >::const_iterator ConstIterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -357,6 +380,15 @@ protected:
    */
   Ptr<Item> DoRemove (ConstIterator pos);
 
+  /**
+   * Pull the item to drop from the queue, and get the position of the item
+   * that followed it, which is valid whatever the storage of the queue
+   * \param pos the position of the item to remove
+   * \param next set to the position of the item that followed the removed one
+   * \return the item.
+   */
+  Ptr<Item> DoRemove (ConstIterator pos, ConstIterator &next);
+
   /**
    * Peek the front item in the queue
    * \param pos the position of the item to peek
@@ -385,7 +417,7 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  QueueStorage<Ptr<Item> > m_packets;       //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -413,6 +445,14 @@ Queue<Item>::GetTypeId (void)
   static TypeId tid = TypeId (("ns3::Queue<" + name + ">").c_str ())
     .SetParent<QueueBase> ()
     .SetGroupName ("Network")
+    .AddAttribute ("Storage",
+                   "The container storing the items: a list, which allocates a node per item, "
+                   "or a ring buffer, which reuses a contiguous array.",
+                   EnumValue (LIST_STORAGE),
+                   MakeEnumAccessor (&Queue<Item>::SetStorage,
+                                     &Queue<Item>::GetStorage),
+                   MakeEnumChecker (LIST_STORAGE, "List",
+                                    RING_BUFFER_STORAGE, "RingBuffer"))
     .AddTraceSource ("Enqueue", "Enqueue a packet in the queue.",
                      MakeTraceSourceAccessor (&Queue<Item>::m_traceEnqueue),
                      "ns3::" + name + "::TracedCallback")
@@ -503,17 +543,26 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 template <typename Item>
 Ptr<Item>
 Queue<Item>::DoRemove (ConstIterator pos)
+{
+  ConstIterator next;
+  return DoRemove (pos, next);
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoRemove (ConstIterator pos, ConstIterator &next)
 {
   NS_LOG_FUNCTION (this);
 
   if (m_nPackets.Get () == 0)
     {
       NS_LOG_LOGIC ("Queue empty");
+      next = pos;
       return 0;
     }
 
   Ptr<Item> item = *pos;
-  m_packets.erase (pos);
+  next = m_packets.erase (pos);
 
   if (item != 0)
     {
@@ -543,6 +592,21 @@ Queue<Item>::Flush (void)
     }
 }
 
+template <typename Item>
+void
+Queue<Item>::SetStorage (QueueStorageType type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_packets.SetType (type);
+}
+
+template <typename Item>
+QueueStorageType
+Queue<Item>::GetStorage (void) const
+{
+  return m_packets.GetType ();
+}
+
 template <typename Item>
 Ptr<const Item>
 Queue<Item>::DoPeek (ConstIterator pos) const
@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable circular buffer stored in a contiguous array
+ *
+ * RingBuffer provides the subset of the std::list interface used by the
+ * Queue template class (const iterators, insert and erase at any position),
+ * so that it can be used as the container of the items stored in a queue.
+ * Elements are stored in a vector whose size is a power of two, starting
+ * at a head index that wraps around. Inserting at the tail or at the head
+ * and erasing the head or the tail take constant time and, once the vector
+ * has grown large enough, do not allocate memory. Inserting or erasing in
+ * the middle moves the elements on the shorter side of the position.
+ *
+ * As opposed to std::list, inserting or erasing an element invalidates all
+ * the iterators.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /// Type of the stored elements
+  typedef T value_type;
+
+  /**
+   * \brief Const iterator over the elements of a RingBuffer
+   *
+   * The iterator stores the logical index of the element (i.e., its distance
+   * from the head of the buffer).
+   */
+  class const_iterator
+  {
+public:
+    /// Iterator category
+    typedef std::bidirectional_iterator_tag iterator_category;
+    /// Type of the elements
+    typedef T value_type;
+    /// Type of the difference between two iterators
+    typedef std::ptrdiff_t difference_type;
+    /// Pointer to an element
+    typedef const T* pointer;
+    /// Reference to an element
+    typedef const T& reference;
+
+    const_iterator ()
+      : m_buffer (0),
+        m_index (0)
+    {
+    }
+    /**
+     * Constructor
+     * \param buffer the ring buffer
+     * \param index the logical index of the element
+     */
+    const_iterator (const RingBuffer<T> *buffer, std::size_t index)
+      : m_buffer (buffer),
+        m_index (index)
+    {
+    }
+    /// \return a reference to the element
+    reference operator* () const
+    {
+      return m_buffer->At (m_index);
+    }
+    /// \return a pointer to the element
+    pointer operator-> () const
+    {
+      return &m_buffer->At (m_index);
+    }
+    /// \return the iterator to the next element
+    const_iterator& operator++ ()
+    {
+      m_index++;
+      return *this;
+    }
+    /// \return the iterator before the increment
+    const_iterator operator++ (int)
+    {
+      const_iterator tmp = *this;
+      m_index++;
+      return tmp;
+    }
+    /// \return the iterator to the previous element
+    const_iterator& operator-- ()
+    {
+      m_index--;
+      return *this;
+    }
+    /// \return the iterator before the decrement
+    const_iterator operator-- (int)
+    {
+      const_iterator tmp = *this;
+      m_index--;
+      return tmp;
+    }
+    /**
+     * \param other the other iterator
+     * \return true if both iterators refer to the same element
+     */
+    bool operator== (const const_iterator &other) const
+    {
+      return m_buffer == other.m_buffer && m_index == other.m_index;
+    }
+    /**
+     * \param other the other iterator
+     * \return true if the iterators refer to different elements
+     */
+    bool operator!= (const const_iterator &other) const
+    {
+      return !(*this == other);
+    }
+
+private:
+    friend class RingBuffer<T>;
+    const RingBuffer<T> *m_buffer; //!< the ring buffer
+    std::size_t m_index;           //!< the logical index of the element
+  };
+
+  RingBuffer ()
+    : m_head (0),
+      m_size (0)
+  {
+  }
+
+  /// \return a const iterator to the first element
+  const_iterator begin (void) const
+  {
+    return const_iterator (this, 0);
+  }
+  /// \return a const iterator past the last element
+  const_iterator end (void) const
+  {
+    return const_iterator (this, m_size);
+  }
+  /// \return a const iterator to the first element
+  const_iterator cbegin (void) const
+  {
+    return begin ();
+  }
+  /// \return a const iterator past the last element
+  const_iterator cend (void) const
+  {
+    return end ();
+  }
+  /// \return the number of stored elements
+  std::size_t size (void) const
+  {
+    return m_size;
+  }
+  /// \return true if no element is stored
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+  /// \return the number of elements that can be stored without growing
+  std::size_t capacity (void) const
+  {
+    return m_slots.size ();
+  }
+  /**
+   * Make room for the given number of elements, so that the buffer does not
+   * grow until it stores more elements.
+   * \param n the number of elements
+   */
+  void reserve (std::size_t n)
+  {
+    while (m_slots.size () < n)
+      {
+        Grow ();
+      }
+  }
+
+  /**
+   * Insert an element before the given position
+   * \param pos the position
+   * \param value the element
+   * \return an iterator to the inserted element
+   */
+  const_iterator insert (const_iterator pos, const T &value)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_index <= m_size);
+    std::size_t index = pos.m_index;
+
+    if (m_size == m_slots.size ())
+      {
+        Grow ();
+      }
+
+    if (index < m_size / 2)
+      {
+        // move the elements before the position one slot towards the head
+        m_head = (m_head + m_slots.size () - 1) & (m_slots.size () - 1);
+        m_size++;
+        for (std::size_t i = 0; i < index; i++)
+          {
+            At (i) = At (i + 1);
+          }
+      }
+    else
+      {
+        // move the elements from the position one slot towards the tail
+        m_size++;
+        for (std::size_t i = m_size - 1; i > index; i--)
+          {
+            At (i) = At (i - 1);
+          }
+      }
+    At (index) = value;
+    return const_iterator (this, index);
+  }
+
+  /**
+   * Erase the element at the given position
+   * \param pos the position
+   * \return an iterator to the element following the erased one
+   */
+  const_iterator erase (const_iterator pos)
+  {
+    NS_ASSERT (pos.m_buffer == this && pos.m_index < m_size);
+    std::size_t index = pos.m_index;
+
+    // the slot left free is reset, so that the element it held is released
+    if (index < m_size / 2)
+      {
+        for (std::size_t i = index; i > 0; i--)
+          {
+            At (i) = At (i - 1);
+          }
+        At (0) = T ();
+        m_head = (m_head + 1) & (m_slots.size () - 1);
+      }
+    else
+      {
+        for (std::size_t i = index; i + 1 < m_size; i++)
+          {
+            At (i) = At (i + 1);
+          }
+        At (m_size - 1) = T ();
+      }
+    m_size--;
+    return const_iterator (this, index);
+  }
+
+  /**
+   * Erase all the elements. The memory of the buffer is kept.
+   */
+  void clear (void)
+  {
+    for (std::size_t i = 0; i < m_size; i++)
+      {
+        At (i) = T ();
+      }
+    m_head = 0;
+    m_size = 0;
+  }
+
+private:
+  /**
+   * \param index the logical index of an element
+   * \return a reference to the element
+   */
+  T& At (std::size_t index)
+  {
+    return m_slots[(m_head + index) & (m_slots.size () - 1)];
+  }
+  /**
+   * \param index the logical index of an element
+   * \return a const reference to the element
+   */
+  const T& At (std::size_t index) const
+  {
+    return m_slots[(m_head + index) & (m_slots.size () - 1)];
+  }
+  /**
+   * Double the size of the vector (which initially holds 16 slots), moving
+   * the elements so that the head is at the beginning of the vector.
+   */
+  void Grow (void)
+  {
+    std::vector<T> slots (m_slots.empty () ? 16 : 2 * m_slots.size ());
+    for (std::size_t i = 0; i < m_size; i++)
+      {
+        slots[i] = At (i);
+      }
+    m_slots.swap (slots);
+    m_head = 0;
+  }
+
+  std::vector<T> m_slots; //!< the slots, whose number is a power of two
+  std::size_t m_head;     //!< the index of the slot storing the first element
+  std::size_t m_size;     //!< the number of stored elements
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
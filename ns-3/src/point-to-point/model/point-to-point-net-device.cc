@@ -556,6 +556,52 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBurst (const std::vector<BurstPacket> &burst)
+{
+  NS_LOG_FUNCTION (this << burst.size ());
+
+  if (IsLinkUp () == false)
+    {
+      for (auto &b : burst)
+        {
+          m_macTxDropTrace (b.packet);
+        }
+      return 0;
+    }
+
+  //
+  // Enqueue all the packets of the burst before looking at the transmit
+  // state machine, so that the transmission is started at most once per burst.
+  //
+  uint32_t nSent = 0;
+  for (auto &b : burst)
+    {
+      Ptr<Packet> packet = b.packet;
+      AddHeader (packet, b.protocolNumber);
+
+      m_macTxTrace (packet);
+
+      if (m_queue->Enqueue (packet))
+        {
+          nSent++;
+        }
+      else
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  if (nSent > 0 && m_txMachineState == READY)
+    {
+      Ptr<Packet> packet = m_queue->Dequeue ();
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      TransmitStart (packet);
+    }
+  return nSent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -94,6 +94,106 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the SendBurst method of PointToPointNetDevice
+ *
+ * It sends a burst of packets from one NetDevice to another, over a
+ * PointToPointChannel, and checks that all of them are received.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param nPackets the number of packets in the burst
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t nPackets);
+
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving NetDevice
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param sender the address of the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &sender);
+
+  uint32_t m_sent;      //!< number of packets accepted by the sending device
+  uint32_t m_received;  //!< number of packets received
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint burst"),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+void
+PointToPointBurstTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t nPackets)
+{
+  std::vector<NetDevice::BurstPacket> burst;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      burst.push_back ({Create<Packet> (100), device->GetBroadcast (), 0x800});
+    }
+  m_sent = device->SendBurst (burst);
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                const Address &sender)
+{
+  m_received++;
+  return true;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  // Node::AddDevice sets the receive callback of the device
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendBurst, this, devA, 5);
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_sent, 5, "All the packets of the burst must be accepted");
+  NS_TEST_EXPECT_MSG_EQ (m_received, 5, "All the packets of the burst must be received");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +210,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "allocation-counter.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+bool g_counting = false;      //!< whether the allocations are being counted
+uint64_t g_allocations = 0;   //!< number of allocations counted
+uint64_t g_bytes = 0;         //!< number of bytes allocated by the allocations counted
+
+} // unnamed namespace
+
+/**
+ * Replacement of the global allocation function, used to count the allocations
+ * performed while the AllocationCounter is started
+ * \param size the number of bytes to allocate
+ * \return a pointer to the allocated memory
+ */
+void*
+operator new (std::size_t size)
+{
+  if (g_counting)
+    {
+      g_allocations++;
+      g_bytes += size;
+    }
+  void *p = std::malloc (size ? size : 1);
+  if (!p)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Replacement of the global deallocation function
+ * \param p the memory to free
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * Replacement of the global sized deallocation function
+ * \param p the memory to free
+ */
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+namespace ns3 {
+
+void
+AllocationCounter::Start (void)
+{
+  g_allocations = 0;
+  g_bytes = 0;
+  g_counting = true;
+}
+
+void
+AllocationCounter::Stop (void)
+{
+  g_counting = false;
+}
+
+uint64_t
+AllocationCounter::GetAllocations (void)
+{
+  return g_allocations;
+}
+
+uint64_t
+AllocationCounter::GetBytes (void)
+{
+  return g_bytes;
+}
+
+} // namespace ns3
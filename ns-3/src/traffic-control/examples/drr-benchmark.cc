@@ -0,0 +1,555 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the per-packet cost of the DRR queue disc when it is
+// driven directly (no TCP/IP stack) with synthetic IPv4 items. To measure the
+// cost of an enqueue, the queue disc is first filled up to its byte limit with
+// packets belonging to all the flows, then every enqueue triggers the packet
+// stealing mechanism (DRRDrop). To measure the cost of a dequeue, all the flows
+// are backlogged and then the queue disc is emptied, both by visiting the active
+// flows one at a time and by skipping rounds. Then, the cost of enqueuing and
+// dequeuing packets is measured for different types of flow queue discs.
+// Then, the cost of classifying UDP packets with the DRR packet filter is
+// compared to that of extracting the 5-tuple by deserializing the headers.
+// Then, for a flow table with as many flow queues as flows, the fraction of
+// flows that collide, the number of flow queues created, the memory allocated
+// and the cost of an enqueue are measured for an increasing number of ways.
+// Finally, the heap allocations of enqueuing and dequeuing packets in steady
+// state (i.e., once all the flow queues have been created) are compared to
+// those of the same operations on stand-alone flow queue discs: the program
+// aborts if the DRR scheduler itself allocates memory.
+// Sample usage:  ./waf --run 'drr-benchmark --minFlows=16 --maxFlows=65536'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include "allocation-counter.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DRRBenchmark");
+
+/**
+ * Create an IPv4 item belonging to the given flow
+ * \param flow the flow identifier
+ * \param size the size of the payload
+ * \return the item
+ */
+static Ptr<QueueDiscItem>
+CreateItem (uint32_t flow, uint32_t size)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (size);
+  hdr.SetSource (Ipv4Address (0x0a000000 + flow));
+  hdr.SetDestination (Ipv4Address ("10.255.255.254"));
+  hdr.SetProtocol (7);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (size), dest, 0, hdr);
+}
+
+/**
+ * Create an IPv4 item carrying a UDP datagram belonging to the given flow
+ * \param flow the flow identifier
+ * \param size the size of the UDP payload
+ * \return the item
+ */
+static Ptr<QueueDiscItem>
+CreateUdpItem (uint32_t flow, uint32_t size)
+{
+  UdpHeader udpHdr;
+  udpHdr.SetSourcePort (1024 + (flow & 0xffff));
+  udpHdr.SetDestinationPort (9);
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddHeader (udpHdr);
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (p->GetSize ());
+  hdr.SetSource (Ipv4Address (0x0a000000 + (flow >> 16)));
+  hdr.SetDestination (Ipv4Address ("10.255.255.254"));
+  hdr.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+}
+
+/**
+ * Classify an IPv4 item by copying its header and deserializing its transport
+ * header to get the ports, as the DRR packet filter used to do
+ * \param item the item
+ * \return the hash of the 5-tuple
+ */
+static uint32_t
+ClassifyWithHeaderObjects (Ptr<QueueDiscItem> item)
+{
+  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
+  Ipv4Header hdr = ipv4Item->GetHeader ();
+  Ipv4Address src = hdr.GetSource ();
+  Ipv4Address dest = hdr.GetDestination ();
+  uint8_t prot = hdr.GetProtocol ();
+
+  TcpHeader tcpHdr;
+  UdpHeader udpHdr;
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+  Ptr<Packet> pkt = ipv4Item->GetPacket ();
+  if (prot == 6 && hdr.GetFragmentOffset () == 0)
+    {
+      pkt->PeekHeader (tcpHdr);
+      srcPort = tcpHdr.GetSourcePort ();
+      destPort = tcpHdr.GetDestinationPort ();
+    }
+  else if (prot == 17 && hdr.GetFragmentOffset () == 0)
+    {
+      pkt->PeekHeader (udpHdr);
+      srcPort = udpHdr.GetSourcePort ();
+      destPort = udpHdr.GetDestinationPort ();
+    }
+
+  uint8_t buf[13];
+  src.Serialize (buf);
+  dest.Serialize (buf + 4);
+  buf[8] = prot;
+  buf[9] = (srcPort >> 8) & 0xff;
+  buf[10] = srcPort & 0xff;
+  buf[11] = (destPort >> 8) & 0xff;
+  buf[12] = destPort & 0xff;
+  return Hash32 ((char*) buf, 13);
+}
+
+/**
+ * Measure the cost of classifying UDP packets
+ * \param flows the number of flows
+ * \param packets the number of timed classifications
+ * \param size the size of the UDP payload
+ * \param headerCost the average cost (in nanoseconds) of extracting the 5-tuple
+ *        by deserializing the headers and hashing it
+ * \param filterCost the average cost (in nanoseconds) of the first classification
+ *        of a packet by the DRR packet filter
+ * \param cachedCost the average cost (in nanoseconds) of a further classification
+ *        of the same packet by the DRR packet filter
+ */
+static void
+RunClassifyBench (uint32_t flows, uint32_t packets, uint32_t size,
+                  double &headerCost, double &filterCost, double &cachedCost)
+{
+  Ptr<DRRIpv4PacketFilter> filter = CreateObject<DRRIpv4PacketFilter> ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (packets);
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      items.push_back (CreateUdpItem (i % flows, size));
+    }
+
+  // accumulate the results, so that the classifications are not optimized out
+  uint32_t sum = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      sum += ClassifyWithHeaderObjects (items[i]);
+    }
+  headerCost = clock.End () * 1e6 / packets;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      sum += filter->Classify (items[i]);
+    }
+  filterCost = clock.End () * 1e6 / packets;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      sum += filter->Classify (items[i]);
+    }
+  cachedCost = clock.End () * 1e6 / packets;
+
+  NS_LOG_DEBUG ("Sum of the hashes: " << sum);
+}
+
+/**
+ * Enqueue a packet of every flow into a DRR queue disc having as many flow
+ * queues as flows, and measure how the flows are spread over the flow queues
+ * \param flows the number of flows (and of flow queues)
+ * \param ways the number of ways of each set of the flow table
+ * \param size the size of the packets
+ * \param collisionRate the fraction of the packets that collided
+ * \param flowQueues the number of flow queues created
+ * \param kib the memory allocated (in KiB) by the queue disc, including the
+ *        storage of the packets in the flow queues
+ * \param enqueueCost the average cost (in nanoseconds) of an enqueue operation
+ */
+static void
+RunFlowTableBench (uint32_t flows, uint32_t ways, uint32_t size,
+                   double &collisionRate, uint32_t &flowQueues, double &kib, double &enqueueCost)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                         "Ways", UintegerValue (ways),
+                                                                         "ByteLimit", UintegerValue (flows * (size + 20)));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->Initialize ();
+
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (flows);
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      items.push_back (CreateItem (i, size));
+    }
+
+  AllocationCounter::Start ();
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      queueDisc->Enqueue (items[i]);
+    }
+  enqueueCost = clock.End () * 1e6 / flows;
+  AllocationCounter::Stop ();
+
+  collisionRate = queueDisc->GetStats ().nTotalCollidedPackets / (double) flows;
+  flowQueues = queueDisc->GetNQueueDiscClasses ();
+  kib = AllocationCounter::GetBytes () / 1024.0;
+
+  items.clear ();
+  queueDisc->Dispose ();
+}
+
+/**
+ * Measure the cost of enqueuing packets into a full DRR queue disc
+ * \param flows the number of flows (and of flow queues)
+ * \param packets the number of timed enqueue operations
+ * \param size the size of the packets
+ * \param dropBatchSize the maximum number of packets dropped from the fat flow
+ * \return the average cost (in nanoseconds) of an enqueue operation
+ */
+static double
+RunDropBench (uint32_t flows, uint32_t packets, uint32_t size, uint32_t dropBatchSize)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                         "ByteLimit", UintegerValue (2 * flows * (size + 20)),
+                                                                         "DropBatchSize", UintegerValue (dropBatchSize));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->Initialize ();
+
+  // fill the queue disc up to its limit, so that every flow queue is created
+  for (uint32_t i = 0; i < 2 * flows; i++)
+    {
+      queueDisc->Enqueue (CreateItem (i % flows, size));
+    }
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (packets);
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      items.push_back (CreateItem (rng->GetInteger (0, flows - 1), size));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      queueDisc->Enqueue (items[i]);
+    }
+  int64_t elapsed = clock.End ();
+
+  items.clear ();
+  queueDisc->Dispose ();
+
+  return elapsed * 1e6 / packets;
+}
+
+/**
+ * Measure the cost of dequeuing packets from a DRR queue disc whose flows are all backlogged
+ * \param flows the number of flows (and of flow queues)
+ * \param packets the number of timed dequeue operations
+ * \param size the size of the packets
+ * \param quantum the quantum of the DRR queue disc
+ * \param skipRounds whether the DRR queue disc skips rounds
+ * \return the average cost (in nanoseconds) of a dequeue operation
+ */
+static double
+RunDequeueBench (uint32_t flows, uint32_t packets, uint32_t size, uint32_t quantum, bool skipRounds)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                         "ByteLimit", UintegerValue (packets * (size + 20)),
+                                                                         "SkipRounds", BooleanValue (skipRounds));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (quantum);
+  queueDisc->Initialize ();
+
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      queueDisc->Enqueue (CreateItem (i % flows, size));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      queueDisc->Dequeue ();
+    }
+  int64_t elapsed = clock.End ();
+
+  queueDisc->Dispose ();
+
+  return elapsed * 1e6 / packets;
+}
+
+/**
+ * Count the heap allocations of enqueuing and dequeuing packets through a DRR
+ * queue disc in steady state and through stand-alone flow queue discs
+ * \param flows the number of flows
+ * \param packets the number of packets enqueued and dequeued
+ * \param size the size of the packets
+ * \param drrAllocations the number of allocations through the DRR queue disc
+ * \param childAllocations the number of allocations through the stand-alone flow queue discs
+ */
+static void
+RunSteadyStateBench (uint32_t flows, uint32_t packets, uint32_t size,
+                     uint64_t &drrAllocations, uint64_t &childAllocations)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ();
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  // create all the flow queues
+  for (uint32_t f = 0; f < flows; f++)
+    {
+      queueDisc->Enqueue (CreateItem (f, size));
+    }
+  while (queueDisc->Dequeue ())
+    {
+    }
+  uint32_t nClasses = queueDisc->GetNQueueDiscClasses ();
+
+  // enqueue two packets per flow and dequeue them, for a number of rounds
+  uint32_t rounds = std::max (packets / (2 * flows), 1U);
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (uint32_t i = 0; i < 2 * rounds * flows; i++)
+    {
+      items.push_back (CreateItem (i % flows, size));
+    }
+  AllocationCounter::Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < 2 * flows; i++)
+        {
+          queueDisc->Enqueue (items[2 * r * flows + i]);
+        }
+      for (uint32_t i = 0; i < 2 * flows; i++)
+        {
+          queueDisc->Dequeue ();
+        }
+    }
+  AllocationCounter::Stop ();
+  drrAllocations = AllocationCounter::GetAllocations ();
+  NS_ABORT_MSG_IF (queueDisc->GetNQueueDiscClasses () != nClasses, "A flow queue was created in steady state");
+
+  // perform the same operations directly on stand-alone flow queues
+  std::vector<Ptr<QueueDisc> > childQueueDiscs;
+  for (uint32_t f = 0; f < nClasses; f++)
+    {
+      Ptr<QueueDisc> qd = CreateObject<CoDelQueueDisc> ();
+      qd->Initialize ();
+      childQueueDiscs.push_back (qd);
+    }
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      items[i] = CreateItem (i % flows, size);
+    }
+  AllocationCounter::Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < 2 * flows; i++)
+        {
+          childQueueDiscs[i % nClasses]->Enqueue (items[2 * r * flows + i]);
+        }
+      for (uint32_t i = 0; i < 2 * flows; i++)
+        {
+          childQueueDiscs[i % nClasses]->Dequeue ();
+        }
+    }
+  AllocationCounter::Stop ();
+  childAllocations = AllocationCounter::GetAllocations ();
+
+  items.clear ();
+  queueDisc->Dispose ();
+  for (uint32_t f = 0; f < nClasses; f++)
+    {
+      childQueueDiscs[f]->Dispose ();
+    }
+}
+
+/**
+ * Measure the cost of enqueuing and dequeuing packets with a given type of flow queue disc
+ * \param flowQueueDisc the type of the flow queue discs
+ * \param flows the number of flows (and of flow queues)
+ * \param packets the number of timed enqueue and dequeue operations
+ * \param size the size of the packets
+ * \param enqueueCost the average cost (in nanoseconds) of an enqueue operation
+ * \param dequeueCost the average cost (in nanoseconds) of a dequeue operation
+ */
+static void
+RunFlowQueueDiscBench (std::string flowQueueDisc, uint32_t flows, uint32_t packets, uint32_t size,
+                       double &enqueueCost, double &dequeueCost)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (flowQueueDisc);
+  factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, packets)));
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                         "ByteLimit", UintegerValue (packets * (size + 20)),
+                                                                         "FlowQueueDisc", ObjectFactoryValue (factory));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->Initialize ();
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (packets);
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      items.push_back (CreateItem (rng->GetInteger (0, flows - 1), size));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      queueDisc->Enqueue (items[i]);
+    }
+  enqueueCost = clock.End () * 1e6 / packets;
+  items.clear ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      queueDisc->Dequeue ();
+    }
+  dequeueCost = clock.End () * 1e6 / packets;
+
+  queueDisc->Dispose ();
+}
+
+/**
+ * Parameters of the benchmarks
+ */
+struct BenchmarkConfig
+{
+  uint32_t minFlows;        //!< the smallest number of flows
+  uint32_t maxFlows;        //!< the largest number of flows
+  uint32_t packets;         //!< the number of timed operations
+  uint32_t size;            //!< the size of the packets
+  uint32_t dropBatchSize;   //!< the maximum number of packets dropped from the fat flow
+  uint32_t quantum;         //!< the quantum used to measure the dequeue cost
+  uint32_t childFlows;      //!< the number of flows used to compare the types of flow queue discs
+  uint32_t minTableFlows;   //!< the smallest number of flows used to measure the collisions
+  uint32_t maxTableFlows;   //!< the largest number of flows used to measure the collisions
+  uint32_t maxWays;         //!< the largest number of ways of the flow table
+};
+
+/**
+ * Run the benchmarks for an increasing number of flows and print the results as CSV
+ * \param c the parameters of the benchmarks
+ */
+static void
+RunBenchmarks (BenchmarkConfig c)
+{
+  std::cout << "flows,packets,ns_per_enqueue,ns_per_dequeue,ns_per_dequeue_skip_rounds" << std::endl;
+  for (uint32_t flows = c.minFlows; flows <= c.maxFlows; flows *= 4)
+    {
+      double cost = RunDropBench (flows, c.packets, c.size, c.dropBatchSize);
+      double dequeueCost = RunDequeueBench (flows, c.packets, c.size, c.quantum, false);
+      double skipCost = RunDequeueBench (flows, c.packets, c.size, c.quantum, true);
+      std::cout << flows << "," << c.packets << "," << cost << "," << dequeueCost << "," << skipCost << std::endl;
+    }
+
+  std::cout << std::endl << "flow_queue_disc,flows,packets,ns_per_enqueue,ns_per_dequeue" << std::endl;
+  const char *types[] = { "ns3::FifoQueueDisc", "ns3::CoDelQueueDisc", "ns3::PieQueueDisc" };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      double enqueueCost, dequeueCost;
+      RunFlowQueueDiscBench (types[i], c.childFlows, c.packets, c.size, enqueueCost, dequeueCost);
+      std::cout << types[i] << "," << c.childFlows << "," << c.packets << "," << enqueueCost << "," << dequeueCost << std::endl;
+    }
+
+  std::cout << std::endl << "flows,packets,ns_per_classify_header_objects,ns_per_classify,ns_per_classify_cached" << std::endl;
+  double headerCost, filterCost, cachedCost;
+  RunClassifyBench (c.childFlows, c.packets, c.size, headerCost, filterCost, cachedCost);
+  std::cout << c.childFlows << "," << c.packets << "," << headerCost << "," << filterCost << "," << cachedCost << std::endl;
+
+  std::cout << std::endl << "flows,ways,collision_rate,flow_queues,kib_allocated,ns_per_enqueue" << std::endl;
+  for (uint32_t flows = c.minTableFlows; flows <= c.maxTableFlows; flows *= 10)
+    {
+      for (uint32_t ways = 1; ways <= c.maxWays; ways *= 2)
+        {
+          double collisionRate, kib, enqueueCost;
+          uint32_t flowQueues;
+          RunFlowTableBench (flows, ways, c.size, collisionRate, flowQueues, kib, enqueueCost);
+          std::cout << flows << "," << ways << "," << collisionRate << "," << flowQueues << ","
+                    << kib << "," << enqueueCost << std::endl;
+        }
+    }
+
+  std::cout << std::endl << "flows,packets,drr_allocations,flow_queue_disc_allocations" << std::endl;
+  uint64_t drrAllocations, childAllocations;
+  RunSteadyStateBench (c.childFlows, c.packets, c.size, drrAllocations, childAllocations);
+  std::cout << c.childFlows << "," << c.packets << "," << drrAllocations << "," << childAllocations << std::endl;
+  NS_ABORT_MSG_IF (drrAllocations != childAllocations, "The DRR scheduler allocated memory in steady state");
+
+  // flow queue discs such as PIE schedule periodic events
+  Simulator::Stop ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig c;
+  c.minFlows = 16;
+  c.maxFlows = 65536;
+  c.packets = 200000;
+  c.size = 1000;
+  c.dropBatchSize = 1;
+  c.quantum = 600;
+  c.childFlows = 1024;
+  c.minTableFlows = 1000;
+  c.maxTableFlows = 100000;
+  c.maxWays = 8;
+
+  CommandLine cmd;
+  cmd.AddValue ("minFlows", "Smallest number of flows", c.minFlows);
+  cmd.AddValue ("maxFlows", "Largest number of flows", c.maxFlows);
+  cmd.AddValue ("packets", "Number of timed operations", c.packets);
+  cmd.AddValue ("size", "Payload size of the packets", c.size);
+  cmd.AddValue ("dropBatchSize", "Max number of packets dropped from the fat flow", c.dropBatchSize);
+  cmd.AddValue ("quantum", "Quantum used to measure the dequeue cost", c.quantum);
+  cmd.AddValue ("childFlows", "Number of flows used to compare the types of flow queue discs", c.childFlows);
+  cmd.AddValue ("minTableFlows", "Smallest number of flows used to measure the collisions", c.minTableFlows);
+  cmd.AddValue ("maxTableFlows", "Largest number of flows used to measure the collisions", c.maxTableFlows);
+  cmd.AddValue ("maxWays", "Largest number of ways of the flow table (a power of two)", c.maxWays);
+  cmd.Parse (argc, argv);
+
+  // Time objects created before the simulation starts are recorded (to allow
+  // changing the time resolution), hence the benchmarks are run as an event
+  Simulator::Schedule (Seconds (0), &RunBenchmarks, c);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
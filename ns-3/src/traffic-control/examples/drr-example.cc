@@ -29,7 +29,22 @@
  *                 n2------------------n3
  *    10Mb/s, 3ms  |  QueueLimit = 100  |    10Mb/s, 5ms
  * n1--------------|                    |---------------n5
+ *                 |
+ *    10Mb/s, 3ms  |   (--voip=1 only)
+ * n6--------------|
  *
+ * Two TCP flows go from n0 and n1 to n4. With --voip=1, a constant bit rate
+ * UDP flow (a 64 kb/s voice call, whose packets carry the EF DSCP) also goes
+ * from n6 to n5, and the one-way delays of its packets are reported. The voice
+ * call has an access link of its own, so that it only shares the n2-n3 link
+ * with the TCP flows, and the device queue of that link holds a single packet,
+ * so that the packets wait in the DRR queue disc, which decides the order in
+ * which they are sent. With --latencyCritical=1, the flows carrying the EF DSCP
+ * are latency-critical (DRR+), i.e., they are served before the bulk flows as
+ * long as they hold at most one quantum, which cuts the tail latency of the
+ * voice call. Compare:
+ *   ./waf --run 'drr-example --voip=1'
+ *   ./waf --run 'drr-example --voip=1 --latencyCritical=1'
  */
 
 #include "ns3/core-module.h"
@@ -39,6 +54,8 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/traffic-control-module.h"
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -60,16 +77,20 @@ NodeContainer n1n2;
 NodeContainer n2n3;
 NodeContainer n3n4;
 NodeContainer n3n5;
+NodeContainer n6n2;
 
 Ipv4InterfaceContainer i0i2;
 Ipv4InterfaceContainer i1i2;
 Ipv4InterfaceContainer i2i3;
 Ipv4InterfaceContainer i3i4;
 Ipv4InterfaceContainer i3i5;
+Ipv4InterfaceContainer i6i2;
 
 std::stringstream filePlotQueueDisc;
 std::stringstream filePlotQueueDiscAvg;
 
+std::vector<double> voipDelays;
+
 void
 CheckQueueDiscSize (Ptr<QueueDisc> queue)
 {
@@ -90,6 +111,36 @@ CheckQueueDiscSize (Ptr<QueueDisc> queue)
   fPlotQueueDiscAvg.close ();
 }
 
+void
+VoipPacketReceived (Ptr<const Packet> packet)
+{
+  SeqTsHeader seqTs;
+  packet->Copy ()->RemoveHeader (seqTs);
+  voipDelays.push_back ((Simulator::Now () - seqTs.GetTs ()).GetSeconds () * 1000);
+}
+
+void
+BuildVoipApp ()
+{
+  uint16_t port = 50001;
+  UdpServerHelper server (port);
+  ApplicationContainer serverApp = server.Install (n3n5.Get (1));
+  serverApp.Start (Seconds (sink_start_time));
+  serverApp.Stop (Seconds (sink_stop_time));
+  serverApp.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&VoipPacketReceived));
+
+  // 160 bytes of payload every 20 ms, carrying the EF DSCP
+  InetSocketAddress remote (i3i5.GetAddress (1), port);
+  remote.SetTos (Ipv4Header::DSCP_EF << 2);
+  UdpClientHelper client (remote);
+  client.SetAttribute ("MaxPackets", UintegerValue (1000000));
+  client.SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  client.SetAttribute ("PacketSize", UintegerValue (160));
+  ApplicationContainer clientApp = client.Install (n6n2.Get (0));
+  clientApp.Start (Seconds (client_start_time));
+  clientApp.Stop (Seconds (client_stop_time));
+}
+
 void
 BuildAppsTest ()
 {
@@ -146,6 +197,9 @@ main (int argc, char *argv[])
   bool writeForPlot = false;
   bool writePcap = false;
   bool flowMonitor = false;
+  bool voip = false;
+  bool latencyCritical = false;
+  bool writeFlowStats = false;
 
   bool printDRRStats = true;
 
@@ -164,12 +218,15 @@ main (int argc, char *argv[])
   cmd.AddValue ("writeForPlot", "<0/1> to write results for plot (gnuplot)", writeForPlot);
   cmd.AddValue ("writePcap", "<0/1> to write results in pcapfile", writePcap);
   cmd.AddValue ("writeFlowMonitor", "<0/1> to enable Flow Monitor and write their results", flowMonitor);
+  cmd.AddValue ("voip", "<0/1> to add a voice call and report the delays of its packets", voip);
+  cmd.AddValue ("latencyCritical", "<0/1> to make the flows carrying the EF DSCP latency-critical", latencyCritical);
+  cmd.AddValue ("writeFlowStats", "<0/1> to write the statistics of the DRR flows every 100 ms", writeFlowStats);
 
   cmd.Parse (argc, argv);
 
   NS_LOG_INFO ("Create nodes");
   NodeContainer c;
-  c.Create (6);
+  c.Create (voip ? 7 : 6);
   Names::Add ( "N0", c.Get (0));
   Names::Add ( "N1", c.Get (1));
   Names::Add ( "N2", c.Get (2));
@@ -181,6 +238,11 @@ main (int argc, char *argv[])
   n2n3 = NodeContainer (c.Get (2), c.Get (3));
   n3n4 = NodeContainer (c.Get (3), c.Get (4));
   n3n5 = NodeContainer (c.Get (3), c.Get (5));
+  if (voip)
+    {
+      Names::Add ( "N6", c.Get (6));
+      n6n2 = NodeContainer (c.Get (6), c.Get (2));
+    }
 
   Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::TcpNewReno"));
   // 42 = headers size
@@ -201,7 +263,7 @@ main (int argc, char *argv[])
 
   TrafficControlHelper tchPfifo;
   uint16_t handle = tchPfifo.SetRootQueueDisc ("ns3::PfifoFastQueueDisc");
-  tchPfifo.AddInternalQueues (handle, 3, "ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+  tchPfifo.AddInternalQueues (handle, 3, "ns3::DropTailQueue", "MaxSize", StringValue ("1000p"));
 
   TrafficControlHelper tchDRR;
   tchDRR.SetRootQueueDisc ("ns3::DRRQueueDisc");
@@ -230,12 +292,32 @@ main (int argc, char *argv[])
   devn1n2 = p2p.Install (n1n2);
   tchPfifo.Install (devn1n2);
 
-  p2p.SetQueue ("ns3::DropTailQueue");
+  NetDeviceContainer devn6n2;
+  if (voip)
+    {
+      p2p.SetQueue ("ns3::DropTailQueue");
+      p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+      p2p.SetChannelAttribute ("Delay", StringValue ("3ms"));
+      devn6n2 = p2p.Install (n6n2);
+      tchPfifo.Install (devn6n2);
+
+      // a short device queue, so that the packets wait in the queue disc and
+      // the latter decides the order in which they are sent
+      p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+    }
+  else
+    {
+      p2p.SetQueue ("ns3::DropTailQueue");
+    }
   p2p.SetDeviceAttribute ("DataRate", StringValue (DRRLinkDataRate));
   p2p.SetChannelAttribute ("Delay", StringValue (DRRLinkDelay));
   devn2n3 = p2p.Install (n2n3);
   // only backbone link has DRR queue disc
   queueDiscs = tchDRR.Install (devn2n3);
+  if (latencyCritical)
+    {
+      StaticCast<DRRQueueDisc> (queueDiscs.Get (0))->SetDscpLatencyCritical (Ipv4Header::DSCP_EF, true);
+    }
 
   p2p.SetQueue ("ns3::DropTailQueue");
   p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
@@ -267,10 +349,20 @@ main (int argc, char *argv[])
   ipv4.SetBase ("10.1.5.0", "255.255.255.0");
   i3i5 = ipv4.Assign (devn3n5);
 
+  if (voip)
+    {
+      ipv4.SetBase ("10.1.6.0", "255.255.255.0");
+      i6i2 = ipv4.Assign (devn6n2);
+    }
+
   // Set up the routing
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
   BuildAppsTest ();
+  if (voip)
+    {
+      BuildVoipApp ();
+    }
 
   if (writePcap)
     {
@@ -298,6 +390,17 @@ main (int argc, char *argv[])
       Simulator::ScheduleNow (&CheckQueueDiscSize, queue);
     }
 
+  Ptr<DRRFlowStatsSampler> sampler;
+  if (writeFlowStats)
+    {
+      std::stringstream fileFlowStats;
+      fileFlowStats << pathOut << "/" << "drr-flow-stats.csv";
+      AsciiTraceHelper ascii;
+      sampler = CreateObject<DRRFlowStatsSampler> ();
+      sampler->Start (StaticCast<DRRQueueDisc> (queueDiscs.Get (0)),
+                      ascii.CreateFileStream (fileFlowStats.str ()));
+    }
+
   Simulator::Stop (Seconds (sink_stop_time));
   Simulator::Run ();
 
@@ -316,6 +419,26 @@ main (int argc, char *argv[])
       std::cout << "*** DRR stats from Node 2 queue ***" << std::endl;
       std::cout << "\t " << st.GetNDroppedPackets (DRRQueueDisc::UNCLASSIFIED_DROP)
                 << " drops because packet could not be classified by any filter" << std::endl;
+      std::cout << "\t " << StaticCast<DRRQueueDisc> (queueDiscs.Get (0))->GetNDemotedFlows ()
+                << " latency-critical flows demoted" << std::endl;
+      std::cout << "\t " << StaticCast<DRRQueueDisc> (queueDiscs.Get (0))->GetJainFairnessIndex ()
+                << " Jain's fairness index of the bytes served to the flows" << std::endl;
+    }
+
+  if (voip && !voipDelays.empty ())
+    {
+      std::sort (voipDelays.begin (), voipDelays.end ());
+      double sum = 0;
+      for (double d : voipDelays)
+        {
+          sum += d;
+        }
+      std::cout << "*** One-way delay of the voice packets (ms) ***" << std::endl;
+      std::cout << "\t received: " << voipDelays.size () << std::endl;
+      std::cout << "\t mean: " << sum / voipDelays.size () << std::endl;
+      std::cout << "\t 50th percentile: " << voipDelays[voipDelays.size () / 2] << std::endl;
+      std::cout << "\t 99th percentile: " << voipDelays[voipDelays.size () * 99 / 100] << std::endl;
+      std::cout << "\t max: " << voipDelays.back () << std::endl;
     }
 
   Simulator::Destroy ();
@@ -0,0 +1,427 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures how the per-packet cost of the DRR queue disc scales
+// with the number of flows, the packet sizes, the quantum and the overload, and
+// compares it to that of the FqCoDel and Prio queue discs. The queue discs are
+// driven directly (no TCP/IP stack) with synthetic IPv4 items, created before
+// the measurements start. For every combination of the parameters, a queue disc
+// is:
+//
+// 1) filled with the given number of packets (ns_per_enqueue)
+// 2) overloaded, by enqueuing the given number of packets (on average) for
+//    each dequeued packet (ns_per_overload_op is the average cost of an enqueue
+//    or dequeue operation and drop_rate the fraction of the packets enqueued
+//    in this phase that are dropped)
+// 3) offered packets without dequeuing any (ns_per_drop is the time spent
+//    divided by the number of dropped packets, or nan if none is dropped,
+//    e.g., because the queue disc is not full)
+// 4) emptied (ns_per_dequeue)
+//
+// The results are printed as CSV, together with the peak resident set size of
+// the process so far and the average number of heap allocations per operation
+// in the timed phases.
+// Sample usage:  ./waf --run 'drr-scalability-benchmark --maxFlows=65536 --quanta=300,1500'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include "allocation-counter.h"
+#include <sys/resource.h>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DRRScalabilityBenchmark");
+
+/**
+ * Split a comma separated list
+ * \param list the list
+ * \return the elements of the list
+ */
+static std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> elements;
+  std::istringstream iss (list);
+  std::string element;
+  while (std::getline (iss, element, ','))
+    {
+      if (!element.empty ())
+        {
+          elements.push_back (element);
+        }
+    }
+  return elements;
+}
+
+/**
+ * Get the peak resident set size of the process
+ * \return the peak resident set size, in KiB
+ */
+static long
+GetPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+/**
+ * Generator of the packets offered to the queue discs
+ */
+class ItemGenerator
+{
+public:
+  /**
+   * Constructor
+   * \param flows the number of flows
+   * \param sizeMix the distribution of the packet sizes: "fixed" (all the
+   *        packets have the given size), "imix" (40, 576 and 1500 bytes in the
+   *        ratio 7:4:1) or "uniform" (between 64 and 1500 bytes)
+   * \param size the size of the packets with the fixed distribution
+   */
+  ItemGenerator (uint32_t flows, std::string sizeMix, uint32_t size);
+
+  /**
+   * Create an IPv4 item belonging to a random flow. The priority of the packet
+   * is the flow identifier modulo 16, so that all the bands of a Prio queue
+   * disc are used
+   * \return the item
+   */
+  Ptr<QueueDiscItem> Create (void);
+
+  /**
+   * Create the given number of items
+   * \param n the number of items
+   * \return the items
+   */
+  std::vector<Ptr<QueueDiscItem> > Create (uint32_t n);
+
+private:
+  uint32_t m_flows;                    //!< the number of flows
+  std::string m_sizeMix;               //!< the distribution of the packet sizes
+  uint32_t m_size;                     //!< the size of the packets with the fixed distribution
+  Ptr<UniformRandomVariable> m_rng;    //!< the random variable
+};
+
+ItemGenerator::ItemGenerator (uint32_t flows, std::string sizeMix, uint32_t size)
+  : m_flows (flows),
+    m_sizeMix (sizeMix),
+    m_size (size)
+{
+  NS_ABORT_MSG_IF (sizeMix != "fixed" && sizeMix != "imix" && sizeMix != "uniform",
+                   "Unknown packet size distribution " << sizeMix);
+  m_rng = CreateObject<UniformRandomVariable> ();
+}
+
+Ptr<QueueDiscItem>
+ItemGenerator::Create (void)
+{
+  uint32_t flow = m_rng->GetInteger (0, m_flows - 1);
+  uint32_t size = m_size;
+  if (m_sizeMix == "imix")
+    {
+      uint32_t u = m_rng->GetInteger (0, 11);
+      size = (u < 7 ? 40 : (u < 11 ? 576 : 1500));
+    }
+  else if (m_sizeMix == "uniform")
+    {
+      size = m_rng->GetInteger (64, 1500);
+    }
+
+  Ptr<Packet> p = ns3::Create<Packet> (size);
+  SocketPriorityTag priorityTag;
+  priorityTag.SetPriority (flow & 0x0f);
+  p->AddPacketTag (priorityTag);
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (size);
+  hdr.SetSource (Ipv4Address (0x0a000000 + flow));
+  hdr.SetDestination (Ipv4Address ("10.255.255.254"));
+  hdr.SetProtocol (7);
+  Address dest;
+  return ns3::Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+}
+
+std::vector<Ptr<QueueDiscItem> >
+ItemGenerator::Create (uint32_t n)
+{
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      items.push_back (Create ());
+    }
+  return items;
+}
+
+/**
+ * Create a queue disc able to store the given packets
+ * \param type the type of queue disc: "DRR", "DRRSkipRounds", "FqCoDel" or "Prio"
+ * \param flows the number of flow queues (ignored by Prio)
+ * \param quantum the quantum (ignored by Prio)
+ * \param items the packets the queue disc must be able to store
+ * \return the queue disc
+ */
+static Ptr<QueueDisc>
+CreateQueueDisc (std::string type, uint32_t flows, uint32_t quantum,
+                 const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  uint32_t bytes = 0;
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      bytes += items[i]->GetSize ();
+    }
+
+  Ptr<QueueDisc> qd;
+  if (type == "DRR" || type == "DRRSkipRounds")
+    {
+      Ptr<DRRQueueDisc> drr = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                       "ByteLimit", UintegerValue (bytes),
+                                                                       "SkipRounds", BooleanValue (type == "DRRSkipRounds"));
+      drr->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+      drr->SetQuantum (quantum);
+      qd = drr;
+    }
+  else if (type == "FqCoDel")
+    {
+      Ptr<FqCoDelQueueDisc> fqCoDel = CreateObjectWithAttributes<FqCoDelQueueDisc> ("Flows", UintegerValue (flows),
+                                                                                    "MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, items.size ())));
+      fqCoDel->SetQuantum (quantum);
+      qd = fqCoDel;
+    }
+  else if (type == "Prio")
+    {
+      qd = CreateObject<PrioQueueDisc> ();
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::FifoQueueDisc");
+      factory.Set ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, items.size ())));
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          Ptr<QueueDisc> child = factory.Create<QueueDisc> ();
+          child->Initialize ();
+          Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+          c->SetQueueDisc (child);
+          qd->AddQueueDiscClass (c);
+        }
+    }
+  else
+    {
+      NS_ABORT_MSG ("Unknown queue disc type " << type);
+    }
+
+  qd->Initialize ();
+  return qd;
+}
+
+/**
+ * Parameters of a run
+ */
+struct RunConfig
+{
+  std::string type;     //!< the type of queue disc
+  uint32_t flows;       //!< the number of flows (and of flow queues)
+  std::string sizeMix;  //!< the distribution of the packet sizes
+  uint32_t size;        //!< the size of the packets with the fixed distribution
+  uint32_t quantum;     //!< the quantum
+  double overload;      //!< the number of packets enqueued for each dequeued packet when overloaded
+  uint32_t packets;     //!< the number of packets the queue disc is filled with
+};
+
+/**
+ * Run the four phases on a queue disc and print the results as a CSV line
+ * \param c the parameters of the run
+ */
+static void
+RunScalabilityBench (RunConfig c)
+{
+  ItemGenerator generator (c.flows, c.sizeMix, c.size);
+  std::vector<Ptr<QueueDiscItem> > fillItems = generator.Create (c.packets);
+  uint32_t nOverloadItems = static_cast<uint32_t> (c.packets * c.overload);
+  std::vector<Ptr<QueueDiscItem> > overloadItems = generator.Create (nOverloadItems);
+  std::vector<Ptr<QueueDiscItem> > dropItems = generator.Create (c.packets / 2);
+
+  Ptr<QueueDisc> qd = CreateQueueDisc (c.type, c.flows, c.quantum, fillItems);
+  SystemWallClockMs clock;
+  uint64_t nOps = 0;
+  AllocationCounter::Start ();
+
+  // 1) fill
+  clock.Start ();
+  for (uint32_t i = 0; i < fillItems.size (); i++)
+    {
+      qd->Enqueue (fillItems[i]);
+    }
+  double enqueueCost = clock.End () * 1e6 / fillItems.size ();
+  nOps += fillItems.size ();
+
+  // 2) overload
+  uint32_t dropped = qd->GetStats ().nTotalDroppedPackets;
+  uint32_t next = 0;
+  double credit = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < c.packets; i++)
+    {
+      for (credit += c.overload; credit >= 1 && next < overloadItems.size (); credit--)
+        {
+          qd->Enqueue (overloadItems[next++]);
+        }
+      qd->Dequeue ();
+    }
+  double overloadCost = clock.End () * 1e6 / (next + c.packets);
+  double dropRate = (qd->GetStats ().nTotalDroppedPackets - dropped) / (double) std::max (next, 1u);
+  nOps += next + c.packets;
+
+  // 3) drops
+  dropped = qd->GetStats ().nTotalDroppedPackets;
+  clock.Start ();
+  for (uint32_t i = 0; i < dropItems.size (); i++)
+    {
+      qd->Enqueue (dropItems[i]);
+    }
+  int64_t elapsed = clock.End ();
+  dropped = qd->GetStats ().nTotalDroppedPackets - dropped;
+  double dropCost = (dropped ? elapsed * 1e6 / dropped : std::numeric_limits<double>::quiet_NaN ());
+  nOps += dropItems.size ();
+
+  // 4) drain
+  uint32_t dequeued = 0;
+  clock.Start ();
+  while (qd->Dequeue ())
+    {
+      dequeued++;
+    }
+  double dequeueCost = clock.End () * 1e6 / std::max (dequeued, 1u);
+  nOps += dequeued;
+
+  AllocationCounter::Stop ();
+  double allocsPerOp = AllocationCounter::GetAllocations () / (double) nOps;
+
+  fillItems.clear ();
+  overloadItems.clear ();
+  dropItems.clear ();
+  qd->Dispose ();
+
+  std::cout << c.type << "," << c.flows << "," << c.sizeMix << "," << c.quantum << "," << c.overload << ","
+            << c.packets << "," << enqueueCost << "," << overloadCost << "," << dropRate << ","
+            << dropCost << "," << dequeueCost << "," << GetPeakRss () << "," << allocsPerOp << std::endl;
+}
+
+/**
+ * Parameters of the benchmark
+ */
+struct BenchmarkConfig
+{
+  uint32_t minFlows;        //!< the smallest number of flows
+  uint32_t maxFlows;        //!< the largest number of flows
+  uint32_t packets;         //!< the number of packets the queue discs are filled with
+  uint32_t size;            //!< the size of the packets with the fixed distribution
+  std::string queueDiscs;   //!< the types of queue disc
+  std::string sizeMixes;    //!< the distributions of the packet sizes
+  std::string quanta;       //!< the quantum values
+  std::string overloads;    //!< the overload ratios
+};
+
+/**
+ * Run the benchmark for every combination of the parameters
+ * \param c the parameters of the benchmark
+ */
+static void
+RunBenchmarks (BenchmarkConfig c)
+{
+  std::vector<std::string> types = SplitList (c.queueDiscs);
+  std::vector<std::string> sizeMixes = SplitList (c.sizeMixes);
+  std::vector<std::string> quanta = SplitList (c.quanta);
+  std::vector<std::string> overloads = SplitList (c.overloads);
+
+  std::cout << "queue_disc,flows,size_mix,quantum,overload,packets,ns_per_enqueue,ns_per_overload_op,"
+            << "drop_rate,ns_per_drop,ns_per_dequeue,peak_rss_kib,allocs_per_op" << std::endl;
+
+  for (uint32_t flows = c.minFlows; flows <= c.maxFlows; flows *= 4)
+    {
+      for (uint32_t t = 0; t < types.size (); t++)
+        {
+          for (uint32_t s = 0; s < sizeMixes.size (); s++)
+            {
+              for (uint32_t q = 0; q < quanta.size (); q++)
+                {
+                  // Prio has no quantum
+                  if (types[t] == "Prio" && q > 0)
+                    {
+                      break;
+                    }
+                  for (uint32_t o = 0; o < overloads.size (); o++)
+                    {
+                      RunConfig r;
+                      r.type = types[t];
+                      r.flows = flows;
+                      r.sizeMix = sizeMixes[s];
+                      r.size = c.size;
+                      r.quantum = std::atoi (quanta[q].c_str ());
+                      r.overload = std::atof (overloads[o].c_str ());
+                      r.packets = c.packets;
+                      RunScalabilityBench (r);
+                    }
+                }
+            }
+        }
+    }
+
+  Simulator::Stop ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  BenchmarkConfig c;
+  c.minFlows = 16;
+  c.maxFlows = 4096;
+  c.packets = 100000;
+  c.size = 1000;
+  c.queueDiscs = "DRR,DRRSkipRounds,FqCoDel,Prio";
+  c.sizeMixes = "fixed,imix";
+  c.quanta = "1500";
+  c.overloads = "1.5";
+
+  CommandLine cmd;
+  cmd.AddValue ("minFlows", "Smallest number of flows", c.minFlows);
+  cmd.AddValue ("maxFlows", "Largest number of flows", c.maxFlows);
+  cmd.AddValue ("packets", "Number of packets the queue discs are filled with", c.packets);
+  cmd.AddValue ("size", "Payload size of the packets with the fixed distribution", c.size);
+  cmd.AddValue ("queueDiscs", "Comma separated types of queue disc (DRR, DRRSkipRounds, FqCoDel, Prio)", c.queueDiscs);
+  cmd.AddValue ("sizeMixes", "Comma separated distributions of the packet sizes (fixed, imix, uniform)", c.sizeMixes);
+  cmd.AddValue ("quanta", "Comma separated quantum values", c.quanta);
+  cmd.AddValue ("overloads", "Comma separated numbers of packets enqueued for each dequeued packet", c.overloads);
+  cmd.Parse (argc, argv);
+
+  // Time objects created before the simulation starts are recorded (to allow
+  // changing the time resolution), hence the benchmarks are run as an event
+  Simulator::Schedule (Seconds (0), &RunBenchmarks, c);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return 0;
+}
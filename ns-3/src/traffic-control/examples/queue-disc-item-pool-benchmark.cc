@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program counts the heap allocations performed to forward packets
+// through the traffic control layer, in order to evaluate the pool of queue
+// disc items. First, IPv4 queue disc items are repeatedly created and deleted
+// and the number of allocations per item is measured. Then, a UDP flow is sent
+// across a chain of three nodes connected by point-to-point links, each having
+// a pfifo_fast root queue disc, and the number of allocations and the wall
+// clock time per received packet are measured. Every packet goes through the
+// traffic control layer of the sender and of the router, hence two queue disc
+// items are created per packet.
+// The pool is enabled by default; run the program again with the pool disabled
+// to compare:
+//   ./waf --run 'queue-disc-item-pool-benchmark'
+//   ./waf --run 'queue-disc-item-pool-benchmark --QueueDiscItemPool=false'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include "allocation-counter.h"
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QueueDiscItemPoolBenchmark");
+
+namespace {
+
+ns3::SystemWallClockMs g_clock;   //!< clock measuring the time taken to forward the packets
+
+} // unnamed namespace
+
+/**
+ * Count the allocations performed to create and delete IPv4 queue disc items
+ * \param items the number of items
+ * \param allocationsPerItem the average number of allocations per item
+ */
+static void
+RunItemBench (uint32_t items, double *allocationsPerItem)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  Ipv4Header hdr;
+  Address dest;
+
+  // create the first item out of the measurement, as it creates the pool
+  Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+
+  AllocationCounter::Start ();
+  for (uint32_t i = 0; i < items; i++)
+    {
+      Ptr<QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+    }
+  AllocationCounter::Stop ();
+  *allocationsPerItem = static_cast<double> (AllocationCounter::GetAllocations ()) / items;
+}
+
+/**
+ * Start counting the allocations and measuring the time
+ */
+static void
+StartCounting (void)
+{
+  AllocationCounter::Start ();
+  g_clock.Start ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t items = 1000000;
+  uint32_t packets = 20000;
+  uint32_t size = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("items", "Number of queue disc items created", items);
+  cmd.AddValue ("packets", "Number of packets sent by the UDP client", packets);
+  cmd.AddValue ("size", "Size of the UDP payload", size);
+  cmd.Parse (argc, argv);
+
+  BooleanValue pool;
+  GlobalValue::GetValueByName ("QueueDiscItemPool", pool);
+
+  // Time objects created before the simulation starts are recorded (to allow
+  // changing the time resolution), hence the items are created in an event
+  double allocationsPerItem = 0;
+  Simulator::Schedule (Seconds (0), &RunItemBench, items, &allocationsPerItem);
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer d01 = p2p.Install (nodes.Get (0), nodes.Get (1));
+  NetDeviceContainer d12 = p2p.Install (nodes.Get (1), nodes.Get (2));
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (d01);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer i12 = address.Assign (d12);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  UdpServerHelper server (9);
+  ApplicationContainer serverApp = server.Install (nodes.Get (2));
+
+  UdpClientHelper client (i12.GetAddress (1), 9);
+  client.SetAttribute ("MaxPackets", UintegerValue (packets));
+  client.SetAttribute ("Interval", TimeValue (MicroSeconds (20)));
+  client.SetAttribute ("PacketSize", UintegerValue (size));
+  ApplicationContainer clientApp = client.Install (nodes.Get (0));
+  clientApp.Start (Seconds (1));
+
+  // the ARP exchange takes place before the allocations are counted
+  Simulator::Schedule (Seconds (1.01), &StartCounting);
+  Simulator::Stop (Seconds (1.01) + MicroSeconds (20) * packets + Seconds (1));
+
+  Simulator::Run ();
+  int64_t elapsed = g_clock.End ();
+  AllocationCounter::Stop ();
+
+  uint64_t received = DynamicCast<UdpServer> (serverApp.Get (0))->GetReceived ();
+  Simulator::Destroy ();
+
+  std::cout << "pool,allocations_per_item,packets_received,allocations_per_packet,us_per_packet" << std::endl;
+  std::cout << (pool.Get () ? "true" : "false") << "," << allocationsPerItem << "," << received << ","
+            << (received ? static_cast<double> (AllocationCounter::GetAllocations ()) / received : 0) << ","
+            << (received ? elapsed * 1e3 / received : 0) << std::endl;
+
+  return 0;
+}
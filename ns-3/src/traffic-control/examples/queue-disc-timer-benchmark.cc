@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program counts the simulator events executed to run the timers of the
+// queue discs, in order to evaluate the timer wheel. A number of PIE queue discs
+// (which update their drop probability every Tupdate) and DRR queue discs (which
+// perturb their hash function every PerturbationPeriod) are created on every
+// node, at random instants within the first update interval, and the simulation
+// is run for the given duration. The number of simulator events executed and the
+// wall clock time are reported.
+// The timer wheel is disabled by default. With its default granularity of one
+// time step, only the timers expiring at the very same time share an event; a
+// coarser granularity coalesces more timers. Run the program with and without
+// the timer wheel to compare:
+//   ./waf --run 'queue-disc-timer-benchmark'
+//   ./waf --run 'queue-disc-timer-benchmark --QueueDiscTimerWheel=true'
+//   ./waf --run 'queue-disc-timer-benchmark --QueueDiscTimerWheel=true --granularity=1ms'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("QueueDiscTimerBenchmark");
+
+/**
+ * Create and initialize a queue disc in the current simulation context
+ * \param factory the factory of the queue disc
+ * \param discs the container of the queue discs
+ */
+static void
+CreateQueueDisc (ObjectFactory factory, std::vector<Ptr<QueueDisc> > *discs)
+{
+  Ptr<QueueDisc> qd = factory.Create<QueueDisc> ();
+  if (DynamicCast<DRRQueueDisc> (qd))
+    {
+      qd->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+    }
+  qd->Initialize ();
+  discs->push_back (qd);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 100;
+  uint32_t pieDiscs = 10;
+  uint32_t drrDiscs = 10;
+  Time granularity = TimeStep (1);
+  Time duration = Seconds (10);
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("pieDiscs", "Number of PIE queue discs per node", pieDiscs);
+  cmd.AddValue ("drrDiscs", "Number of DRR queue discs per node", drrDiscs);
+  cmd.AddValue ("granularity", "Duration of a tick of the timer wheel", granularity);
+  cmd.AddValue ("duration", "Duration of the simulation", duration);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::QueueDiscTimerWheel::Granularity", TimeValue (granularity));
+
+  BooleanValue wheel;
+  GlobalValue::GetValueByName ("QueueDiscTimerWheel", wheel);
+
+  ObjectFactory pie;
+  pie.SetTypeId ("ns3::PieQueueDisc");
+  pie.Set ("Tupdate", TimeValue (MilliSeconds (30)));
+  ObjectFactory drr;
+  drr.SetTypeId ("ns3::DRRQueueDisc");
+  drr.Set ("PerturbationPeriod", TimeValue (Seconds (1)));
+
+  NodeContainer c;
+  c.Create (nodes);
+
+  Ptr<UniformRandomVariable> start = CreateObject<UniformRandomVariable> ();
+  std::vector<Ptr<QueueDisc> > discs;
+  uint64_t created = 0;
+  for (uint32_t n = 0; n < nodes; n++)
+    {
+      for (uint32_t i = 0; i < pieDiscs + drrDiscs; i++)
+        {
+          Simulator::ScheduleWithContext (c.Get (n)->GetId (), MicroSeconds (start->GetInteger (0, 29999)),
+                                          &CreateQueueDisc, (i < pieDiscs ? pie : drr), &discs);
+          created++;
+        }
+    }
+
+  Simulator::Stop (duration);
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  // the events creating the queue discs and stopping the simulation are not
+  // related to the timers
+  uint64_t events = Simulator::GetEventCount () - created - 1;
+  uint64_t updates = 0;
+  for (uint32_t i = 0; i < pieDiscs + drrDiscs; i++)
+    {
+      Time period = (i < pieDiscs ? MilliSeconds (30) : Seconds (1));
+      updates += nodes * static_cast<uint64_t> (duration.GetTimeStep () / period.GetTimeStep ());
+    }
+
+  for (std::vector<Ptr<QueueDisc> >::iterator it = discs.begin (); it != discs.end (); it++)
+    {
+      (*it)->Dispose ();
+    }
+  discs.clear ();
+  Simulator::Destroy ();
+
+  std::cout << "wheel,granularity_ns,queue_discs,timer_expirations,events,events_per_expiration,wall_clock_ms" << std::endl;
+  std::cout << (wheel.Get () ? "true" : "false") << "," << granularity.GetNanoSeconds () << ","
+            << created << "," << updates << "," << events << ","
+            << (updates ? static_cast<double> (events) / updates : 0) << "," << elapsed << std::endl;
+
+  return 0;
+}
@@ -26,6 +26,7 @@
 */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/abort.h"
@@ -112,6 +113,8 @@ TypeId CoDelQueueDisc::GetTypeId (void)
                      "ns3::TracedValueCallback::Uint32")
   ;
 
+  static const bool reasonsRegistered = RegisterReasons ({TARGET_EXCEEDED_DROP, OVERLIMIT_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -361,6 +364,12 @@ CoDelQueueDisc::GetDropNext (void)
   return m_dropNext;
 }
 
+std::size_t
+CoDelQueueDisc::GetMemoryFootprint (void) const
+{
+  return QueueDisc::GetMemoryFootprint () + sizeof (CoDelQueueDisc) - sizeof (QueueDisc);
+}
+
 bool
 CoDelQueueDisc::CoDelTimeAfter (uint32_t a, uint32_t b)
 {
@@ -98,6 +98,8 @@ public:
    */
   uint32_t GetDropNext (void);
 
+  virtual std::size_t GetMemoryFootprint (void) const;
+
   // Reasons for dropping packets
   static constexpr const char* TARGET_EXCEEDED_DROP = "Target exceeded drop";  //!< Sojourn time above target
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";  //!< Overlimit dropped packet
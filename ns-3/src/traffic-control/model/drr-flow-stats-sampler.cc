@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/output-stream-wrapper.h"
+#include "drr-flow-stats-sampler.h"
+#include "drr-queue-disc.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DRRFlowStatsSampler");
+
+NS_OBJECT_ENSURE_REGISTERED (DRRFlowStatsSampler);
+
+TypeId DRRFlowStatsSampler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DRRFlowStatsSampler")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<DRRFlowStatsSampler> ()
+    .AddAttribute ("Interval",
+                   "The time between two samples of the flows",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&DRRFlowStatsSampler::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Binary",
+                   "True to write fixed-size binary records instead of comma-separated values",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DRRFlowStatsSampler::m_binary),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+DRRFlowStatsSampler::DRRFlowStatsSampler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DRRFlowStatsSampler::~DRRFlowStatsSampler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DRRFlowStatsSampler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  Object::DoDispose ();
+}
+
+void
+DRRFlowStatsSampler::Start (Ptr<DRRQueueDisc> queueDisc, Ptr<OutputStreamWrapper> stream)
+{
+  NS_LOG_FUNCTION (this << queueDisc << stream);
+  NS_ASSERT_MSG (m_interval.IsStrictlyPositive (), "The sampling interval must be positive");
+
+  Stop ();
+  m_queueDisc = queueDisc;
+  m_stream = stream;
+
+  if (!m_binary)
+    {
+      *m_stream->GetStream () << "time,flow,bucket,status,latency_critical,deficit,backlog,"
+                              << "served_packets,served_bytes,stolen_packets,stolen_bytes,"
+                              << "max_backlog,rounds_waited" << std::endl;
+    }
+  Sample ();
+}
+
+void
+DRRFlowStatsSampler::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_queueDisc = 0;
+  m_stream = 0;
+}
+
+/**
+ * \brief Write a value in host byte order
+ * \param os the stream
+ * \param value the value
+ */
+template <typename T>
+static void
+WriteBinary (std::ostream *os, T value)
+{
+  os->write (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+void
+DRRFlowStatsSampler::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::ostream *os = m_stream->GetStream ();
+  std::vector<DRRQueueDisc::FlowSnapshot> snapshot = m_queueDisc->GetFlowsSnapshot ();
+
+  for (std::vector<DRRQueueDisc::FlowSnapshot>::const_iterator it = snapshot.begin ();
+       it != snapshot.end (); it++)
+    {
+      uint8_t status = (it->status == DRRFlow::ACTIVE) ? 1 : 0;
+      if (m_binary)
+        {
+          WriteBinary<int64_t> (os, Simulator::Now ().GetNanoSeconds ());
+          WriteBinary<uint32_t> (os, it->index);
+          WriteBinary<uint32_t> (os, it->bucket);
+          WriteBinary<uint8_t> (os, status);
+          WriteBinary<uint8_t> (os, it->latencyCritical ? 1 : 0);
+          WriteBinary<int32_t> (os, it->deficit);
+          WriteBinary<uint32_t> (os, it->backlog);
+          WriteBinary<uint64_t> (os, it->stats.nServedPackets);
+          WriteBinary<uint64_t> (os, it->stats.nServedBytes);
+          WriteBinary<uint32_t> (os, it->stats.nStolenPackets);
+          WriteBinary<uint64_t> (os, it->stats.nStolenBytes);
+          WriteBinary<uint32_t> (os, it->stats.maxBacklog);
+          WriteBinary<uint64_t> (os, it->stats.nRoundsWaited);
+        }
+      else
+        {
+          *os << Simulator::Now ().GetSeconds () << "," << it->index << "," << it->bucket << ","
+              << +status << "," << it->latencyCritical << "," << it->deficit << "," << it->backlog << ","
+              << it->stats.nServedPackets << "," << it->stats.nServedBytes << ","
+              << it->stats.nStolenPackets << "," << it->stats.nStolenBytes << ","
+              << it->stats.maxBacklog << "," << it->stats.nRoundsWaited << "\n";
+        }
+    }
+
+  m_event = Simulator::Schedule (m_interval, &DRRFlowStatsSampler::Sample, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DRR_FLOW_STATS_SAMPLER_H
+#define DRR_FLOW_STATS_SAMPLER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+class DRRQueueDisc;
+class OutputStreamWrapper;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Periodically write the state and statistics of the flows of a DRR queue disc
+ *
+ * Every Interval, a record is written for each flow of the queue disc, as
+ * returned by DRRQueueDisc::GetFlowsSnapshot. Records are either lines of
+ * comma-separated values (preceded by a header line), with the fields
+ *
+ *   time,flow,bucket,status,latency_critical,deficit,backlog,served_packets,
+ *   served_bytes,stolen_packets,stolen_bytes,max_backlog,rounds_waited
+ *
+ * where time is in seconds and status is 1 for active flows, or, if Binary is
+ * true, fixed-size records of the same fields in host byte order: time in
+ * nanoseconds (int64), flow, bucket (uint32), status, latency_critical (uint8),
+ * deficit (int32), backlog (uint32), served_packets, served_bytes (uint64),
+ * stolen_packets (uint32), stolen_bytes (uint64), max_backlog (uint32) and
+ * rounds_waited (uint64), i.e., BINARY_RECORD_SIZE bytes per record.
+ */
+class DRRFlowStatsSampler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DRRFlowStatsSampler constructor
+   */
+  DRRFlowStatsSampler ();
+
+  virtual ~DRRFlowStatsSampler ();
+
+  /// Size of a binary record, in bytes
+  static const uint32_t BINARY_RECORD_SIZE = 66;
+
+  /**
+   * \brief Start sampling the flows of a queue disc, now and then every Interval
+   * \param queueDisc the queue disc
+   * \param stream the stream the records are written to
+   */
+  void Start (Ptr<DRRQueueDisc> queueDisc, Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \brief Stop sampling
+   */
+  void Stop (void);
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Write a record for each flow and schedule the next sample
+   */
+  void Sample (void);
+
+  Time m_interval;                     //!< Time between two samples
+  bool m_binary;                       //!< Whether binary records are written
+  Ptr<DRRQueueDisc> m_queueDisc;       //!< The sampled queue disc
+  Ptr<OutputStreamWrapper> m_stream;   //!< The stream the records are written to
+  EventId m_event;                     //!< The next sample
+};
+
+} // namespace ns3
+
+#endif /* DRR_FLOW_STATS_SAMPLER_H */
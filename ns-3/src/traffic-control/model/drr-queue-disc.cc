@@ -21,12 +21,22 @@
 */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/abort.h"
 #include "ns3/queue.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
 #include "drr-queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/node.h"
 #include "ns3/ipv4-packet-filter.h"
+#include "traffic-control-layer.h"
 #include "codel-queue-disc.h"
+#include <algorithm>
+#include <limits>
 
 namespace ns3 {
 
@@ -34,6 +44,31 @@ NS_LOG_COMPONENT_DEFINE ("DRRQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (DRRFlow);
 
+DRRFlow::Stats::Stats ()
+  : nServedPackets (0),
+    nServedBytes (0),
+    nStolenPackets (0),
+    nStolenBytes (0),
+    maxBacklog (0),
+    nRoundsWaited (0)
+{
+}
+
+void
+DRRFlow::Stats::Print (std::ostream &os) const
+{
+  os << "Packets/Bytes served: " << nServedPackets << " / " << nServedBytes
+     << "; Packets/Bytes stolen: " << nStolenPackets << " / " << nStolenBytes
+     << "; Max backlog: " << maxBacklog
+     << "; Rounds waited: " << nRoundsWaited;
+}
+
+std::ostream & operator << (std::ostream &os, const DRRFlow::Stats &stats)
+{
+  stats.Print (os);
+  return os;
+}
+
 TypeId DRRFlow::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::DRRFlow")
@@ -46,7 +81,11 @@ TypeId DRRFlow::GetTypeId (void)
 
 DRRFlow::DRRFlow ()
   : m_deficit (0),
-    m_status (INACTIVE)
+    m_status (INACTIVE),
+    m_index (0),
+    m_next (0),
+    m_prev (0),
+    m_quantum (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -91,9 +130,167 @@ DRRFlow::GetStatus (void) const
   return m_status;
 }
 
+void
+DRRFlow::SetIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_index = index;
+}
+
+uint32_t
+DRRFlow::GetIndex (void) const
+{
+  return m_index;
+}
+
+void
+DRRFlow::SetNext (DRRFlow *next)
+{
+  m_next = next;
+}
+
+DRRFlow*
+DRRFlow::GetNext (void) const
+{
+  return m_next;
+}
+
+void
+DRRFlow::SetPrev (DRRFlow *prev)
+{
+  m_prev = prev;
+}
+
+DRRFlow*
+DRRFlow::GetPrev (void) const
+{
+  return m_prev;
+}
+
+void
+DRRFlow::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+DRRFlow::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+const DRRFlow::Stats&
+DRRFlow::GetStats (void) const
+{
+  return m_stats;
+}
+
+void
+DRRFlow::SetQueue (Ptr<QueueDisc::InternalQueue> queue)
+{
+  NS_LOG_FUNCTION (this << queue);
+  m_queue = queue;
+}
+
+Ptr<QueueDisc::InternalQueue>
+DRRFlow::GetQueue (void) const
+{
+  return m_queue;
+}
+
+void
+DRRFlow::Enqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  if (m_queue)
+    {
+      m_queue->Enqueue (item);
+    }
+  else
+    {
+      GetQueueDisc ()->Enqueue (item);
+    }
+}
+
+Ptr<QueueDiscItem>
+DRRFlow::Dequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_queue ? m_queue->Dequeue () : GetQueueDisc ()->Dequeue ();
+}
+
+Ptr<const QueueDiscItem>
+DRRFlow::Peek (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_queue ? m_queue->Peek () : GetQueueDisc ()->Peek ();
+}
+
+Ptr<QueueDiscItem>
+DRRFlow::StealHeadPacket (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_queue)
+    {
+      return m_queue->Dequeue ();
+    }
+
+  Ptr<QueueDisc> qd = GetQueueDisc ();
+  if (qd->GetInternalQueue (0)->GetNPackets () < qd->GetNPackets ())
+    {
+      // the head packet has been peeked and is held by the flow queue disc,
+      // which must be asked to release it to keep its counters consistent
+      return qd->Dequeue ();
+    }
+  return qd->GetInternalQueue (0)->Dequeue ();
+}
+
+uint32_t
+DRRFlow::GetNPackets (void) const
+{
+  if (m_queue)
+    {
+      return m_queue->GetNPackets ();
+    }
+  // a flow released after being idle has neither a queue disc nor a queue
+  return GetQueueDisc () ? GetQueueDisc ()->GetNPackets () : 0;
+}
+
+uint32_t
+DRRFlow::GetNBytes (void) const
+{
+  if (m_queue)
+    {
+      return m_queue->GetNBytes ();
+    }
+  return GetQueueDisc () ? GetQueueDisc ()->GetNBytes () : 0;
+}
+
+void
+DRRFlow::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_queue = 0;
+  QueueDiscClass::DoDispose ();
+}
+
 
 NS_OBJECT_ENSURE_REGISTERED (DRRQueueDisc);
 
+/**
+ * \brief Get the default factory for the queue discs of the flow queues
+ * \return a factory creating CoDel queue discs
+ */
+static ObjectFactory
+GetDefaultFlowQueueDiscFactory (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (CoDelQueueDisc::GetTypeId ());
+  return factory;
+}
+
 TypeId DRRQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::DRRQueueDisc")
@@ -110,14 +307,78 @@ TypeId DRRQueueDisc::GetTypeId (void)
                    UintegerValue (1024),
                    MakeUintegerAccessor (&DRRQueueDisc::m_flows),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Ways",
+                   "The number of ways of each set of the flow table. The flow queues "
+                   "of a set are allocated to distinct flows, identified by the value "
+                   "returned by the packet filters (1 for a direct-mapped flow table)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DRRQueueDisc::m_ways),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("DropBatchSize",
+                   "The maximum number of packets dropped from the fat flow",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DRRQueueDisc::m_dropBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SkipRounds",
+                   "True to directly select the next flow to serve instead of visiting "
+                   "the active flows one at a time. Packets are dequeued in the same order, "
+                   "but the deficit of a flow is only updated when the flow is served",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DRRQueueDisc::m_skipRounds),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FlowQueueDisc",
+                   "The factory used to create the queue disc of each flow queue "
+                   "(e.g., ns3::FifoQueueDisc for classic DRR). The queue disc must "
+                   "have an internal queue, from which packets are stolen",
+                   ObjectFactoryValue (GetDefaultFlowQueueDiscFactory ()),
+                   MakeObjectFactoryAccessor (&DRRQueueDisc::m_queueDiscFactory),
+                   MakeObjectFactoryChecker ())
+    .AddAttribute ("LightweightFlows",
+                   "True to store the packets of each flow queue in a FIFO queue held "
+                   "by the flow, as in classic DRR, instead of a queue disc created by "
+                   "the FlowQueueDisc factory",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DRRQueueDisc::m_lightweightFlows),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PerturbationPeriod",
+                   "The period after which the salt of the hash function selecting the flow "
+                   "queue of a packet is changed (0 to never change it). The packets of the "
+                   "active flows are then migrated one flow queue at a time",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DRRQueueDisc::m_perturbPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("IdleTimeout",
+                   "The time after which the queue disc of an inactive flow queue is "
+                   "released and its hash bucket freed (0 to never release them). The "
+                   "released flow queues are reused for new flows",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DRRQueueDisc::m_idleTimeout),
+                   MakeTimeChecker ())
   ;
+  static const bool reasonsRegistered = RegisterReasons ({UNCLASSIFIED_DROP, OVERLIMIT_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
 DRRQueueDisc::DRRQueueDisc ()
-  : m_quantum (0)
+  : m_quantum (0),
+    m_nTxQueues (1),
+    m_selectTxQueue (false),
+    m_activeTail (0),
+    m_servedFlow (0),
+    m_nextFlow (0),
+    m_latencyCriticalTail (0),
+    m_nDemotedFlows (0),
+    m_dscpQuanta (64, 0),
+    m_dscpLatencyCritical (64, false),
+    m_nReleasedFlows (0),
+    m_salt (0),
+    m_oldSalt (0),
+    m_round (0)
 {
   NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+  m_perturbEvent.SetFunction (MakeCallback (&DRRQueueDisc::Perturb, this));
 }
 
 DRRQueueDisc::~DRRQueueDisc ()
@@ -125,6 +386,24 @@ DRRQueueDisc::~DRRQueueDisc ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+DRRQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_activeTail = 0;
+  m_servedFlow = 0;
+  m_nextFlow = 0;
+  m_nextItem = 0;
+  m_latencyCriticalTail = 0;
+  m_flowTable.clear ();
+  m_roundsHeap.clear ();
+  m_idleFlows.clear ();
+  m_pendingFlows.clear ();
+  m_uv = 0;
+  m_perturbEvent.Cancel ();
+  QueueDisc::DoDispose ();
+}
+
 void
 DRRQueueDisc::SetQuantum (uint32_t quantum)
 {
@@ -138,54 +417,190 @@ DRRQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
-bool
-DRRQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+void
+DRRQueueDisc::SetFlowQuantum (uint32_t index, uint32_t quantum)
 {
-  NS_LOG_FUNCTION (this << item);
+  NS_LOG_FUNCTION (this << index << quantum);
+  if (index >= m_flowQuanta.size ())
+    {
+      m_flowQuanta.resize (index + 1, 0);
+    }
+  m_flowQuanta[index] = quantum;
+}
 
-  int32_t ret = Classify (item);
-  uint32_t h;
+void
+DRRQueueDisc::SetDscpQuantum (uint8_t dscp, uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) dscp << quantum);
+  NS_ABORT_MSG_IF (dscp >= m_dscpQuanta.size (), "Invalid DSCP value " << (uint32_t) dscp);
+  m_dscpQuanta[dscp] = quantum;
+}
 
-  if (ret == PacketFilter::PF_NO_MATCH)
+void
+DRRQueueDisc::SetFlowLatencyCritical (uint32_t index, bool latencyCritical)
+{
+  NS_LOG_FUNCTION (this << index << latencyCritical);
+  if (index >= m_flowLatencyCritical.size ())
     {
-      NS_LOG_WARN ("No filter has been able to classify this packet.");
-      h = m_flows; // place all unfiltered packets into a separate flow queue
+      m_flowLatencyCritical.resize (index + 1, -1);
     }
+  m_flowLatencyCritical[index] = latencyCritical ? 1 : 0;
+}
 
-  else
+void
+DRRQueueDisc::SetDscpLatencyCritical (uint8_t dscp, bool latencyCritical)
+{
+  NS_LOG_FUNCTION (this << (uint32_t) dscp << latencyCritical);
+  NS_ABORT_MSG_IF (dscp >= m_dscpLatencyCritical.size (), "Invalid DSCP value " << (uint32_t) dscp);
+  m_dscpLatencyCritical[dscp] = latencyCritical;
+}
+
+uint32_t
+DRRQueueDisc::GetNDemotedFlows (void) const
+{
+  return m_nDemotedFlows;
+}
+
+uint32_t
+DRRQueueDisc::GetNReleasedFlows (void) const
+{
+  return m_nReleasedFlows;
+}
+
+/**
+ * \brief Get the number of bytes allocated by a vector
+ * \param v the vector
+ * \return the number of bytes allocated by the vector
+ */
+template <typename T>
+static std::size_t
+GetVectorFootprint (const std::vector<T> &v)
+{
+  return v.capacity () * sizeof (T);
+}
+
+/**
+ * \brief Get the number of bytes allocated by a vector of booleans, which
+ *        stores a bit per element
+ * \param v the vector
+ * \return the number of bytes allocated by the vector
+ */
+static std::size_t
+GetVectorFootprint (const std::vector<bool> &v)
+{
+  return v.capacity () / 8;
+}
+
+std::size_t
+DRRQueueDisc::GetMemoryFootprint (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return QueueDisc::GetMemoryFootprint () + sizeof (DRRQueueDisc) - sizeof (QueueDisc)
+    + GetNQueueDiscClasses () * (sizeof (DRRFlow) - sizeof (QueueDiscClass))
+    + (GetNQueueDiscClasses () - m_freeFlows.size ()) * (m_lightweightFlows ? sizeof (DropTailQueue<QueueDiscItem>) : 0)
+    + GetVectorFootprint (m_flowTable) + GetVectorFootprint (m_flowQuanta)
+    + GetVectorFootprint (m_dscpQuanta) + GetVectorFootprint (m_flowLatencyCritical)
+    + GetVectorFootprint (m_dscpLatencyCritical) + GetVectorFootprint (m_latencyCritical)
+    + GetVectorFootprint (m_flowIds) + GetVectorFootprint (m_txQueues)
+    + GetVectorFootprint (m_buckets) + GetVectorFootprint (m_idleSince)
+    + GetVectorFootprint (m_freeFlows) + GetVectorFootprint (m_migrationPending)
+    + GetVectorFootprint (m_backlogs) + GetVectorFootprint (m_backlogHeap)
+    + GetVectorFootprint (m_heapPositions) + GetVectorFootprint (m_labels)
+    + GetVectorFootprint (m_nextRounds) + GetVectorFootprint (m_eligibleRounds)
+    + GetVectorFootprint (m_roundsHeap) + GetVectorFootprint (m_roundsHeapPositions)
+    + m_pendingFlows.size () * sizeof (uint32_t)
+    + m_idleFlows.size () * sizeof (std::pair<uint32_t, Time>);
+}
+
+std::vector<DRRQueueDisc::FlowSnapshot>
+DRRQueueDisc::GetFlowsSnapshot (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<FlowSnapshot> snapshot (GetNQueueDiscClasses ());
+  for (uint32_t i = 0; i < snapshot.size (); i++)
     {
-      h = ret % m_flows;
+      Ptr<DRRFlow> flow = StaticCast<DRRFlow> (GetQueueDiscClass (i));
+      snapshot[i].index = i;
+      snapshot[i].bucket = m_buckets[i];
+      snapshot[i].status = flow->GetStatus ();
+      snapshot[i].latencyCritical = m_latencyCritical[i];
+      snapshot[i].deficit = flow->GetDeficit ();
+      snapshot[i].backlog = flow->GetNBytes ();
+      snapshot[i].stats = flow->GetStats ();
     }
+  return snapshot;
+}
 
-  Ptr<DRRFlow> flow;
-  if (m_flowsIndices.find (h) == m_flowsIndices.end ())
-    {
-      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<DRRFlow> ();
-      Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
-      qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      AddQueueDiscClass (flow);
+double
+DRRQueueDisc::GetJainFairnessIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
-    }
-  else
+  double sum = 0;
+  double sumSquares = 0;
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
     {
-      flow = StaticCast<DRRFlow> (GetQueueDiscClass (m_flowsIndices[h]));
+      double bytes = StaticCast<DRRFlow> (GetQueueDiscClass (i))->GetStats ().nServedBytes;
+      if (bytes > 0)
+        {
+          sum += bytes;
+          sumSquares += bytes * bytes;
+          n++;
+        }
     }
+  return n ? sum * sum / (n * sumSquares) : 0;
+}
 
+int64_t
+DRRQueueDisc::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
 
-  flow->GetQueueDisc ()->Enqueue (item);
+bool
+DRRQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
 
-  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+  // the packet may be served before the flow selected by a peek request, if
+  // any, or may trigger drops from that flow
+  m_nextFlow = 0;
+  m_nextItem = 0;
 
-  if (flow->GetStatus () == DRRFlow::INACTIVE)
+  ReleaseIdleFlows ();
+
+  int32_t ret = Classify (item);
+  uint32_t h = LookupBucket (ret, m_salt);
+
+  if (ret == PacketFilter::PF_NO_MATCH)
     {
-      NS_LOG_DEBUG ("Setting flow as ACTIVE");
-      flow->SetStatus (DRRFlow::ACTIVE);
-      m_flowList.push_back (flow);
+      NS_LOG_WARN ("No filter has been able to classify this packet.");
+    }
+  else if (!m_pendingFlows.empty ())
+    {
+      // the packets of a flow keep being enqueued into the flow queue given by
+      // the previous salt until the latter is migrated
+      uint32_t oldH = LookupBucket (ret, m_oldSalt);
+      if (m_flowTable[oldH] && m_migrationPending[m_flowTable[oldH]->GetIndex ()])
+        {
+          h = oldH;
+        }
+    }
+
+  Ptr<DRRFlow> flow = m_flowTable[h];
+  if (flow && flow->GetStatus () == DRRFlow::ACTIVE && m_flowIds[flow->GetIndex ()] != ret)
+    {
+      NS_LOG_DEBUG ("Packet collided in flow " << h << " with another flow");
+      Collided (item);
     }
 
+  EnqueueIntoBucket (h, ret, item);
+  MigrateFlow ();
+
   while (GetNBytes () > m_limit)
     {
       DRRDrop ();
@@ -199,163 +614,1199 @@ DRRQueueDisc::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<DRRFlow> flow;
-  Ptr<QueueDiscItem> item;
-
-  if (m_flowList.empty ())
-    {
-      NS_LOG_DEBUG ("No active flows found");
-      return 0;
-    }
-
-  do
+  if (!m_nextFlow || (m_nTxQueues > 1 && IsTxQueueStopped (m_nextFlow)))
     {
-      if (!m_flowList.empty ())   // unnecessary ?
+      // no flow has been selected by a peek request since the last operation,
+      // or the transmission queue of the selected flow has been stopped since
+      MigrateFlow ();
+      m_nextFlow = SelectFlow ();
+      if (!m_nextFlow)
         {
-          flow = m_flowList.front ();
-          m_flowList.pop_front ();
-          flow->IncreaseDeficit (m_quantum);
-          Ptr<const QueueDiscItem> t_item = flow->GetQueueDisc ()->Peek ();
-
-          if ( (uint32_t) flow->GetDeficit () >= t_item->GetSize ())
-            {
-              item = flow->GetQueueDisc ()->Dequeue ();
-              flow->IncreaseDeficit (-item->GetSize ());
-              NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket ());
-
-              if (flow->GetQueueDisc ()->GetNPackets () == 0)
-                {
-                  NS_LOG_DEBUG ("Empty Flow, Setting it to INACTIVE");
-                  flow->SetDeficit (0);
-                  flow->SetStatus (DRRFlow::INACTIVE);
-                }
+          return 0;
+        }
+    }
 
-              else
-                {
-                  NS_LOG_DEBUG ("Flow still active, pushing back to active list");
-                  m_flowList.push_back (flow);
-                }
+  Ptr<DRRFlow> flow = m_nextFlow;
+  m_nextFlow = 0;
+  m_nextItem = 0;
 
-              return item;
-            }                   //End if(flow->GetDeficit ...)
+  // the head packet of the selected flow has been peeked, hence it is the
+  // packet its queue disc or queue returns
+  uint32_t index = flow->GetIndex ();
+  Ptr<QueueDiscItem> item = flow->Dequeue ();
+  NS_ASSERT (item);
+  UpdateBacklog (flow);
+  flow->m_stats.nServedPackets++;
+  flow->m_stats.nServedBytes += item->GetSize ();
 
-          else
-            {
-              NS_LOG_DEBUG ("Packet size greater than deficit, pushing flow back to end of list");
-              m_flowList.push_back (flow);
-              item = 0;
-            }
+  if (m_latencyCritical[index])
+    {
+      NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket () << " from a latency-critical flow");
+      if (flow->GetNPackets () == 0)
+        {
+          DeactivateFlow (flow);
         }
       else
         {
-          NS_LOG_DEBUG ("No active flows found");
-          return 0;
+          // the flow is at the head of the list of latency-critical flows and
+          // becomes its tail
+          m_latencyCriticalTail = m_latencyCriticalTail->GetNext ();
         }
+      return item;
     }
-  while (item == 0);
-
-  return 0; //never reached
-}
 
-Ptr<const QueueDiscItem>
-DRRQueueDisc::DoPeek (void) const
-{
-  NS_LOG_FUNCTION (this);
-
-  Ptr<DRRFlow> flow;
+  NS_ASSERT ((uint32_t) flow->GetDeficit () >= item->GetSize ());
+  flow->IncreaseDeficit (-item->GetSize ());
+  NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket ());
 
-  if (!m_flowList.empty ())
+  if (flow->GetNPackets () == 0)
+    {
+      if (m_skipRounds)
+        {
+          RoundsHeapRemove (index);
+        }
+      DeactivateFlow (flow);
+    }
+  else if (m_skipRounds)
     {
-      flow = m_flowList.front ();
+      UpdateEligibility (flow);
     }
   else
     {
-      return 0;
+      // the flow stays at the head of the list, and its turn goes on as long
+      // as its deficit covers its head packet
+      NS_LOG_DEBUG ("Flow still active, keeping it at the head of the active list");
     }
 
-  return flow->GetQueueDisc ()->Peek ();
+  return item;
 }
 
-bool
-DRRQueueDisc::CheckConfig (void)
+DRRFlow*
+DRRQueueDisc::SelectFlow (void)
 {
   NS_LOG_FUNCTION (this);
-  if (GetNQueueDiscClasses () > 0)
-    {
-      NS_LOG_ERROR ("DRRQueueDisc cannot have classes");
-      return false;
-    }
 
-  if (GetNPacketFilters () == 0)
+  if (m_latencyCriticalTail)
     {
-      // Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
-      //AddPacketFilter (ipv4Filter);
-      NS_LOG_ERROR ("DRRQueueDisc needs at least a packet filter");
-      return false;
+      DRRFlow *flow = SelectLatencyCriticalFlow ();
+      if (flow)
+        {
+          return flow;
+        }
     }
 
-  if (GetNInternalQueues () > 0)
+  if (!m_activeTail)
     {
-      NS_LOG_ERROR ("DRRQueueDisc cannot have internal queues");
-      return false;
+      NS_LOG_DEBUG ("No active flows found");
+      return 0;
     }
 
-  return true;
-}
-
-void
-DRRQueueDisc::InitializeParams (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  // we are at initialization time. If the user has not set a quantum value,
-  // set the quantum to the MTU of the device
-  if (!m_quantum)
+  if (m_skipRounds)
     {
-      //Ptr<NetDevice> device = GetNetDevice ();
-      //NS_ASSERT_MSG (device, "Device not set for the queue disc");
-      //m_quantum = device->GetMtu ();
-      m_quantum = 600;
-      NS_LOG_DEBUG ("Setting the quantum to: " << m_quantum);
+      return SelectSkippingRounds ();
     }
 
-  m_flowFactory.SetTypeId ("ns3::DRRFlow");
-
-  m_queueDiscFactory.SetTypeId ("ns3::CoDelQueueDisc");
-
-  //m_queueDiscFactory.Set ("Mode", EnumValue (QueueBase::QUEUE_MODE_BYTES));
-  //m_queueDiscFactory.Set ("MaxPackets", UintegerValue (m_limit + 1));
-  // m_queueDiscFactory.Set ("Interval", StringValue (m_interval));
-  //m_queueDiscFactory.Set ("Target", StringValue (m_target));
-}
+  // the first flow skipped because its transmission queue is stopped since
+  // the last time a flow whose transmission queue is not stopped was visited
+  DRRFlow *firstStopped = 0;
 
-uint32_t
-DRRQueueDisc::DRRDrop (void)
+  while (m_activeTail)
+    {
+      DRRFlow *flow = m_activeTail->GetNext ();
+      if (m_nTxQueues > 1 && IsTxQueueStopped (flow))
+        {
+          if (flow == firstStopped)
+            {
+              NS_LOG_DEBUG ("The transmission queues of all the active flows are stopped");
+              return 0;
+            }
+          if (!firstStopped)
+            {
+              firstStopped = flow;
+            }
+          // the flow is skipped, and its turn (if in progress) ends
+          NS_LOG_DEBUG ("Transmission queue of the flow stopped, skipping it");
+          if (flow == m_servedFlow)
+            {
+              m_servedFlow = 0;
+            }
+          m_activeTail = m_activeTail->GetNext ();
+          continue;
+        }
+      firstStopped = 0;
+
+      if (flow != m_servedFlow)
+        {
+          // the turn of the flow at the head of the list begins
+          flow->IncreaseDeficit (flow->GetQuantum ());
+          flow->m_stats.nRoundsWaited++;
+          m_servedFlow = flow;
+        }
+      Ptr<const QueueDiscItem> item = flow->Peek ();
+      UpdateBacklog (flow);
+
+      if (!item)
+        {
+          // all the packets of this flow have been stolen
+          DeactivateFlow (flow);
+        }
+      else if ((uint32_t) flow->GetDeficit () >= item->GetSize ())
+        {
+          return flow;
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Packet size greater than deficit, pushing flow back to end of list");
+          // the head of the circular list becomes its tail
+          m_activeTail = m_activeTail->GetNext ();
+          m_servedFlow = 0;
+        }
+    }
+
+  NS_LOG_DEBUG ("No active flows found");
+  return 0;
+}
+
+DRRFlow*
+DRRQueueDisc::SelectSkippingRounds (void)
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t maxBacklog = 0, index = 0;
-  Ptr<QueueDisc> qd;
+  while (!m_roundsHeap.empty ())
+    {
+      /* The flow at the top of the rounds heap is the first flow that is either
+       * able to send its head packet or found empty when the active flows are
+       * visited in turn. Visiting all the flows up to it amounts to moving the
+       * tail of the active list to it */
+      uint32_t index = m_roundsHeap.front ();
+      Ptr<DRRFlow> flow = StaticCast<DRRFlow> (GetQueueDiscClass (index));
+      m_activeTail = PeekPointer (flow);
+      m_round = m_eligibleRounds[index];
+      CatchUpDeficit (flow);
+      m_servedFlow = PeekPointer (flow);
 
-  /* Queue is full! Find the fat flow and drop one packet from it */
-  for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
+      if (!flow->Peek ())
+        {
+          // all the packets of this flow have been stolen
+          UpdateBacklog (flow);
+          RoundsHeapRemove (index);
+          DeactivateFlow (flow);
+          continue;
+        }
+
+      return PeekPointer (flow);
+    }
+
+  NS_LOG_DEBUG ("No active flows found");
+  return 0;
+}
+
+DRRFlow*
+DRRQueueDisc::SelectLatencyCriticalFlow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the first flow skipped because its transmission queue is stopped
+  DRRFlow *firstStopped = 0;
+
+  while (m_latencyCriticalTail)
     {
-      qd = GetQueueDiscClass (i)->GetQueueDisc ();
-      uint32_t bytes = qd->GetNBytes ();
-      if (bytes > maxBacklog)
+      DRRFlow *flow = m_latencyCriticalTail->GetNext ();
+      if (m_nTxQueues > 1 && IsTxQueueStopped (flow))
+        {
+          if (flow == firstStopped)
+            {
+              NS_LOG_DEBUG ("The transmission queues of all the latency-critical flows are stopped");
+              return 0;
+            }
+          if (!firstStopped)
+            {
+              firstStopped = flow;
+            }
+          m_latencyCriticalTail = m_latencyCriticalTail->GetNext ();
+          continue;
+        }
+
+      // a latency-critical flow holds at most one quantum, hence it needs no
+      // deficit and sends one packet per turn
+      if (!flow->Peek ())
         {
-          maxBacklog = bytes;
-          index = i;
+          // all the packets of this flow have been stolen
+          UpdateBacklog (flow);
+          DeactivateFlow (flow);
+          continue;
         }
+
+      return flow;
+    }
+
+  return 0;
+}
+
+Ptr<const QueueDiscItem>
+DRRQueueDisc::DoPeek (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the flow to serve next is selected as by a dequeue request, and kept until
+  // the next enqueue or dequeue request, so that the peeked packet is the one
+  // the next dequeue request returns. Unlike the default implementation, the
+  // packet is not dequeued from the queue disc of the flow
+  if (!m_nextFlow)
+    {
+      MigrateFlow ();
+      m_nextFlow = SelectFlow ();
+      if (!m_nextFlow)
+        {
+          return 0;
+        }
+      m_nextItem = m_nextFlow->Peek ();
+    }
+
+  return m_nextItem;
+}
+
+bool
+DRRQueueDisc::IsMultiQueueAware (void) const
+{
+  return m_nTxQueues > 1;
+}
+
+bool
+DRRQueueDisc::IsTxQueueStopped (const DRRFlow *flow) const
+{
+  return GetNetDeviceQueueInterface ()->GetTxQueue (m_txQueues[flow->GetIndex ()])->IsStopped ();
+}
+
+bool
+DRRQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("DRRQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () == 0)
+    {
+      // Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+      //AddPacketFilter (ipv4Filter);
+      NS_LOG_ERROR ("DRRQueueDisc needs at least a packet filter");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("DRRQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (m_flows % m_ways)
+    {
+      NS_LOG_ERROR ("The number of flows must be a multiple of the number of ways");
+      return false;
+    }
+
+  // the flows are mapped to the transmission queues of a multi-queue device
+  // if this is the root queue disc (the children of mq are already bound to a
+  // transmission queue each)
+  Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+  Ptr<NetDevice> dev;
+  if (ndqi && ndqi->GetNTxQueues () > 1 && (dev = ndqi->GetObject<NetDevice> ()) && dev->GetNode ())
+    {
+      Ptr<TrafficControlLayer> tc = dev->GetNode ()->GetObject<TrafficControlLayer> ();
+      if (tc && tc->GetRootQueueDiscOnDevice (dev) == this)
+        {
+          m_nTxQueues = ndqi->GetNTxQueues ();
+          m_selectTxQueue = (ndqi->GetSelectQueueCallback () != nullptr);
+        }
+    }
+
+  if (m_skipRounds && m_nTxQueues > 1)
+    {
+      NS_LOG_ERROR ("Rounds cannot be skipped when the flows are mapped to multiple transmission queues");
+      return false;
+    }
+
+  return true;
+}
+
+void
+DRRQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // we are at initialization time. If the user has not set a quantum value,
+  // set the quantum to the MTU of the device
+  if (!m_quantum)
+    {
+      //Ptr<NetDevice> device = GetNetDevice ();
+      //NS_ASSERT_MSG (device, "Device not set for the queue disc");
+      //m_quantum = device->GetMtu ();
+      m_quantum = 600;
+      NS_LOG_DEBUG ("Setting the quantum to: " << m_quantum);
     }
 
-  /* Now we drop one packet from the fat flow */
-  qd = GetQueueDiscClass (index)->GetQueueDisc ();
+  m_flowFactory.SetTypeId ("ns3::DRRFlow");
+
+  // one more bucket for the packets that cannot be classified. The flow table
+  // and the backlog heap are sized now so that they never need to grow
+  m_flowTable.resize (m_flows + 1);
+  m_flowQuanta.resize (std::max<size_t> (m_flowQuanta.size (), m_flows + 1), 0);
+  m_flowLatencyCritical.resize (std::max<size_t> (m_flowLatencyCritical.size (), m_flows + 1), -1);
+  m_latencyCritical.reserve (m_flows + 1);
+  m_flowIds.reserve (m_flows + 1);
+  m_txQueues.reserve (m_flows + 1);
+  m_migrationPending.reserve (m_flows + 1);
+  m_buckets.reserve (m_flows + 1);
+  m_idleSince.reserve (m_flows + 1);
+  m_backlogs.reserve (m_flows + 1);
+  m_backlogHeap.reserve (m_flows + 1);
+  m_heapPositions.reserve (m_flows + 1);
+  m_labels.reserve (m_flows + 1);
+  m_nextRounds.reserve (m_flows + 1);
+  m_eligibleRounds.reserve (m_flows + 1);
+  m_roundsHeap.reserve (m_flows + 1);
+  m_roundsHeapPositions.reserve (m_flows + 1);
+
+  if (!m_perturbPeriod.IsZero ())
+    {
+      m_perturbEvent.Schedule (m_perturbPeriod);
+    }
+}
+
+uint32_t
+DRRQueueDisc::DRRDrop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT (!m_backlogHeap.empty ());
+
+  /* Queue is full! The fat flow is at the top of the backlog heap. Child queue
+   * discs may drop packets without notifying us (e.g., while serving a peek
+   * request), hence the cached backlog of a flow can only be larger than the
+   * actual one. Refresh the top of the heap until it is up to date */
+  uint32_t index = m_backlogHeap.front ();
+  Ptr<DRRFlow> flow = StaticCast<DRRFlow> (GetQueueDiscClass (index));
+  while (m_backlogs[index] != flow->GetNBytes ())
+    {
+      UpdateBacklog (flow);
+      index = m_backlogHeap.front ();
+      flow = StaticCast<DRRFlow> (GetQueueDiscClass (index));
+    }
+
+  /* Our goal is to drop half of this fat flow backlog, but no more than
+   * m_dropBatchSize packets. Every dropped packet is reported as an overlimit drop */
+  uint32_t len = 0, count = 0, threshold = m_backlogs[index] >> 1;
   Ptr<QueueDiscItem> item;
-  item = qd->GetInternalQueue (0)->Dequeue ();
-  DropAfterDequeue (item, OVERLIMIT_DROP);
+
+  do
+    {
+      item = flow->StealHeadPacket ();
+      if (!item)
+        {
+          break;
+        }
+      DropAfterDequeue (item, OVERLIMIT_DROP);
+      len += item->GetSize ();
+      flow->m_stats.nStolenPackets++;
+      flow->m_stats.nStolenBytes += item->GetSize ();
+    } while (++count < m_dropBatchSize && len < threshold);
+
+  NS_LOG_DEBUG ("Dropped " << count << " packets (" << len << " bytes) from flow " << index);
+  UpdateBacklog (flow);
+
+  if (m_skipRounds && !m_latencyCritical[index])
+    {
+      CatchUpDeficit (flow);
+      UpdateEligibility (flow);
+    }
 
   return index;
 }
 
+uint32_t
+DRRQueueDisc::GetBucket (int32_t ret, uint32_t salt) const
+{
+  if (ret == PacketFilter::PF_NO_MATCH)
+    {
+      return m_flows; // place all unfiltered packets into a separate flow queue
+    }
+
+  if (!salt)
+    {
+      return ret % m_flows;
+    }
+
+  // murmur3 finalizer of the salted value, so that the flows sharing a bucket
+  // with a salt are spread over the buckets with another salt
+  uint32_t h = (uint32_t) ret ^ salt;
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h % m_flows;
+}
+
+uint32_t
+DRRQueueDisc::LookupBucket (int32_t ret, uint32_t salt) const
+{
+  uint32_t h = GetBucket (ret, salt);
+
+  if (m_ways == 1 || h == m_flows)
+    {
+      return h;
+    }
+
+  // as in the Linux cake queue disc, the ways are tagged with the flow they
+  // are allocated to, i.e., with the value returned by the packet filters
+  uint32_t first = h - h % m_ways;
+  for (uint32_t b = first; b < first + m_ways; b++)
+    {
+      DRRFlow *flow = PeekPointer (m_flowTable[b]);
+      if (flow && flow->GetStatus () == DRRFlow::ACTIVE && m_flowIds[flow->GetIndex ()] == ret)
+        {
+          return b;
+        }
+    }
+
+  for (uint32_t b = first; b < first + m_ways; b++)
+    {
+      DRRFlow *flow = PeekPointer (m_flowTable[b]);
+      if (!flow || flow->GetStatus () == DRRFlow::INACTIVE)
+        {
+          return b;
+        }
+    }
+
+  return h;
+}
+
+void
+DRRQueueDisc::EnqueueIntoBucket (uint32_t h, int32_t ret, Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << h << ret << item);
+
+  Ptr<DRRFlow> flow = m_flowTable[h];
+  if (!flow)
+    {
+      Ptr<QueueDisc> qd;
+      Ptr<InternalQueue> queue;
+      if (m_lightweightFlows)
+        {
+          // the byte limit of DRR is the only limit on the packets of a flow
+          queue = CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+              ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, std::numeric_limits<uint32_t>::max ())));
+          ConnectInternalQueue (queue);
+        }
+      else
+        {
+          qd = m_queueDiscFactory.Create<QueueDisc> ();
+          qd->Initialize ();
+          NS_ABORT_MSG_IF (qd->GetNInternalQueues () == 0, "The queue disc of a DRR flow must have an internal queue");
+        }
+
+      if (!m_freeFlows.empty ())
+        {
+          // reuse a flow released after being idle, so that the number of
+          // flows follows the number of concurrent flows
+          flow = StaticCast<DRRFlow> (GetQueueDiscClass (m_freeFlows.back ()));
+          m_freeFlows.pop_back ();
+          NS_LOG_DEBUG ("Reusing the released flow with index " << flow->GetIndex () << " for flow queue " << h);
+          if (qd)
+            {
+              ReplaceQueueDiscClassChild (flow->GetIndex (), qd);
+            }
+          flow->SetQueue (queue);
+          flow->m_stats = DRRFlow::Stats ();
+          m_flowTable[h] = flow;
+          m_buckets[flow->GetIndex ()] = h;
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
+          flow = m_flowFactory.Create<DRRFlow> ();
+          flow->SetQueueDisc (qd);
+          flow->SetQueue (queue);
+          AddQueueDiscClass (flow);
+
+          flow->SetIndex (GetNQueueDiscClasses () - 1);
+          m_flowTable[h] = flow;
+          AddToBacklogHeap (flow);
+          m_flowIds.push_back (0);
+          m_txQueues.push_back (0);
+          m_buckets.push_back (h);
+          m_idleSince.push_back (Seconds (0));
+          m_latencyCritical.push_back (false);
+          m_migrationPending.push_back (false);
+          m_labels.push_back (0);
+          m_nextRounds.push_back (0);
+          m_eligibleRounds.push_back (0);
+          m_roundsHeapPositions.push_back (0);
+        }
+    }
+
+  bool wasEmpty = (flow->GetNPackets () == 0);
+  flow->Enqueue (item);
+  UpdateBacklog (flow);
+
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h << "; flow index " << flow->GetIndex ());
+
+  if (flow->GetStatus () == DRRFlow::INACTIVE)
+    {
+      NS_LOG_DEBUG ("Setting flow as ACTIVE");
+      flow->SetStatus (DRRFlow::ACTIVE);
+      // the quanta are set for the buckets of the unsalted hash
+      flow->SetQuantum (LookupQuantum (GetBucket (ret, 0), item));
+      m_flowIds[flow->GetIndex ()] = ret;
+      if (m_nTxQueues > 1)
+        {
+          // the transmission queue selected by the device for the packet that
+          // makes the flow active or, if the device does not select one, the
+          // one given by the unsalted hash, which does not change over time
+          m_txQueues[flow->GetIndex ()] = m_selectTxQueue ? item->GetTxQueueIndex ()
+                                                          : GetBucket (ret, 0) % m_nTxQueues;
+        }
+      if (LookupLatencyCritical (GetBucket (ret, 0), item))
+        {
+          PushLatencyCriticalFlow (flow);
+        }
+      else
+        {
+          PushActiveFlow (flow);
+        }
+    }
+  else if (m_skipRounds && wasEmpty && !m_latencyCritical[flow->GetIndex ()])
+    {
+      // all the packets of this active flow had been stolen, hence this packet
+      // is the new head packet
+      CatchUpDeficit (flow);
+      UpdateEligibility (flow);
+    }
+
+  // all the packets of a flow are sent to the same transmission queue
+  if (m_nTxQueues > 1)
+    {
+      item->SetTxQueueIndex (m_txQueues[flow->GetIndex ()]);
+    }
+
+  // policing of the latency-critical flows
+  if (m_latencyCritical[flow->GetIndex ()] && m_backlogs[flow->GetIndex ()] > flow->GetQuantum ())
+    {
+      DemoteFlow (flow);
+    }
+}
+
+void
+DRRQueueDisc::Perturb (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_pendingFlows.empty ())
+    {
+      // otherwise, the flows queued with the salt before the previous one could not be tracked
+      NS_LOG_DEBUG ("Keeping the salt, " << m_pendingFlows.size () << " flows still have to be migrated");
+    }
+  else
+    {
+      m_oldSalt = m_salt;
+      do
+        {
+          m_salt = m_uv->GetInteger (1, std::numeric_limits<uint32_t>::max ());
+        }
+      while (m_salt == m_oldSalt);
+
+      // the packets that cannot be classified are not hashed
+      DRRFlow *unclassified = PeekPointer (m_flowTable[m_flows]);
+      DRRFlow *tails[] = {m_latencyCriticalTail, m_activeTail};
+      for (DRRFlow *tail : tails)
+        {
+          if (!tail)
+            {
+              continue;
+            }
+          DRRFlow *f = tail;
+          do
+            {
+              f = f->GetNext ();
+              if (f != unclassified)
+                {
+                  m_migrationPending[f->GetIndex ()] = true;
+                  m_pendingFlows.push_back (f->GetIndex ());
+                }
+            }
+          while (f != tail);
+        }
+      NS_LOG_DEBUG ("New salt " << m_salt << ", " << m_pendingFlows.size () << " flows to migrate");
+    }
+
+  m_perturbEvent.Schedule (m_perturbPeriod);
+}
+
+void
+DRRQueueDisc::MigrateFlow (void)
+{
+  if (m_pendingFlows.empty ())
+    {
+      return;
+    }
+
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index = m_pendingFlows.front ();
+  m_pendingFlows.pop_front ();
+  if (!m_migrationPending[index])
+    {
+      // the flow has been released after being idle
+      return;
+    }
+  m_migrationPending[index] = false;
+
+  Ptr<DRRFlow> flow = StaticCast<DRRFlow> (GetQueueDiscClass (index));
+
+  // the packets going back into this flow queue are appended to it, hence
+  // moving as many packets as are queued now preserves their order
+  uint32_t n = flow->GetNPackets ();
+  StartMovingPackets ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<QueueDiscItem> item = flow->StealHeadPacket ();
+      if (!item)
+        {
+          break;
+        }
+      int32_t ret = Classify (item);
+      // the packet keeps its sojourn time
+      Time tstamp = item->GetTimeStamp ();
+      EnqueueIntoBucket (LookupBucket (ret, m_salt), ret, item);
+      item->SetTimeStamp (tstamp);
+    }
+  FinishMovingPackets ();
+
+  NS_LOG_DEBUG ("Migrated " << n << " packets of flow " << index << ", "
+                << m_pendingFlows.size () << " flows left");
+  UpdateBacklog (flow);
+
+  if (m_skipRounds && flow->GetStatus () == DRRFlow::ACTIVE && !m_latencyCritical[index])
+    {
+      CatchUpDeficit (flow);
+      UpdateEligibility (flow);
+    }
+}
+
+void
+DRRQueueDisc::PushActiveFlow (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  DRRFlow *f = PeekPointer (flow);
+  uint32_t index = f->GetIndex ();
+
+  if (m_skipRounds && m_servedFlow)
+    {
+      /* The flow whose turn is in progress is the last visited one, but it is
+       * still the head of the list of active flows, hence the new flow is
+       * inserted before it. The new flow is visited again when the visits reach
+       * its label, i.e., in the next round if its label is smaller than the label
+       * of the served flow */
+      DRRFlow *prev = m_servedFlow->GetPrev ();
+      AssignLabel (flow, prev);
+      f->SetNext (m_servedFlow);
+      f->SetPrev (prev);
+      prev->SetNext (f);
+      m_servedFlow->SetPrev (f);
+      m_nextRounds[index] = (m_labels[index] < m_labels[m_servedFlow->GetIndex ()]) ? m_round + 1 : m_round;
+      m_roundsHeapPositions[index] = m_roundsHeap.size ();
+      m_roundsHeap.push_back (index);
+      UpdateEligibility (flow);
+      return;
+    }
+
+  if (m_skipRounds)
+    {
+      AssignLabel (flow, m_activeTail);
+    }
+
+  if (!m_activeTail)
+    {
+      f->SetNext (f);
+      f->SetPrev (f);
+    }
+  else
+    {
+      f->SetNext (m_activeTail->GetNext ());
+      f->SetPrev (m_activeTail);
+      m_activeTail->GetNext ()->SetPrev (f);
+      m_activeTail->SetNext (f);
+    }
+  m_activeTail = f;
+
+  if (m_skipRounds)
+    {
+      // the new flow is the last visited one, and will be visited again in the next round
+      m_nextRounds[index] = m_round + 1;
+      m_roundsHeapPositions[index] = m_roundsHeap.size ();
+      m_roundsHeap.push_back (index);
+      UpdateEligibility (flow);
+    }
+}
+
+uint32_t
+DRRQueueDisc::LookupQuantum (uint32_t index, Ptr<const QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << index << item);
+
+  if (m_flowQuanta[index])
+    {
+      return m_flowQuanta[index];
+    }
+
+  uint8_t tos;
+  if (item->GetUint8Value (QueueItem::IP_DSFIELD, tos) && m_dscpQuanta[tos >> 2])
+    {
+      return m_dscpQuanta[tos >> 2];
+    }
+
+  return m_quantum;
+}
+
+bool
+DRRQueueDisc::LookupLatencyCritical (uint32_t index, Ptr<const QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << index << item);
+
+  if (m_flowLatencyCritical[index] >= 0)
+    {
+      return m_flowLatencyCritical[index];
+    }
+
+  uint8_t tos;
+  return item->GetUint8Value (QueueItem::IP_DSFIELD, tos) && m_dscpLatencyCritical[tos >> 2];
+}
+
+void
+DRRQueueDisc::PushLatencyCriticalFlow (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  DRRFlow *f = PeekPointer (flow);
+  m_latencyCritical[f->GetIndex ()] = true;
+
+  if (!m_latencyCriticalTail)
+    {
+      f->SetNext (f);
+      f->SetPrev (f);
+    }
+  else
+    {
+      f->SetNext (m_latencyCriticalTail->GetNext ());
+      f->SetPrev (m_latencyCriticalTail);
+      m_latencyCriticalTail->GetNext ()->SetPrev (f);
+      m_latencyCriticalTail->SetNext (f);
+    }
+  m_latencyCriticalTail = f;
+}
+
+void
+DRRQueueDisc::DemoteFlow (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  NS_LOG_DEBUG ("Latency-critical flow " << flow->GetIndex () << " holds more than one quantum, demoting it");
+  RemoveActiveFlow (flow);
+  flow->SetDeficit (0);
+  PushActiveFlow (flow);
+  m_nDemotedFlows++;
+}
+
+void
+DRRQueueDisc::RemoveActiveFlow (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  DRRFlow *f = PeekPointer (flow);
+  DRRFlow *prev = f->GetPrev ();
+
+  if (m_latencyCritical[f->GetIndex ()])
+    {
+      m_latencyCritical[f->GetIndex ()] = false;
+      if (prev == f)
+        {
+          m_latencyCriticalTail = 0;
+        }
+      else
+        {
+          prev->SetNext (f->GetNext ());
+          f->GetNext ()->SetPrev (prev);
+          if (f == m_latencyCriticalTail)
+            {
+              m_latencyCriticalTail = prev;
+            }
+        }
+      f->SetNext (0);
+      f->SetPrev (0);
+      return;
+    }
+
+  NS_ASSERT (m_activeTail);
+  if (f == m_servedFlow)
+    {
+      m_servedFlow = 0;
+    }
+
+  if (prev == f)
+    {
+      m_activeTail = 0;
+    }
+  else
+    {
+      prev->SetNext (f->GetNext ());
+      f->GetNext ()->SetPrev (prev);
+      if (f == m_activeTail)
+        {
+          // the previous flow becomes the last visited one. If it has the largest
+          // label, it was visited in the previous round
+          if (m_skipRounds && m_labels[prev->GetIndex ()] > m_labels[f->GetIndex ()])
+            {
+              m_round--;
+            }
+          m_activeTail = prev;
+        }
+    }
+  f->SetNext (0);
+  f->SetPrev (0);
+}
+
+void
+DRRQueueDisc::DeactivateFlow (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  NS_LOG_DEBUG ("Empty Flow, Setting it to INACTIVE");
+  RemoveActiveFlow (flow);
+  flow->SetDeficit (0);
+  flow->SetStatus (DRRFlow::INACTIVE);
+
+  if (!m_idleTimeout.IsZero ())
+    {
+      m_idleSince[flow->GetIndex ()] = Simulator::Now ();
+      m_idleFlows.push_back (std::make_pair (flow->GetIndex (), Simulator::Now ()));
+    }
+}
+
+void
+DRRQueueDisc::ReleaseIdleFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (!m_idleFlows.empty () && m_idleFlows.front ().second + m_idleTimeout <= Simulator::Now ())
+    {
+      uint32_t index = m_idleFlows.front ().first;
+      Time idleSince = m_idleFlows.front ().second;
+      m_idleFlows.pop_front ();
+
+      Ptr<DRRFlow> flow = StaticCast<DRRFlow> (GetQueueDiscClass (index));
+      if (flow->GetStatus () == DRRFlow::ACTIVE || m_idleSince[index] != idleSince)
+        {
+          // the flow has been active again since it was recorded
+          continue;
+        }
+
+      NS_LOG_DEBUG ("Releasing flow " << index << ", idle since " << idleSince);
+      // the queue disc of the flow may have dropped packets without notifying us
+      UpdateBacklog (flow);
+      NS_ASSERT (m_backlogs[index] == 0);
+      m_flowTable[m_buckets[index]] = 0;
+      // an empty flow has no packets to migrate
+      m_migrationPending[index] = false;
+      if (flow->GetQueueDisc ())
+        {
+          ReplaceQueueDiscClassChild (index, 0);
+        }
+      else
+        {
+          flow->GetQueue ()->Dispose ();
+          flow->SetQueue (0);
+        }
+      m_freeFlows.push_back (index);
+      m_nReleasedFlows++;
+    }
+}
+
+void
+DRRQueueDisc::AssignLabel (Ptr<DRRFlow> flow, DRRFlow *prev)
+{
+  NS_LOG_FUNCTION (this << flow << prev);
+
+  uint64_t low = 0;
+  uint64_t high = std::numeric_limits<uint64_t>::max ();
+
+  if (prev)
+    {
+      low = m_labels[prev->GetIndex ()];
+      uint64_t nextLabel = m_labels[prev->GetNext ()->GetIndex ()];
+      if (nextLabel > low)
+        {
+          high = nextLabel;
+        }
+      if (high - low < 2)
+        {
+          RelabelActiveFlows ();
+          AssignLabel (flow, prev);
+          return;
+        }
+    }
+
+  m_labels[flow->GetIndex ()] = low + (high - low) / 2;
+}
+
+void
+DRRQueueDisc::RelabelActiveFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_activeTail);
+
+  // start from the flow with the smallest label, so as to keep the order of the labels
+  DRRFlow *first = m_activeTail;
+  uint32_t n = 0;
+  DRRFlow *f = m_activeTail;
+  do
+    {
+      if (m_labels[f->GetIndex ()] < m_labels[first->GetIndex ()])
+        {
+          first = f;
+        }
+      f = f->GetNext ();
+      n++;
+    }
+  while (f != m_activeTail);
+
+  // leave room for a new flow after the last one
+  uint64_t spacing = std::numeric_limits<uint64_t>::max () / (n + 2);
+  uint64_t label = spacing;
+  f = first;
+  do
+    {
+      m_labels[f->GetIndex ()] = label;
+      label += spacing;
+      f = f->GetNext ();
+    }
+  while (f != first);
+}
+
+int64_t
+DRRQueueDisc::GetNVisits (uint32_t index) const
+{
+  NS_ASSERT (m_activeTail);
+
+  // the flows whose label is not larger than the label of the last visited flow
+  // have been visited in the current round, the others in the previous round
+  int64_t lastRound = (m_labels[index] <= m_labels[m_activeTail->GetIndex ()]) ? m_round : m_round - 1;
+  return lastRound - m_nextRounds[index] + 1;
+}
+
+void
+DRRQueueDisc::CatchUpDeficit (Ptr<DRRFlow> flow)
+{
+  uint32_t index = flow->GetIndex ();
+  int64_t visits = GetNVisits (index);
+  NS_ASSERT (visits >= 0);
+
+  // the deficit increases by one quantum at every visit
+  flow->IncreaseDeficit (visits * flow->GetQuantum ());
+  flow->m_stats.nRoundsWaited += visits;
+  m_nextRounds[index] += visits;
+}
+
+void
+DRRQueueDisc::UpdateEligibility (Ptr<DRRFlow> flow)
+{
+  uint32_t index = flow->GetIndex ();
+
+  Ptr<const QueueDiscItem> item = flow->Peek ();
+  UpdateBacklog (flow);
+
+  // number of visits needed to send the head packet (an empty flow is removed
+  // at the next visit). The flow whose turn is in progress needs no further
+  // visit if its deficit covers its head packet or it is empty
+  int64_t visits = 1;
+  uint32_t deficit = flow->GetDeficit ();
+  uint32_t quantum = flow->GetQuantum ();
+  if (PeekPointer (flow) == m_servedFlow && (!item || item->GetSize () <= deficit))
+    {
+      visits = 0;
+    }
+  else if (item && item->GetSize () > deficit + quantum)
+    {
+      visits = (item->GetSize () - deficit + quantum - 1) / quantum;
+    }
+  m_eligibleRounds[index] = m_nextRounds[index] + visits - 1;
+  RoundsHeapFix (m_roundsHeapPositions[index]);
+}
+
+bool
+DRRQueueDisc::EligibleBefore (uint32_t a, uint32_t b) const
+{
+  // within a round, flows are visited in the order of their labels
+  return m_eligibleRounds[a] < m_eligibleRounds[b]
+         || (m_eligibleRounds[a] == m_eligibleRounds[b] && m_labels[a] < m_labels[b]);
+}
+
+void
+DRRQueueDisc::RoundsHeapSwap (uint32_t i, uint32_t j)
+{
+  std::swap (m_roundsHeap[i], m_roundsHeap[j]);
+  m_roundsHeapPositions[m_roundsHeap[i]] = i;
+  m_roundsHeapPositions[m_roundsHeap[j]] = j;
+}
+
+void
+DRRQueueDisc::RoundsHeapFix (uint32_t pos)
+{
+  // sift up
+  while (pos > 0)
+    {
+      uint32_t parent = (pos - 1) / 2;
+      if (!EligibleBefore (m_roundsHeap[pos], m_roundsHeap[parent]))
+        {
+          break;
+        }
+      RoundsHeapSwap (pos, parent);
+      pos = parent;
+    }
+
+  // sift down
+  uint32_t size = m_roundsHeap.size ();
+  while (true)
+    {
+      uint32_t first = pos;
+      uint32_t left = 2 * pos + 1;
+      uint32_t right = left + 1;
+      if (left < size && EligibleBefore (m_roundsHeap[left], m_roundsHeap[first]))
+        {
+          first = left;
+        }
+      if (right < size && EligibleBefore (m_roundsHeap[right], m_roundsHeap[first]))
+        {
+          first = right;
+        }
+      if (first == pos)
+        {
+          break;
+        }
+      RoundsHeapSwap (pos, first);
+      pos = first;
+    }
+}
+
+void
+DRRQueueDisc::RoundsHeapRemove (uint32_t index)
+{
+  uint32_t pos = m_roundsHeapPositions[index];
+  uint32_t last = m_roundsHeap.size () - 1;
+  if (pos != last)
+    {
+      RoundsHeapSwap (pos, last);
+      m_roundsHeap.pop_back ();
+      RoundsHeapFix (pos);
+    }
+  else
+    {
+      m_roundsHeap.pop_back ();
+    }
+}
+
+void
+DRRQueueDisc::AddToBacklogHeap (Ptr<DRRFlow> flow)
+{
+  NS_LOG_FUNCTION (this << flow);
+
+  uint32_t index = flow->GetIndex ();
+  NS_ASSERT (index == m_backlogs.size ());
+
+  // a new flow has no backlog and the largest class index, hence it belongs
+  // to the bottom of the heap
+  m_backlogs.push_back (0);
+  m_heapPositions.push_back (m_backlogHeap.size ());
+  m_backlogHeap.push_back (index);
+}
+
+void
+DRRQueueDisc::UpdateBacklog (Ptr<DRRFlow> flow)
+{
+  uint32_t index = flow->GetIndex ();
+  uint32_t backlog = flow->GetNBytes ();
+  uint32_t oldBacklog = m_backlogs[index];
+
+  if (backlog == oldBacklog)
+    {
+      return;
+    }
+
+  m_backlogs[index] = backlog;
+  if (backlog > flow->m_stats.maxBacklog)
+    {
+      flow->m_stats.maxBacklog = backlog;
+    }
+  uint32_t pos = m_heapPositions[index];
+
+  if (backlog > oldBacklog)
+    {
+      // sift up
+      while (pos > 0)
+        {
+          uint32_t parent = (pos - 1) / 2;
+          if (!BacklogGreater (m_backlogHeap[pos], m_backlogHeap[parent]))
+            {
+              break;
+            }
+          BacklogHeapSwap (pos, parent);
+          pos = parent;
+        }
+    }
+  else
+    {
+      // sift down
+      uint32_t size = m_backlogHeap.size ();
+      while (true)
+        {
+          uint32_t largest = pos;
+          uint32_t left = 2 * pos + 1;
+          uint32_t right = left + 1;
+          if (left < size && BacklogGreater (m_backlogHeap[left], m_backlogHeap[largest]))
+            {
+              largest = left;
+            }
+          if (right < size && BacklogGreater (m_backlogHeap[right], m_backlogHeap[largest]))
+            {
+              largest = right;
+            }
+          if (largest == pos)
+            {
+              break;
+            }
+          BacklogHeapSwap (pos, largest);
+          pos = largest;
+        }
+    }
+}
+
+bool
+DRRQueueDisc::BacklogGreater (uint32_t a, uint32_t b) const
+{
+  // ties are broken in favor of the flow created first, which is the one
+  // a linear scan of the classes would select
+  return m_backlogs[a] > m_backlogs[b] || (m_backlogs[a] == m_backlogs[b] && a < b);
+}
+
+void
+DRRQueueDisc::BacklogHeapSwap (uint32_t i, uint32_t j)
+{
+  std::swap (m_backlogHeap[i], m_backlogHeap[j]);
+  m_heapPositions[m_backlogHeap[i]] = i;
+  m_heapPositions[m_backlogHeap[j]] = j;
+}
+
 } // namespace ns3
@@ -25,11 +25,16 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
-#include <list>
-#include <map>
+#include "ns3/nstime.h"
+#include "ns3/queue-disc-timer.h"
+#include <vector>
+#include <deque>
+#include <ostream>
 
 namespace ns3 {
 
+class UniformRandomVariable;
+
 /**
 * \ingroup traffic-control
 *
@@ -45,6 +50,32 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /// \brief Structure that keeps the statistics of a flow
+  struct Stats
+  {
+    /// Packets dequeued from the flow
+    uint64_t nServedPackets;
+    /// Bytes dequeued from the flow
+    uint64_t nServedBytes;
+    /// Packets stolen from the flow, i.e., dropped because the byte limit was exceeded
+    uint32_t nStolenPackets;
+    /// Bytes stolen from the flow
+    uint64_t nStolenBytes;
+    /// Largest backlog of the flow, in bytes
+    uint32_t maxBacklog;
+    /// Rounds in which the flow was visited while active, i.e., quanta it received
+    uint64_t nRoundsWaited;
+
+    /// constructor
+    Stats ();
+
+    /**
+     * \brief Print the statistics.
+     * \param os output stream in which the data should be printed.
+     */
+    void Print (std::ostream &os) const;
+  };
+
 
   /**
    * \brief DRRFlow constructor
@@ -100,11 +131,154 @@ public:
   FlowStatus GetStatus (void) const;
 
 
+  /**
+   * \brief Set the index of this flow among the classes of the queue disc
+   * \param index the index of this flow
+   */
+  void SetIndex (uint32_t index);
+
+
+  /**
+   * \brief Get the index of this flow among the classes of the queue disc
+   * \return the index of this flow
+   */
+  uint32_t GetIndex (void) const;
+
+
+  /**
+   * \brief Set the flow following this one in the list of active flows
+   * \param next the next active flow
+   */
+  void SetNext (DRRFlow *next);
+
+
+  /**
+   * \brief Get the flow following this one in the list of active flows
+   * \return the next active flow
+   */
+  DRRFlow* GetNext (void) const;
+
+
+  /**
+   * \brief Set the flow preceding this one in the list of active flows
+   * \param prev the previous active flow
+   */
+  void SetPrev (DRRFlow *prev);
+
+
+  /**
+   * \brief Get the flow preceding this one in the list of active flows
+   * \return the previous active flow
+   */
+  DRRFlow* GetPrev (void) const;
+
+
+  /**
+   * \brief Set the quantum of this flow
+   * \param quantum the number of bytes this flow can send in each round
+   */
+  void SetQuantum (uint32_t quantum);
+
+
+  /**
+   * \brief Get the quantum of this flow
+   * \return the number of bytes this flow can send in each round
+   */
+  uint32_t GetQuantum (void) const;
+
+
+  /**
+   * \brief Get the statistics of this flow
+   * \return the statistics of this flow
+   */
+  const Stats& GetStats (void) const;
+
+
+  /**
+   * \brief Set the queue storing the packets of this flow, which then has no queue disc
+   * \param queue the queue, or 0 if the flow has no queue
+   */
+  void SetQueue (Ptr<QueueDisc::InternalQueue> queue);
+
+
+  /**
+   * \brief Get the queue storing the packets of this flow
+   * \return the queue, or 0 if the packets are stored by the queue disc of the flow
+   */
+  Ptr<QueueDisc::InternalQueue> GetQueue (void) const;
+
+
+  /**
+   * \brief Enqueue a packet into the queue or, if none, the queue disc of this flow
+   * \param item the packet
+   */
+  void Enqueue (Ptr<QueueDiscItem> item);
+
+
+  /**
+   * \brief Dequeue the head packet of this flow
+   * \return the head packet, or 0 if the flow is empty
+   */
+  Ptr<QueueDiscItem> Dequeue (void);
+
+
+  /**
+   * \brief Peek the head packet of this flow
+   * \return the head packet, or 0 if the flow is empty
+   */
+  Ptr<const QueueDiscItem> Peek (void) const;
+
+
+  /**
+   * \brief Remove the head packet of this flow, bypassing its queue disc
+   * \return the head packet, or 0 if the flow is empty
+   */
+  Ptr<QueueDiscItem> StealHeadPacket (void);
+
+
+  /**
+   * \brief Get the number of packets of this flow
+   * \return the number of packets stored by the queue or the queue disc of this flow
+   */
+  uint32_t GetNPackets (void) const;
+
+
+  /**
+   * \brief Get the backlog of this flow
+   * \return the number of bytes stored by the queue or the queue disc of this flow
+   */
+  uint32_t GetNBytes (void) const;
+
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+
 private:
+  friend class DRRQueueDisc;   // the queue disc updates the statistics of its flows
+
   uint32_t m_deficit;   //!< the deficit for this flow
   FlowStatus m_status; //!< the status of this flow
+  uint32_t m_index;     //!< the index of this flow among the queue disc classes
+  DRRFlow *m_next;      //!< the next flow in the list of active flows
+  DRRFlow *m_prev;      //!< the previous flow in the list of active flows
+  uint32_t m_quantum;   //!< the number of bytes this flow can send in each round
+  Stats m_stats;        //!< the statistics of this flow
+  Ptr<QueueDisc::InternalQueue> m_queue;  //!< the queue of this flow, if it has no queue disc
 };
 
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param os the stream
+ * \param stats the flow statistics
+ * \returns a reference to the stream
+ */
+std::ostream & operator << (std::ostream &os, const DRRFlow::Stats &stats);
+
 
 /**
 * \ingroup traffic-control
@@ -120,6 +294,26 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// \brief Structure that keeps a snapshot of the state and statistics of a flow
+  struct FlowSnapshot
+  {
+    /// Index of the flow among the classes of the queue disc
+    uint32_t index;
+    /// Hash bucket of the flow
+    uint32_t bucket;
+    /// Status of the flow
+    DRRFlow::FlowStatus status;
+    /// Whether the flow is in the list of latency-critical flows
+    bool latencyCritical;
+    /// Deficit of the flow (not brought up to date when skipping rounds)
+    int32_t deficit;
+    /// Backlog of the flow, in bytes
+    uint32_t backlog;
+    /// Statistics of the flow
+    DRRFlow::Stats stats;
+  };
+
   /**
    * \brief DRRQueueDisc constructor
    */
@@ -143,36 +337,458 @@ public:
  */
   uint32_t GetQuantum (void) const;
 
+
+  /**
+ * \brief Set the quantum of the flow queue with the given index.
+ *
+ * The index of the flow queue of a packet is the value returned by the packet
+ * filter modulo the number of flows (the packets that cannot be classified go
+ * into the flow queue whose index equals the number of flows). This quantum
+ * takes precedence over the one set for the DSCP of the packets.
+ *
+ * \param index The index of the flow queue
+ * \param quantum The number of bytes the flow queue gets to dequeue on each round, or 0 to remove the setting
+ */
+  void SetFlowQuantum (uint32_t index, uint32_t quantum);
+
+
+  /**
+ * \brief Set the quantum of the flow queues whose packets carry the given DSCP.
+ *
+ * The quantum of a flow queue is determined by the packet that makes it active,
+ * and is kept until the flow queue becomes inactive.
+ *
+ * \param dscp The DSCP value (the six most significant bits of the DS field)
+ * \param quantum The number of bytes the flow queue gets to dequeue on each round, or 0 to remove the setting
+ */
+  void SetDscpQuantum (uint8_t dscp, uint32_t quantum);
+
+
+  /**
+ * \brief Mark the flow queue with the given index as latency-critical.
+ *
+ * As in the DRR+ variant of DRR (M. Shreedhar and G. Varghese, "Efficient Fair
+ * Queuing Using Deficit Round-Robin", IEEE/ACM Transactions on Networking, 1996),
+ * latency-critical flow queues are served from a separate list, which takes
+ * precedence over the list of active flows, one packet per turn. A latency-critical
+ * flow queue is demoted to a regular flow queue, until it becomes inactive, as soon
+ * as it holds more than one quantum. The index of a flow queue is defined as in
+ * SetFlowQuantum. This setting takes precedence over the one set for the DSCP of the packets.
+ *
+ * \param index The index of the flow queue
+ * \param latencyCritical Whether the flow queue is latency-critical
+ */
+  void SetFlowLatencyCritical (uint32_t index, bool latencyCritical);
+
+
+  /**
+ * \brief Mark the flow queues whose packets carry the given DSCP as latency-critical.
+ *
+ * Whether a flow queue is latency-critical is determined by the packet that
+ * makes it active, as its quantum.
+ *
+ * \param dscp The DSCP value (the six most significant bits of the DS field)
+ * \param latencyCritical Whether the flow queues are latency-critical
+ */
+  void SetDscpLatencyCritical (uint8_t dscp, bool latencyCritical);
+
+
+  /**
+ * \brief Get the number of times a latency-critical flow queue has been demoted
+ *
+ * \returns The number of latency-critical flow queues demoted for holding more than one quantum
+ */
+  uint32_t GetNDemotedFlows (void) const;
+
+  /**
+ * \brief Get the number of flow queues released after being idle
+ *
+ * \returns The number of flow queues whose queue disc has been released for being inactive longer than IdleTimeout
+ */
+  uint32_t GetNReleasedFlows (void) const;
+
+  /**
+   * \brief Get an estimate of the memory used by this queue disc
+   *
+   * Adds to the memory accounted for by the base class the per-flow state of DRR.
+   *
+   * \return the estimated number of bytes used by this queue disc
+   */
+  virtual std::size_t GetMemoryFootprint (void) const;
+
+  /**
+   * \brief Get a snapshot of the state and statistics of the flows
+   *
+   * The statistics of a flow released after being idle are reset when the flow
+   * is reused for a new flow.
+   *
+   * \return a snapshot of every flow, by class index
+   */
+  std::vector<FlowSnapshot> GetFlowsSnapshot (void) const;
+
+  /**
+   * \brief Get the Jain's fairness index of the bytes served to the flows
+   *
+   * The index is (sum x_i)^2 / (n * sum x_i^2), where x_i is the number of bytes
+   * dequeued from the i-th of the n flows that have been served. It ranges from
+   * 1/n, if a single flow has been served, to 1, if all the flows have been
+   * served the same number of bytes.
+   *
+   * \return the fairness index, or 0 if no flow has been served
+   */
+  double GetJainFairnessIndex (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
   // Reasons for dropping packets
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
 
 
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
 private:
   virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue (void);
-  virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+  virtual Ptr<const QueueDiscItem> DoPeek (void);
   virtual bool CheckConfig (void);
   virtual void InitializeParams (void);
+  virtual bool IsMultiQueueAware (void) const;
 
   /**
-   * \brief Drop a packet from the tail of the queue with the largest current byte count (Packet Stealing)
+   * \brief Check whether the device transmission queue of a flow is stopped
+   * \param flow the flow
+   * \return true if the transmission queue the packets of the flow are sent to is stopped
+   */
+  bool IsTxQueueStopped (const DRRFlow *flow) const;
+
+  /**
+   * \brief Drop packets from the head of the queue with the largest current byte
+   *        count (Packet Stealing), until either half of its backlog or DropBatchSize
+   *        packets have been dropped
    * \return the index of the queue with the largest current byte count
    */
   uint32_t DRRDrop (void);
 
+  /**
+   * \brief Map the value returned by the packet filters to a hash bucket
+   * \param ret the value returned by the packet filters
+   * \param salt the salt of the hash function, or 0 to take the value modulo the number of flows
+   * \return the hash bucket
+   */
+  uint32_t GetBucket (int32_t ret, uint32_t salt) const;
+
+  /**
+   * \brief Find the hash bucket of a packet. In a set-associative flow table,
+   *        this is the way of the set of the packet that is allocated to its
+   *        flow or, if none, a free way. If all the ways are allocated to other
+   *        flows, the packet collides in the way given by the hash
+   * \param ret the value returned by the packet filters
+   * \param salt the salt of the hash function
+   * \return the hash bucket
+   */
+  uint32_t LookupBucket (int32_t ret, uint32_t salt) const;
+
+  /**
+   * \brief Enqueue a packet into the flow queue of a hash bucket, creating and
+   *        activating the flow queue if needed
+   * \param h the hash bucket
+   * \param ret the value returned by the packet filters
+   * \param item the packet
+   */
+  void EnqueueIntoBucket (uint32_t h, int32_t ret, Ptr<QueueDiscItem> item);
+
+  /**
+   * \brief Change the salt of the hash function and schedule the migration of
+   *        the packets of the active flows, as in the SFQ perturbation
+   */
+  void Perturb (void);
+
+  /**
+   * \brief Move the packets of a flow queue classified with the previous salt
+   *        into the flow queues given by the current salt
+   */
+  void MigrateFlow (void);
+
+  /**
+   * \brief Append a flow to the tail of the list of active flows
+   * \param flow the flow to append
+   */
+  void PushActiveFlow (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Look up the quantum of a flow queue that is becoming active
+   * \param index the index of the flow queue
+   * \param item the packet that makes the flow queue active
+   * \return the quantum of the flow queue
+   */
+  uint32_t LookupQuantum (uint32_t index, Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Look up whether a flow queue that is becoming active is latency-critical
+   * \param index the index of the flow queue
+   * \param item the packet that makes the flow queue active
+   * \return true if the flow queue is latency-critical
+   */
+  bool LookupLatencyCritical (uint32_t index, Ptr<const QueueDiscItem> item) const;
+
+  /**
+   * \brief Append a flow to the tail of the list of latency-critical flows
+   * \param flow the flow to append
+   */
+  void PushLatencyCriticalFlow (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Move a latency-critical flow holding more than one quantum to the
+   *        tail of the list of active flows
+   * \param flow the flow to demote
+   */
+  void DemoteFlow (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Select the flow whose head packet is to be dequeued next, updating
+   *        the state of the scheduler as a dequeue request would do up to the
+   *        dequeue of the packet itself, whose head packet is then peeked
+   * \return the selected flow, or 0 if no packet can be dequeued
+   */
+  DRRFlow* SelectFlow (void);
+
+  /**
+   * \brief Select the first latency-critical flow whose transmission queue is
+   *        not stopped and which holds packets
+   * \return the selected flow, or 0 if none
+   */
+  DRRFlow* SelectLatencyCriticalFlow (void);
+
+  /**
+   * \brief Remove a flow from the list of active flows or, if it is
+   *        latency-critical, from the list of latency-critical flows
+   * \param flow the flow to remove
+   */
+  void RemoveActiveFlow (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Set an empty flow as inactive, recording the time it became idle
+   *        if idle flows are released
+   * \param flow the flow that has become empty
+   */
+  void DeactivateFlow (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Release the queue disc or the queue of the flows that have been
+   *        inactive for at least IdleTimeout, and free their hash buckets. The
+   *        released flows are reused (with a new queue disc or queue) when new
+   *        flows are created
+   */
+  void ReleaseIdleFlows (void);
+
+  /**
+   * \brief Directly select the flow that the round robin would serve next,
+   *        without visiting the other flows one at a time
+   * \return the selected flow, or 0 if no packet can be dequeued
+   */
+  DRRFlow* SelectSkippingRounds (void);
+
+  /**
+   * \brief Assign to a flow being inserted in the list of active flows a label
+   *        that is larger than the label of the flow it follows and smaller than
+   *        the label of the flow it precedes (unless the latter has the smallest label)
+   * \param flow the flow being inserted
+   * \param prev the flow that the inserted flow follows, or 0 if the list is empty
+   */
+  void AssignLabel (Ptr<DRRFlow> flow, DRRFlow *prev);
+
+  /**
+   * \brief Spread evenly the labels of the active flows, keeping their order
+   */
+  void RelabelActiveFlows (void);
+
+  /**
+   * \brief Get the number of times a flow has been visited since the last time
+   *        its deficit was brought up to date
+   * \param index the class index of the flow
+   * \return the number of visits
+   */
+  int64_t GetNVisits (uint32_t index) const;
+
+  /**
+   * \brief Bring the deficit of a flow up to date, by adding one quantum per visit
+   * \param flow the flow
+   */
+  void CatchUpDeficit (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Compute the round in which a flow will be able to send its head
+   *        packet and restore the heap property
+   * \param flow the flow, whose deficit must be up to date
+   */
+  void UpdateEligibility (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Compare two flows by the round in which they become eligible,
+   *        breaking ties by their position in the list of active flows
+   * \param a the class index of the first flow
+   * \param b the class index of the second flow
+   * \return true if the first flow is served before the second one
+   */
+  bool EligibleBefore (uint32_t a, uint32_t b) const;
+
+  /**
+   * \brief Swap two entries of the rounds heap
+   * \param i the position of the first entry
+   * \param j the position of the second entry
+   */
+  void RoundsHeapSwap (uint32_t i, uint32_t j);
+
+  /**
+   * \brief Restore the heap property for an entry of the rounds heap
+   * \param pos the position of the entry
+   */
+  void RoundsHeapFix (uint32_t pos);
+
+  /**
+   * \brief Remove a flow from the rounds heap
+   * \param index the class index of the flow
+   */
+  void RoundsHeapRemove (uint32_t index);
+
+  /**
+   * \brief Add a newly created flow to the backlog heap
+   * \param flow the flow to add
+   */
+  void AddToBacklogHeap (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Refresh the backlog of a flow and restore the heap property
+   * \param flow the flow whose backlog may have changed
+   */
+  void UpdateBacklog (Ptr<DRRFlow> flow);
+
+  /**
+   * \brief Compare two flows by backlog, breaking ties by class index
+   * \param a the class index of the first flow
+   * \param b the class index of the second flow
+   * \return true if the first flow must be closer to the top of the heap
+   */
+  bool BacklogGreater (uint32_t a, uint32_t b) const;
+
+  /**
+   * \brief Swap two entries of the backlog heap
+   * \param i the position of the first entry
+   * \param j the position of the second entry
+   */
+  void BacklogHeapSwap (uint32_t i, uint32_t j);
+
   uint32_t m_packets;      //!< cumulative sum of packets across all flows
   uint32_t m_limit;              //!< Maximum number of bytes in the queue disc
   uint32_t m_quantum;        //!< total number of bytes that a flow can send
   uint32_t m_flows;          //!< Number of flow queues
+  uint32_t m_ways;           //!< Number of ways of each set of the flow table
+  uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
+  bool m_skipRounds;         //!< True to directly select the next flow to serve
+  bool m_lightweightFlows;   //!< True to store the packets of each flow in a queue instead of a queue disc
+  Time m_perturbPeriod;      //!< Period of the hash salt changes (0 to disable)
+  Time m_idleTimeout;        //!< Time after which an inactive flow is released (0 to disable)
+  uint32_t m_nTxQueues;      //!< Number of device transmission queues the flows are mapped to
+  bool m_selectTxQueue;      //!< True if the device selects the transmission queue of the packets
+
+
+  /**
+   * The active flows form a circular list threaded through the flows themselves,
+   * so that appending, removing and rotating flows do not allocate memory. Only
+   * the tail is stored, the head being the flow that follows the tail.
+   */
+  DRRFlow *m_activeTail;
+
+  /**
+   * A flow keeps being served as long as its deficit covers its head packet.
+   * This is the flow whose turn is in progress, i.e., the head of the list of
+   * active flows (or the last visited flow, when skipping rounds), if any.
+   */
+  DRRFlow *m_servedFlow;
 
+  /**
+   * The flow selected to be served next by a peek request, which is served by
+   * the next dequeue request unless an enqueue request comes first, and its
+   * head packet.
+   */
+  DRRFlow *m_nextFlow;
+  Ptr<const QueueDiscItem> m_nextItem;   //!< The head packet of the flow selected by a peek request
 
-  std::list<Ptr<DRRFlow> > m_flowList;    //!< The list of flows
+  /**
+   * The latency-critical flows form another circular list, threaded through the
+   * flows as the list of active flows (a flow is in at most one of the lists).
+   * Only the tail is stored.
+   */
+  DRRFlow *m_latencyCriticalTail;
+  uint32_t m_nDemotedFlows;                  //!< Number of latency-critical flows demoted
+
+  std::vector<Ptr<DRRFlow> > m_flowTable;    //!< The flow of each hash bucket (null if not yet created)
+  std::vector<uint32_t> m_flowQuanta;        //!< The quantum of each hash bucket (0 if not set)
+  std::vector<uint32_t> m_dscpQuanta;        //!< The quantum of each DSCP value (0 if not set)
+  std::vector<int8_t> m_flowLatencyCritical; //!< Whether each hash bucket is latency-critical (-1 if not set)
+  std::vector<bool> m_dscpLatencyCritical;   //!< Whether each DSCP value is latency-critical
+  std::vector<bool> m_latencyCritical;       //!< Whether each flow is in the list of latency-critical flows, by class index
+  std::vector<int32_t> m_flowIds;            //!< Filter value of the packet that activated each flow (the tag of its way), by class index
+  std::vector<uint8_t> m_txQueues;           //!< Device transmission queue of each flow, by class index
+  std::vector<uint32_t> m_buckets;           //!< Hash bucket of each flow, by class index
 
-  std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  /**
+   * Inactive flows are released, in the order they became inactive, when they
+   * have been idle for IdleTimeout. A record is stale if the flow has been
+   * active again since, in which case its idle time has changed.
+   */
+  std::deque<std::pair<uint32_t, Time> > m_idleFlows;
+  std::vector<Time> m_idleSince;             //!< Time each inactive flow became idle, by class index
+  std::vector<uint32_t> m_freeFlows;         //!< Class indices of the released flows
+  uint32_t m_nReleasedFlows;                 //!< Number of flows released after being idle
+
+  /**
+   * When the salt changes, the packets queued in the flows that are active
+   * are classified with the previous salt. These flows are migrated one per
+   * enqueue or dequeue operation, and the packets of their flows keep being
+   * enqueued into them until then, so as not to be reordered.
+   */
+  uint32_t m_salt;
+  uint32_t m_oldSalt;                        //!< The salt before the last change
+  std::vector<bool> m_migrationPending;      //!< Whether each flow still has to be migrated, by class index
+  std::deque<uint32_t> m_pendingFlows;       //!< Class indices of the flows still to be migrated
+  QueueDiscTimer m_perturbEvent;             //!< Timer changing the salt
+  Ptr<UniformRandomVariable> m_uv;           //!< Rng stream drawing the salt
+
+  std::vector<uint32_t> m_backlogs;       //!< Backlog in bytes of each flow, by class index
+  std::vector<uint32_t> m_backlogHeap;    //!< Max-heap of class indices ordered by backlog
+  std::vector<uint32_t> m_heapPositions;  //!< Position in the backlog heap of each flow, by class index
+
+  /**
+   * When skipping rounds, the active flows are visited in the order of their
+   * labels, a round ending when the flow with the largest label is visited.
+   * The tail of the list of active flows is the last visited flow and m_round
+   * is the round of that visit. Deficits are only brought up to date when a
+   * flow is served or its head packet changes, while the flows that are
+   * merely visited are left untouched.
+   */
+  int64_t m_round;
+  std::vector<uint64_t> m_labels;          //!< Position of each flow in the list of active flows, by class index
+  std::vector<int64_t> m_nextRounds;       //!< Round of the next visit to each flow, by class index
+  std::vector<int64_t> m_eligibleRounds;   //!< Round in which each flow can send its head packet, by class index
+  std::vector<uint32_t> m_roundsHeap;      //!< Min-heap of the class indices of the active flows, ordered by eligibility
+  std::vector<uint32_t> m_roundsHeapPositions;  //!< Position in the rounds heap of each flow, by class index
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
-  ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
+  ObjectFactory m_queueDiscFactory; //!< Factory to create the queue disc of a new flow
 };
 
 } // namespace ns3
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "fifo-queue-disc.h"
 #include "ns3/object-factory.h"
 #include "ns3/drop-tail-queue.h"
@@ -42,6 +43,8 @@ TypeId FifoQueueDisc::GetTypeId (void)
                                           &QueueDisc::GetMaxSize),
                    MakeQueueSizeChecker ())
   ;
+  static const bool reasonsRegistered = RegisterReasons ({LIMIT_EXCEEDED_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -20,8 +20,10 @@
 */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/string.h"
 #include "ns3/queue.h"
+#include "ns3/simulator.h"
 #include "fq-codel-queue-disc.h"
 #include "codel-queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
@@ -44,7 +46,8 @@ TypeId FqCoDelFlow::GetTypeId (void)
 
 FqCoDelFlow::FqCoDelFlow ()
   : m_deficit (0),
-    m_status (INACTIVE)
+    m_status (INACTIVE),
+    m_index (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -89,6 +92,19 @@ FqCoDelFlow::GetStatus (void) const
   return m_status;
 }
 
+void
+FqCoDelFlow::SetIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_index = index;
+}
+
+uint32_t
+FqCoDelFlow::GetIndex (void) const
+{
+  return m_index;
+}
+
 
 NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueueDisc);
 
@@ -129,7 +145,16 @@ TypeId FqCoDelQueueDisc::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&FqCoDelQueueDisc::m_perturbation),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("IdleTimeout",
+                   "The time after which the queue disc of an inactive flow queue is "
+                   "released (0 to never release them). The released flow queues are "
+                   "reused for new flows",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FqCoDelQueueDisc::m_idleTimeout),
+                   MakeTimeChecker ())
   ;
+  static const bool reasonsRegistered = RegisterReasons ({UNCLASSIFIED_DROP, OVERLIMIT_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -158,11 +183,29 @@ FqCoDelQueueDisc::GetQuantum (void) const
   return m_quantum;
 }
 
+std::size_t
+FqCoDelQueueDisc::GetMemoryFootprint (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // the nodes of a map store the colour and three pointers besides the value,
+  // the nodes of a list two pointers
+  return QueueDisc::GetMemoryFootprint () + sizeof (FqCoDelQueueDisc) - sizeof (QueueDisc)
+    + GetNQueueDiscClasses () * (sizeof (FqCoDelFlow) - sizeof (QueueDiscClass))
+    + m_flowsIndices.size () * (sizeof (std::pair<const uint32_t, uint32_t>) + 4 * sizeof (void*))
+    + (m_newFlows.size () + m_oldFlows.size ()) * (sizeof (Ptr<FqCoDelFlow>) + 2 * sizeof (void*))
+    + m_buckets.capacity () * sizeof (uint32_t)
+    + m_idleSince.capacity () * sizeof (Time)
+    + m_freeFlows.capacity () * sizeof (uint32_t)
+    + m_idleFlows.size () * sizeof (std::pair<uint32_t, Time>);
+}
+
 bool
 FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
 
+  ReleaseIdleFlows ();
+
   uint32_t h = 0;
 
   if (GetNPacketFilters () == 0)
@@ -188,14 +231,30 @@ FqCoDelQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   Ptr<FqCoDelFlow> flow;
   if (m_flowsIndices.find (h) == m_flowsIndices.end ())
     {
-      NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
-      flow = m_flowFactory.Create<FqCoDelFlow> ();
       Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc> ();
       qd->Initialize ();
-      flow->SetQueueDisc (qd);
-      AddQueueDiscClass (flow);
 
-      m_flowsIndices[h] = GetNQueueDiscClasses () - 1;
+      if (!m_freeFlows.empty ())
+        {
+          // reuse a flow released after being idle
+          flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (m_freeFlows.back ()));
+          m_freeFlows.pop_back ();
+          NS_LOG_DEBUG ("Reusing the released flow with index " << flow->GetIndex () << " for flow queue " << h);
+          ReplaceQueueDiscClassChild (flow->GetIndex (), qd);
+          m_buckets[flow->GetIndex ()] = h;
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Creating a new flow queue with index " << h);
+          flow = m_flowFactory.Create<FqCoDelFlow> ();
+          flow->SetQueueDisc (qd);
+          AddQueueDiscClass (flow);
+          flow->SetIndex (GetNQueueDiscClasses () - 1);
+          m_buckets.push_back (h);
+          m_idleSince.push_back (Seconds (0));
+        }
+
+      m_flowsIndices[h] = flow->GetIndex ();
     }
   else
     {
@@ -289,6 +348,11 @@ FqCoDelQueueDisc::DoDequeue (void)
             {
               flow->SetStatus (FqCoDelFlow::INACTIVE);
               m_oldFlows.pop_front ();
+              if (!m_idleTimeout.IsZero ())
+                {
+                  m_idleSince[flow->GetIndex ()] = Simulator::Now ();
+                  m_idleFlows.push_back (std::make_pair (flow->GetIndex (), Simulator::Now ()));
+                }
             }
         }
       else
@@ -367,6 +431,11 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   for (uint32_t i = 0; i < GetNQueueDiscClasses (); i++)
     {
       qd = GetQueueDiscClass (i)->GetQueueDisc ();
+      if (!qd)
+        {
+          // released flow
+          continue;
+        }
       uint32_t bytes = qd->GetNBytes ();
       if (bytes > maxBacklog)
         {
@@ -390,4 +459,29 @@ FqCoDelQueueDisc::FqCoDelDrop (void)
   return index;
 }
 
+void
+FqCoDelQueueDisc::ReleaseIdleFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (!m_idleFlows.empty () && m_idleFlows.front ().second + m_idleTimeout <= Simulator::Now ())
+    {
+      uint32_t index = m_idleFlows.front ().first;
+      Time idleSince = m_idleFlows.front ().second;
+      m_idleFlows.pop_front ();
+
+      Ptr<FqCoDelFlow> flow = StaticCast<FqCoDelFlow> (GetQueueDiscClass (index));
+      if (flow->GetStatus () != FqCoDelFlow::INACTIVE || m_idleSince[index] != idleSince)
+        {
+          // the flow has been active again since it was recorded
+          continue;
+        }
+
+      NS_LOG_DEBUG ("Releasing flow " << index << ", idle since " << idleSince);
+      m_flowsIndices.erase (m_buckets[index]);
+      ReplaceQueueDiscClassChild (index, 0);
+      m_freeFlows.push_back (index);
+    }
+}
+
 } // namespace ns3
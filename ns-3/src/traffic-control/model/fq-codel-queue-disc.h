@@ -24,8 +24,11 @@
 
 #include "ns3/queue-disc.h"
 #include "ns3/object-factory.h"
+#include "ns3/nstime.h"
 #include <list>
 #include <map>
+#include <deque>
+#include <vector>
 
 namespace ns3 {
 
@@ -85,10 +88,21 @@ public:
    * \return the status of this flow
    */
   FlowStatus GetStatus (void) const;
+  /**
+   * \brief Set the index of this flow among the classes of the queue disc
+   * \param index the index of this flow
+   */
+  void SetIndex (uint32_t index);
+  /**
+   * \brief Get the index of this flow among the classes of the queue disc
+   * \return the index of this flow
+   */
+  uint32_t GetIndex (void) const;
 
 private:
   int32_t m_deficit;    //!< the deficit for this flow
   FlowStatus m_status;  //!< the status of this flow
+  uint32_t m_index;     //!< the index of this flow among the queue disc classes
 };
 
 
@@ -126,6 +140,15 @@ public:
     */
    uint32_t GetQuantum (void) const;
 
+  /**
+   * \brief Get an estimate of the memory used by this queue disc
+   *
+   * Adds to the memory accounted for by the base class the per-flow state of FqCoDel.
+   *
+   * \return the estimated number of bytes used by this queue disc
+   */
+  virtual std::size_t GetMemoryFootprint (void) const;
+
   // Reasons for dropping packets
   static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
   static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
@@ -142,17 +165,29 @@ private:
    */
   uint32_t FqCoDelDrop (void);
 
+  /**
+   * \brief Release the queue disc of the flows that have been inactive for
+   *        at least IdleTimeout, and remove them from the map of the flows.
+   *        The released flows are reused (with a new queue disc) for new flows
+   */
+  void ReleaseIdleFlows (void);
+
   std::string m_interval;    //!< CoDel interval attribute
   std::string m_target;      //!< CoDel target attribute
   uint32_t m_quantum;        //!< Deficit assigned to flows at each round
   uint32_t m_flows;          //!< Number of flow queues
   uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
   uint32_t m_perturbation;   //!< hash perturbation value
+  Time m_idleTimeout;        //!< Time after which an inactive flow is released (0 to disable)
 
   std::list<Ptr<FqCoDelFlow> > m_newFlows;    //!< The list of new flows
   std::list<Ptr<FqCoDelFlow> > m_oldFlows;    //!< The list of old flows
 
   std::map<uint32_t, uint32_t> m_flowsIndices;    //!< Map with the index of class for each flow
+  std::vector<uint32_t> m_buckets;                //!< Hash value of each flow, by class index
+  std::deque<std::pair<uint32_t, Time> > m_idleFlows;  //!< Class index of the flows that became inactive, and when
+  std::vector<Time> m_idleSince;                  //!< Time each inactive flow became idle, by class index
+  std::vector<uint32_t> m_freeFlows;              //!< Class indices of the released flows
 
   ObjectFactory m_flowFactory;         //!< Factory to create a new flow
   ObjectFactory m_queueDiscFactory;    //!< Factory to create a new queue
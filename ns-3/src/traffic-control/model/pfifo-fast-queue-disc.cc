@@ -21,6 +21,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/object-factory.h"
 #include "ns3/queue.h"
 #include "ns3/socket.h"
@@ -45,6 +46,8 @@ TypeId PfifoFastQueueDisc::GetTypeId (void)
                                           &QueueDisc::GetMaxSize),
                    MakeQueueSizeChecker ())
   ;
+  static const bool reasonsRegistered = RegisterReasons ({LIMIT_EXCEEDED_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -26,6 +26,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
@@ -94,6 +95,8 @@ TypeId PieQueueDisc::GetTypeId (void)
                    MakeTimeChecker ())
   ;
 
+  static const bool reasonsRegistered = RegisterReasons ({UNFORCED_DROP, FORCED_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -102,7 +105,8 @@ PieQueueDisc::PieQueueDisc ()
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
-  m_rtrsEvent = Simulator::Schedule (m_sUpdate, &PieQueueDisc::CalculateP, this);
+  m_rtrsEvent.SetFunction (MakeCallback (&PieQueueDisc::CalculateP, this));
+  m_rtrsEvent.Schedule (m_sUpdate);
 }
 
 PieQueueDisc::~PieQueueDisc ()
@@ -115,7 +119,7 @@ PieQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
-  Simulator::Remove (m_rtrsEvent);
+  m_rtrsEvent.Cancel ();
   QueueDisc::DoDispose ();
 }
 
@@ -337,7 +341,7 @@ void PieQueueDisc::CalculateP ()
     }
 
   m_qDelayOld = qDelay;
-  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueueDisc::CalculateP, this);
+  m_rtrsEvent.Schedule (m_tUpdate);
 }
 
 Ptr<QueueDiscItem>
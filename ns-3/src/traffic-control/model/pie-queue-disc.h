@@ -32,8 +32,7 @@
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/data-rate.h"
-#include "ns3/timer.h"
-#include "ns3/event-id.h"
+#include "ns3/queue-disc-timer.h"
 #include "ns3/random-variable-stream.h"
 
 #define BURST_RESET_TIMEOUT 1.5
@@ -152,7 +151,7 @@ private:
   double m_avgDqRate;                           //!< Time averaged dequeue rate
   double m_dqStart;                             //!< Start timestamp of current measurement cycle
   uint64_t m_dqCount;                           //!< Number of bytes departed since current measurement cycle starts
-  EventId m_rtrsEvent;                          //!< Event used to decide the decision of interval of drop probability calculation
+  QueueDiscTimer m_rtrsEvent;                   //!< Timer used to decide the decision of interval of drop probability calculation
   Ptr<UniformRandomVariable> m_uv;              //!< Rng stream
 };
 
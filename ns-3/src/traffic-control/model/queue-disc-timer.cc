@@ -0,0 +1,511 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "queue-disc-timer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QueueDiscTimer");
+
+NS_OBJECT_ENSURE_REGISTERED (QueueDiscTimerWheel);
+
+/**
+ * \ingroup traffic-control
+ * Whether the timers of the queue discs are stored in timer wheels
+ */
+static GlobalValue g_queueDiscTimerWheel = GlobalValue ("QueueDiscTimerWheel",
+                                                        "Whether the timers of the queue discs are stored in a timer wheel per node, "
+                                                        "rather than scheduling a simulator event per timer",
+                                                        BooleanValue (false),
+                                                        MakeBooleanChecker ());
+
+namespace {
+
+/**
+ * \return the timer wheel of each simulation context (null if the timer wheels are disabled)
+ */
+std::map<uint32_t, Ptr<QueueDiscTimerWheel> >&
+GetWheels (void)
+{
+  static std::map<uint32_t, Ptr<QueueDiscTimerWheel> > wheels;
+  return wheels;
+}
+
+#ifdef NS3_MTP
+/**
+ * \return the mutex protecting the map of the timer wheels, which is shared
+ *         by the threads of a multi-threaded simulation
+ */
+SystemMutex&
+GetWheelsMutex (void)
+{
+  static SystemMutex mutex;
+  return mutex;
+}
+#endif
+
+/**
+ * Destroy the timer wheels, when the simulator is destroyed
+ */
+void
+DestroyWheels (void)
+{
+  std::map<uint32_t, Ptr<QueueDiscTimerWheel> > wheels;
+  wheels.swap (GetWheels ());
+  for (auto& w : wheels)
+    {
+      if (w.second)
+        {
+          w.second->Dispose ();
+        }
+    }
+}
+
+} // unnamed namespace
+
+
+QueueDiscTimer::QueueDiscTimer ()
+  : m_expiry (0),
+    m_next (0),
+    m_prev (0),
+    m_level (0),
+    m_slot (0)
+{
+}
+
+QueueDiscTimer::~QueueDiscTimer ()
+{
+  Cancel ();
+}
+
+void
+QueueDiscTimer::SetFunction (Callback<void> function)
+{
+  m_function = function;
+}
+
+void
+QueueDiscTimer::Schedule (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT_MSG (!IsRunning (), "The timer is already running");
+
+  Ptr<QueueDiscTimerWheel> wheel = QueueDiscTimerWheel::GetWheel ();
+  if (!wheel)
+    {
+      m_event = Simulator::Schedule (delay, &QueueDiscTimer::Expire, this);
+      return;
+    }
+
+  m_wheel = wheel;
+  m_expiry = wheel->GetTick (Simulator::Now () + delay);
+  wheel->Insert (this);
+}
+
+void
+QueueDiscTimer::Cancel (void)
+{
+  if (m_wheel)
+    {
+      NS_LOG_FUNCTION (this);
+      Ptr<QueueDiscTimerWheel> wheel = m_wheel;
+      m_wheel = 0;
+      wheel->Remove (this);
+    }
+  m_event.Cancel ();
+}
+
+bool
+QueueDiscTimer::IsRunning (void) const
+{
+  return m_wheel || m_event.IsRunning ();
+}
+
+Time
+QueueDiscTimer::GetDelayLeft (void) const
+{
+  if (m_wheel)
+    {
+      return m_wheel->GetTime (m_expiry) - Simulator::Now ();
+    }
+  if (m_event.IsRunning ())
+    {
+      return Simulator::GetDelayLeft (m_event);
+    }
+  return Time (0);
+}
+
+void
+QueueDiscTimer::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_function ();
+}
+
+
+TypeId
+QueueDiscTimerWheel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QueueDiscTimerWheel")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<QueueDiscTimerWheel> ()
+    .AddAttribute ("Granularity",
+                   "The duration of a tick of the timer wheel. The expiration times of "
+                   "the timers are rounded up to a multiple of the granularity, so that "
+                   "the timers expiring in the same tick share a simulator event",
+                   TimeValue (TimeStep (1)),
+                   MakeTimeAccessor (&QueueDiscTimerWheel::m_granularity),
+                   MakeTimeChecker (TimeStep (1), Time::Max ()))
+  ;
+  return tid;
+}
+
+QueueDiscTimerWheel::QueueDiscTimerWheel ()
+  : m_now (0),
+    m_nTimers (0),
+    m_expiring (false),
+    m_eventTick (0),
+    m_nEvents (0),
+    m_nExpiredTimers (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t l = 0; l < LEVELS; l++)
+    {
+      for (uint32_t s = 0; s < SLOTS; s++)
+        {
+          m_slots[l][s] = 0;
+          m_tails[l][s] = 0;
+        }
+      m_occupied[l] = 0;
+    }
+}
+
+QueueDiscTimerWheel::~QueueDiscTimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QueueDiscTimerWheel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the timers still stored are no longer running, as their expiration
+  // cannot take place once the simulator is destroyed
+  Ptr<QueueDiscTimerWheel> self = this;
+  for (uint32_t l = 0; l < LEVELS; l++)
+    {
+      for (uint32_t s = 0; s < SLOTS; s++)
+        {
+          while (m_slots[l][s])
+            {
+              QueueDiscTimer *timer = m_slots[l][s];
+              Unlink (timer);
+              timer->m_wheel = 0;
+            }
+        }
+    }
+  m_nTimers = 0;
+  m_event.Cancel ();
+  Object::DoDispose ();
+}
+
+Ptr<QueueDiscTimerWheel>
+QueueDiscTimerWheel::GetWheel (void)
+{
+#ifdef NS3_MTP
+  CriticalSection cs (GetWheelsMutex ());
+#endif
+  std::map<uint32_t, Ptr<QueueDiscTimerWheel> > &wheels = GetWheels ();
+  uint32_t context = Simulator::GetContext ();
+
+  std::map<uint32_t, Ptr<QueueDiscTimerWheel> >::iterator it = wheels.find (context);
+  if (it != wheels.end ())
+    {
+      return it->second;
+    }
+
+  if (wheels.empty ())
+    {
+      Simulator::ScheduleDestroy (&DestroyWheels);
+    }
+
+  BooleanValue enabled;
+  g_queueDiscTimerWheel.GetValue (enabled);
+  Ptr<QueueDiscTimerWheel> wheel;
+  if (enabled.Get ())
+    {
+      wheel = CreateObject<QueueDiscTimerWheel> ();
+    }
+  wheels[context] = wheel;
+  return wheel;
+}
+
+Time
+QueueDiscTimerWheel::GetGranularity (void) const
+{
+  return m_granularity;
+}
+
+uint32_t
+QueueDiscTimerWheel::GetNTimers (void) const
+{
+  return m_nTimers;
+}
+
+uint64_t
+QueueDiscTimerWheel::GetNEvents (void) const
+{
+  return m_nEvents;
+}
+
+uint64_t
+QueueDiscTimerWheel::GetNExpiredTimers (void) const
+{
+  return m_nExpiredTimers;
+}
+
+uint64_t
+QueueDiscTimerWheel::GetTick (Time time) const
+{
+  uint64_t steps = m_granularity.GetTimeStep ();
+  return (time.GetTimeStep () + steps - 1) / steps;
+}
+
+Time
+QueueDiscTimerWheel::GetTime (uint64_t tick) const
+{
+  return TimeStep (tick * m_granularity.GetTimeStep ());
+}
+
+void
+QueueDiscTimerWheel::Insert (QueueDiscTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer << timer->m_expiry);
+
+  if (m_nTimers++ == 0 && !m_expiring)
+    {
+      // the current tick is brought forward, so that the timers are stored
+      // in the lowest possible levels
+      m_now = Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ();
+    }
+  NS_ASSERT (timer->m_expiry >= m_now);
+  Place (timer);
+
+  if (!m_expiring && (!m_event.IsRunning () || timer->m_expiry < m_eventTick))
+    {
+      ScheduleEvent ();
+    }
+}
+
+void
+QueueDiscTimerWheel::Remove (QueueDiscTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+
+  Unlink (timer);
+  m_nTimers--;
+
+  // the event of the next expiration is moved if no other timer expires then
+  if (!m_expiring && timer->m_expiry == m_eventTick)
+    {
+      ScheduleEvent ();
+    }
+}
+
+void
+QueueDiscTimerWheel::Place (QueueDiscTimer *timer)
+{
+  // the level is given by the most significant group of bits in which the
+  // expiration tick differs from the current tick
+  uint64_t diff = (timer->m_expiry ^ m_now) >> SLOT_BITS;
+  uint32_t level = 0;
+  while (diff)
+    {
+      level++;
+      diff >>= SLOT_BITS;
+    }
+  uint32_t slot = (timer->m_expiry >> (level * SLOT_BITS)) & (SLOTS - 1);
+
+  // the timers are appended, so that the timers expiring at the same tick
+  // expire in the order they were scheduled, as simulator events would
+  timer->m_level = level;
+  timer->m_slot = slot;
+  timer->m_next = 0;
+  timer->m_prev = m_tails[level][slot];
+  if (timer->m_prev)
+    {
+      timer->m_prev->m_next = timer;
+    }
+  else
+    {
+      m_slots[level][slot] = timer;
+    }
+  m_tails[level][slot] = timer;
+  m_occupied[level] |= (uint64_t (1) << slot);
+}
+
+void
+QueueDiscTimerWheel::Unlink (QueueDiscTimer *timer)
+{
+  if (timer->m_prev)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      m_slots[timer->m_level][timer->m_slot] = timer->m_next;
+    }
+  if (timer->m_next)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  else
+    {
+      m_tails[timer->m_level][timer->m_slot] = timer->m_prev;
+    }
+  if (!m_slots[timer->m_level][timer->m_slot])
+    {
+      m_occupied[timer->m_level] &= ~(uint64_t (1) << timer->m_slot);
+    }
+  timer->m_next = 0;
+  timer->m_prev = 0;
+}
+
+bool
+QueueDiscTimerWheel::FindNextExpiry (uint64_t &tick, uint32_t &level, uint32_t &slot) const
+{
+  for (uint32_t l = 0; l < LEVELS; l++)
+    {
+      // the timers of the first level expire in the current group of ticks,
+      // the timers of the upper levels in a following group
+      uint32_t start = (m_now >> (l * SLOT_BITS)) & (SLOTS - 1);
+      if (l > 0)
+        {
+          start++;
+        }
+      if (start >= SLOTS || (m_occupied[l] >> start) == 0)
+        {
+          continue;
+        }
+
+      uint64_t bits = m_occupied[l] >> start;
+      slot = start;
+      while (!(bits & 1))
+        {
+          bits >>= 1;
+          slot++;
+        }
+      level = l;
+
+      if (l == 0)
+        {
+          tick = (m_now & ~uint64_t (SLOTS - 1)) | slot;
+        }
+      else
+        {
+          tick = m_slots[l][slot]->m_expiry;
+          for (QueueDiscTimer *t = m_slots[l][slot]->m_next; t != 0; t = t->m_next)
+            {
+              tick = std::min (tick, t->m_expiry);
+            }
+        }
+      return true;
+    }
+  return false;
+}
+
+void
+QueueDiscTimerWheel::ScheduleEvent (void)
+{
+  uint64_t tick;
+  uint32_t level, slot;
+  if (!FindNextExpiry (tick, level, slot))
+    {
+      m_event.Cancel ();
+      return;
+    }
+  if (m_event.IsRunning () && m_eventTick == tick)
+    {
+      return;
+    }
+
+  m_event.Cancel ();
+  m_eventTick = tick;
+  Time delay = GetTime (tick) - Simulator::Now ();
+  NS_ASSERT (!delay.IsStrictlyNegative ());
+  m_event = Simulator::Schedule (delay, &QueueDiscTimerWheel::Expire, this);
+}
+
+void
+QueueDiscTimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the timers may release the last reference to the wheel
+  Ptr<QueueDiscTimerWheel> self = this;
+  uint64_t now = Simulator::Now ().GetTimeStep () / m_granularity.GetTimeStep ();
+  m_nEvents++;
+  m_expiring = true;
+
+  uint64_t tick;
+  uint32_t level, slot;
+  while (FindNextExpiry (tick, level, slot) && tick <= now)
+    {
+      m_now = tick;
+
+      if (level > 0)
+        {
+          // cascade the timers of the slot into the lower levels
+          QueueDiscTimer *timer = m_slots[level][slot];
+          m_slots[level][slot] = 0;
+          m_tails[level][slot] = 0;
+          m_occupied[level] &= ~(uint64_t (1) << slot);
+          while (timer)
+            {
+              QueueDiscTimer *next = timer->m_next;
+              Place (timer);
+              timer = next;
+            }
+          continue;
+        }
+
+      // the timers scheduled with no delay by the expiring timers are added to
+      // this slot, and expire as well
+      while (m_slots[0][slot])
+        {
+          QueueDiscTimer *timer = m_slots[0][slot];
+          Unlink (timer);
+          m_nTimers--;
+          timer->m_wheel = 0;
+          m_nExpiredTimers++;
+          timer->m_function ();
+        }
+    }
+
+  m_expiring = false;
+  ScheduleEvent ();
+}
+
+} // namespace ns3
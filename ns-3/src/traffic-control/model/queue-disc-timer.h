@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUEUE_DISC_TIMER_H
+#define QUEUE_DISC_TIMER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class QueueDiscTimerWheel;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A timer used by queue discs to perform an action after a delay
+ *
+ * Queue discs use timers to be run again when a shaper has enough tokens
+ * (e.g., TBF) or to perform periodic updates (e.g., PIE). By default, a
+ * simulator event is scheduled for every timer. If the QueueDiscTimerWheel
+ * global value is true, the timers are stored in the timer wheel of the
+ * current simulation context (i.e., of the node) instead, which schedules a
+ * single simulator event for all the timers expiring at the same tick.
+ */
+class QueueDiscTimer
+{
+public:
+  QueueDiscTimer ();
+  /**
+   * The timer is cancelled if it is running.
+   */
+  ~QueueDiscTimer ();
+
+  /**
+   * \param function the function invoked when the timer expires
+   */
+  void SetFunction (Callback<void> function);
+
+  /**
+   * Schedule the timer to expire after the given delay. The timer must not be
+   * running. The expiration time is rounded up to the granularity of the
+   * timer wheel.
+   *
+   * \param delay the delay after which the timer expires
+   */
+  void Schedule (Time delay);
+
+  /**
+   * Cancel the timer, if it is running.
+   */
+  void Cancel (void);
+
+  /**
+   * \return true if the timer is running, i.e., it has been scheduled and has
+   *         neither expired nor been cancelled
+   */
+  bool IsRunning (void) const;
+
+  /**
+   * \return the time left before the timer expires, or zero if the timer is
+   *         not running
+   */
+  Time GetDelayLeft (void) const;
+
+private:
+  friend class QueueDiscTimerWheel;
+
+  /**
+   * \brief Copy constructor
+   * Disable default implementation to avoid misuse
+   */
+  QueueDiscTimer (const QueueDiscTimer &);
+  /**
+   * \brief Assignment operator
+   * \return this object
+   * Disable default implementation to avoid misuse
+   */
+  QueueDiscTimer &operator = (const QueueDiscTimer &);
+
+  /**
+   * Invoke the function of the timer, when it expires without a timer wheel
+   */
+  void Expire (void);
+
+  Callback<void> m_function;            //!< the function invoked when the timer expires
+  Ptr<QueueDiscTimerWheel> m_wheel;     //!< the timer wheel storing the timer, if it is running on a wheel
+  EventId m_event;                      //!< the event of the timer, if it is running without a wheel
+  uint64_t m_expiry;                    //!< the tick at which the timer expires
+  QueueDiscTimer *m_next;               //!< the next timer in the slot of the wheel
+  QueueDiscTimer *m_prev;               //!< the previous timer in the slot of the wheel
+  uint8_t m_level;                      //!< the level of the wheel storing the timer
+  uint8_t m_slot;                       //!< the slot of the level storing the timer
+};
+
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The hierarchical timer wheel storing the timers of the queue discs
+ *
+ * The expiration time of a timer is expressed in ticks, whose duration is set
+ * by the Granularity attribute (one time step by default, i.e., timers expire
+ * exactly when they would expire if a simulator event was scheduled for each
+ * of them; a coarser granularity coalesces the expirations of more timers).
+ *
+ * The wheel has a level per group of 6 bits of the tick, and every level has
+ * 64 slots. A timer is stored at the level of the most significant group in
+ * which its expiration tick differs from the current tick of the wheel, and in
+ * the slot given by the value of its expiration tick in that group. Hence, the
+ * timers of a slot of the first level expire at the same tick, while the timers
+ * of a slot of the upper levels are moved to the lower levels when the current
+ * tick enters the range of the slot (cascading). The timers of a slot are kept
+ * in the order they were scheduled, so that the timers expiring at the same
+ * tick expire in that order. A bitmap per level tracks the
+ * slots storing timers, so that the next expiration is found without visiting
+ * the empty slots.
+ *
+ * A single simulator event is scheduled at a time, for the next expiration.
+ * There is a timer wheel per simulation context, i.e., per node, so that the
+ * timers expire in the context of the node of their queue disc.
+ */
+class QueueDiscTimerWheel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  QueueDiscTimerWheel ();
+  virtual ~QueueDiscTimerWheel ();
+
+  /**
+   * Get the timer wheel of the current simulation context, creating it if
+   * needed. The timer wheels are destroyed along with the simulator.
+   *
+   * \return the timer wheel, or 0 if the QueueDiscTimerWheel global value is false
+   */
+  static Ptr<QueueDiscTimerWheel> GetWheel (void);
+
+  /**
+   * \return the duration of a tick
+   */
+  Time GetGranularity (void) const;
+
+  /**
+   * \return the number of timers stored in the wheel
+   */
+  uint32_t GetNTimers (void) const;
+
+  /**
+   * \return the number of simulator events executed by the wheel
+   */
+  uint64_t GetNEvents (void) const;
+
+  /**
+   * \return the number of timers that expired
+   */
+  uint64_t GetNExpiredTimers (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  friend class QueueDiscTimer;
+
+  /// Number of bits of the tick per level
+  static const uint32_t SLOT_BITS = 6;
+  /// Number of slots per level
+  static const uint32_t SLOTS = 1 << SLOT_BITS;
+  /// Number of levels, so that any 64 bit tick can be stored
+  static const uint32_t LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+
+  /**
+   * Store a timer in the wheel
+   * \param timer the timer, whose expiration tick is set
+   */
+  void Insert (QueueDiscTimer *timer);
+  /**
+   * Remove a timer from the wheel
+   * \param timer the timer
+   */
+  void Remove (QueueDiscTimer *timer);
+  /**
+   * Add a timer to the slot given by its expiration tick and the current tick
+   * \param timer the timer
+   */
+  void Place (QueueDiscTimer *timer);
+  /**
+   * Remove a timer from its slot
+   * \param timer the timer
+   */
+  void Unlink (QueueDiscTimer *timer);
+  /**
+   * Find the first slot storing the timers that expire next
+   * \param [out] tick the tick at which the next timer expires
+   * \param [out] level the level of the slot
+   * \param [out] slot the slot
+   * \return false if the wheel stores no timer
+   */
+  bool FindNextExpiry (uint64_t &tick, uint32_t &level, uint32_t &slot) const;
+  /**
+   * Schedule the simulator event for the next expiration, cancelling the
+   * previous one
+   */
+  void ScheduleEvent (void);
+  /**
+   * Expire the timers whose expiration tick has been reached
+   */
+  void Expire (void);
+  /**
+   * \param time a time
+   * \return the first tick not preceding the given time
+   */
+  uint64_t GetTick (Time time) const;
+  /**
+   * \param tick a tick
+   * \return the time at which the tick begins
+   */
+  Time GetTime (uint64_t tick) const;
+
+  Time m_granularity;                          //!< the duration of a tick
+  uint64_t m_now;                              //!< the current tick of the wheel
+  uint32_t m_nTimers;                          //!< the number of timers stored
+  QueueDiscTimer *m_slots[LEVELS][SLOTS];      //!< the first timer of each slot
+  QueueDiscTimer *m_tails[LEVELS][SLOTS];      //!< the last timer of each slot
+  uint64_t m_occupied[LEVELS];                 //!< the bitmap of the slots storing timers, per level
+  bool m_expiring;                             //!< true while the expired timers are being invoked
+  EventId m_event;                             //!< the event of the next expiration
+  uint64_t m_eventTick;                        //!< the tick of the event of the next expiration
+  uint64_t m_nEvents;                          //!< the number of events executed
+  uint64_t m_nExpiredTimers;                   //!< the number of timers that expired
+};
+
+} // namespace ns3
+
+#endif /* QUEUE_DISC_TIMER_H */
@@ -29,6 +29,13 @@
 #include "queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
+#include "ns3/queue-limits.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <limits>
+#include <deque>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -102,7 +109,8 @@ QueueDisc::Stats::Stats ()
     nTotalRequeuedPackets (0),
     nTotalRequeuedBytes (0),
     nTotalMarkedPackets (0),
-    nTotalMarkedBytes (0)
+    nTotalMarkedBytes (0),
+    nTotalCollidedPackets (0)
 {
 }
 
@@ -249,6 +257,11 @@ QueueDisc::Stats::Print (std::ostream &os) const
       itb++;
     }
 
+  if (nTotalCollidedPackets)
+    {
+      os << std::endl << "Packets collided: " << nTotalCollidedPackets;
+    }
+
   os << std::endl;
 }
 
@@ -258,6 +271,65 @@ std::ostream & operator << (std::ostream &os, const QueueDisc::Stats &stats)
   return os;
 }
 
+/**
+ * \ingroup traffic-control
+ *
+ * The registry interning the reasons why queue discs drop or mark packets
+ */
+struct QueueDiscReasonRegistry
+{
+  std::deque<std::string> names;                       //!< Name of each reason, indexed by identifier
+  std::map<std::string, uint32_t> ids;                 //!< Identifier of each reason, indexed by name
+  std::unordered_map<const char*, uint32_t> pointers;  //!< Identifier of each reason, indexed by address
+  std::vector<uint32_t> childIds;                      //!< Identifier of the reason of the parent queue disc, indexed by the identifier of the reason of the child
+#ifdef NS3_MTP
+  SystemMutex mutex;                                   //!< Mutex shared by the threads of a multi-threaded simulation
+#endif
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \return the registry of the reasons why queue discs drop or mark packets
+ */
+static QueueDiscReasonRegistry&
+GetQueueDiscReasonRegistry (void)
+{
+  static QueueDiscReasonRegistry registry;
+  return registry;
+}
+
+/**
+ * \ingroup traffic-control
+ *
+ * \param registry the registry of the reasons
+ * \param reason the reason
+ * \return the identifier of the reason, which is interned if not found
+ */
+static uint32_t
+InternQueueDiscReason (QueueDiscReasonRegistry& registry, const char* reason)
+{
+  auto itp = registry.pointers.find (reason);
+  if (itp != registry.pointers.end ())
+    {
+      return itp->second;
+    }
+
+  auto it = registry.ids.find (reason);
+  if (it != registry.ids.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t id = registry.names.size ();
+  registry.names.push_back (reason);
+  registry.ids[reason] = id;
+  // the names stored in the registry never move, hence they can be looked up
+  // by address (e.g., when a parent queue disc gets the reason from a child)
+  registry.pointers[registry.names.back ().c_str ()] = id;
+  return id;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (QueueDisc);
 
 TypeId QueueDisc::GetTypeId (void)
@@ -270,6 +342,12 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BulkDequeueLimit",
+                   "The maximum number of packets dequeued and sent to the device in a burst "
+                   "in a qdisc run (1 disables bulk dequeues)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&QueueDisc::m_bulkLimit),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -316,6 +394,8 @@ TypeId QueueDisc::GetTypeId (void)
                      MakeTraceSourceAccessor (&QueueDisc::m_sojourn),
                      "ns3::Time::TracedCallback")
   ;
+  static const bool reasonsRegistered = RegisterReasons ({INTERNAL_QUEUE_DROP, CHILD_QUEUE_DISC_DROP});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -325,6 +405,7 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
      m_running (false),
      m_peeked (false),
+     m_moving (false),
      m_sizePolicy (policy),
      m_prohibitChangeMode (false)
 {
@@ -352,13 +433,13 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // the packet is dropped.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (GetReasonId (r));
+      return DropBeforeEnqueue (item, id, GetReasonName (id));
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (GetReasonId (r));
+      return DropAfterDequeue (item, id, GetReasonName (id));
     };
 }
 
@@ -383,6 +464,8 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBurst = nullptr;
+  m_burst.clear ();
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -428,9 +511,101 @@ QueueDisc::GetStats (void)
   m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
                             - m_stats.nTotalDroppedBytesAfterDequeue;
 
+  // likewise, the per-reason counters are kept in flat arrays indexed by the
+  // identifier of the reason and are only copied into the maps here
+  CopyReasonCounters (m_droppedBeforeEnqueue, m_stats.nDroppedPacketsBeforeEnqueue,
+                      m_stats.nDroppedBytesBeforeEnqueue);
+  CopyReasonCounters (m_droppedAfterDequeue, m_stats.nDroppedPacketsAfterDequeue,
+                      m_stats.nDroppedBytesAfterDequeue);
+  CopyReasonCounters (m_marked, m_stats.nMarkedPackets, m_stats.nMarkedBytes);
+
   return m_stats;
 }
 
+bool
+QueueDisc::RegisterReasons (std::initializer_list<const char*> reasons)
+{
+  QueueDiscReasonRegistry& registry = GetQueueDiscReasonRegistry ();
+#ifdef NS3_MTP
+  CriticalSection cs (registry.mutex);
+#endif
+  for (auto reason : reasons)
+    {
+      uint32_t id = InternQueueDiscReason (registry, reason);
+      registry.pointers[reason] = id;
+    }
+  return true;
+}
+
+uint32_t
+QueueDisc::GetReasonId (const char* reason)
+{
+  QueueDiscReasonRegistry& registry = GetQueueDiscReasonRegistry ();
+#ifdef NS3_MTP
+  CriticalSection cs (registry.mutex);
+#endif
+  return InternQueueDiscReason (registry, reason);
+}
+
+uint32_t
+QueueDisc::GetChildReasonId (uint32_t childId)
+{
+  QueueDiscReasonRegistry& registry = GetQueueDiscReasonRegistry ();
+#ifdef NS3_MTP
+  CriticalSection cs (registry.mutex);
+#endif
+
+  if (childId >= registry.childIds.size ())
+    {
+      registry.childIds.resize (childId + 1, std::numeric_limits<uint32_t>::max ());
+    }
+  if (registry.childIds[childId] == std::numeric_limits<uint32_t>::max ())
+    {
+      NS_ASSERT (childId < registry.names.size ());
+      std::string name = std::string (CHILD_QUEUE_DISC_DROP) + registry.names[childId];
+      registry.childIds[childId] = InternQueueDiscReason (registry, name.c_str ());
+    }
+  return registry.childIds[childId];
+}
+
+const char*
+QueueDisc::GetReasonName (uint32_t id)
+{
+  QueueDiscReasonRegistry& registry = GetQueueDiscReasonRegistry ();
+#ifdef NS3_MTP
+  CriticalSection cs (registry.mutex);
+#endif
+  NS_ASSERT (id < registry.names.size ());
+  return registry.names[id].c_str ();
+}
+
+void
+QueueDisc::UpdateReasonCounters (std::vector<ReasonCounters>& counters, uint32_t id,
+                                 Ptr<const QueueDiscItem> item)
+{
+  if (id >= counters.size ())
+    {
+      counters.resize (id + 1, {0, 0});
+    }
+  counters[id].nPackets++;
+  counters[id].nBytes += item->GetSize ();
+}
+
+void
+QueueDisc::CopyReasonCounters (const std::vector<ReasonCounters>& counters,
+                               std::map<std::string, uint32_t>& packets,
+                               std::map<std::string, uint64_t>& bytes)
+{
+  for (uint32_t id = 0; id < counters.size (); id++)
+    {
+      if (counters[id].nPackets > 0)
+        {
+          packets[GetReasonName (id)] = counters[id].nPackets;
+          bytes[GetReasonName (id)] = counters[id].nBytes;
+        }
+    }
+}
+
 uint32_t
 QueueDisc::GetNPackets () const
 {
@@ -558,6 +733,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBurstCallback (SendBurstCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBurst = func;
+}
+
+QueueDisc::SendBurstCallback
+QueueDisc::GetSendBurstCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBurst;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -577,6 +766,15 @@ QueueDisc::AddInternalQueue (Ptr<InternalQueue> queue)
 {
   NS_LOG_FUNCTION (this);
 
+  ConnectInternalQueue (queue);
+  m_queues.push_back (queue);
+}
+
+void
+QueueDisc::ConnectInternalQueue (Ptr<InternalQueue> queue)
+{
+  NS_LOG_FUNCTION (this << queue);
+
   // set various callbacks on the internal queue, so that the queue disc is
   // notified of packets enqueued, dequeued or dropped by the internal queue
   queue->TraceConnectWithoutContext ("Enqueue",
@@ -589,7 +787,6 @@ QueueDisc::AddInternalQueue (Ptr<InternalQueue> queue)
   queue->TraceConnectWithoutContext ("DropAfterDequeue",
                                      MakeCallback (&InternalQueueDropFunctor::operator(),
                                                    &m_internalQueueDadFunctor));
-  m_queues.push_back (queue);
 }
 
 Ptr<QueueDisc::InternalQueue>
@@ -629,25 +826,56 @@ void
 QueueDisc::AddQueueDiscClass (Ptr<QueueDiscClass> qdClass)
 {
   NS_LOG_FUNCTION (this);
-  NS_ABORT_MSG_IF (qdClass->GetQueueDisc () == 0, "Cannot add a class with no attached queue disc");
+  // a class may be left without queue disc by a queue disc storing the packets
+  // of the class itself, which can only add classes once initialized
+  NS_ABORT_MSG_IF (qdClass->GetQueueDisc () == 0 && !IsInitialized (),
+                   "Cannot add a class with no attached queue disc");
+  if (qdClass->GetQueueDisc ())
+    {
+      ConnectChildQueueDisc (qdClass->GetQueueDisc ());
+    }
+  m_classes.push_back (qdClass);
+}
+
+void
+QueueDisc::ReplaceQueueDiscClassChild (std::size_t i, Ptr<QueueDisc> qd)
+{
+  NS_LOG_FUNCTION (this << i << qd);
+  NS_ASSERT (i < m_classes.size ());
+
+  Ptr<QueueDiscClass> qdClass = m_classes[i];
+  if (qdClass->m_queueDisc)
+    {
+      NS_ABORT_MSG_IF (qdClass->m_queueDisc->GetNPackets () > 0,
+                       "Cannot release a queue disc holding packets");
+      qdClass->m_queueDisc->Dispose ();
+    }
+  if (qd)
+    {
+      ConnectChildQueueDisc (qd);
+    }
+  qdClass->m_queueDisc = qd;
+}
+
+void
+QueueDisc::ConnectChildQueueDisc (Ptr<QueueDisc> qd)
+{
+  NS_LOG_FUNCTION (this << qd);
   // the child queue disc cannot be one with wake mode equal to WAKE_CHILD because
   // such queue discs do not implement the enqueue/dequeue methods
-  NS_ABORT_MSG_IF (qdClass->GetQueueDisc ()->GetWakeMode () == WAKE_CHILD,
+  NS_ABORT_MSG_IF (qd->GetWakeMode () == WAKE_CHILD,
                    "A queue disc with WAKE_CHILD as wake mode can only be a root queue disc");
 
   // set the parent callbacks on the child queue disc, so that it can notify
   // the parent queue disc of packets enqueued, dequeued or dropped
-  qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Enqueue",
-                                     MakeCallback (&QueueDisc::PacketEnqueued, this));
-  qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("Dequeue",
-                                     MakeCallback (&QueueDisc::PacketDequeued, this));
-  qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("DropBeforeEnqueue",
-                                     MakeCallback (&ChildQueueDiscDropFunctor::operator(),
-                                                   &m_childQueueDiscDbeFunctor));
-  qdClass->GetQueueDisc ()->TraceConnectWithoutContext ("DropAfterDequeue",
-                                     MakeCallback (&ChildQueueDiscDropFunctor::operator(),
-                                                   &m_childQueueDiscDadFunctor));
-  m_classes.push_back (qdClass);
+  qd->TraceConnectWithoutContext ("Enqueue", MakeCallback (&QueueDisc::PacketEnqueued, this));
+  qd->TraceConnectWithoutContext ("Dequeue", MakeCallback (&QueueDisc::PacketDequeued, this));
+  qd->TraceConnectWithoutContext ("DropBeforeEnqueue",
+                                  MakeCallback (&ChildQueueDiscDropFunctor::operator(),
+                                                &m_childQueueDiscDbeFunctor));
+  qd->TraceConnectWithoutContext ("DropAfterDequeue",
+                                  MakeCallback (&ChildQueueDiscDropFunctor::operator(),
+                                                &m_childQueueDiscDadFunctor));
 }
 
 Ptr<QueueDiscClass>
@@ -683,9 +911,42 @@ QueueDisc::GetWakeMode (void) const
   return WAKE_ROOT;
 }
 
+bool
+QueueDisc::IsMultiQueueAware (void) const
+{
+  return false;
+}
+
+std::size_t
+QueueDisc::GetMemoryFootprint (void) const
+{
+  std::size_t size = sizeof (QueueDisc)
+    + m_queues.capacity () * sizeof (Ptr<InternalQueue>)
+    + m_filters.capacity () * sizeof (Ptr<PacketFilter>)
+    + m_classes.capacity () * sizeof (Ptr<QueueDiscClass>)
+    + m_queues.size () * sizeof (InternalQueue);
+
+  for (std::vector<Ptr<QueueDiscClass> >::const_iterator cl = m_classes.begin ();
+       cl != m_classes.end (); cl++)
+    {
+      size += sizeof (QueueDiscClass);
+      if ((*cl)->GetQueueDisc ())
+        {
+          size += (*cl)->GetQueueDisc ()->GetMemoryFootprint ();
+        }
+    }
+  return size;
+}
+
 void
 QueueDisc::PacketEnqueued (Ptr<const QueueDiscItem> item)
 {
+  // a packet being moved within this queue disc has been already enqueued
+  if (m_moving)
+    {
+      return;
+    }
+
   m_nPackets++;
   m_nBytes += item->GetSize ();
   m_stats.nTotalEnqueuedPackets++;
@@ -702,8 +963,9 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
   // dequeue a packet because a peek operation was requested, the packet is
   // still held by the queue disc, hence we do not need to update statistics
   // and fire the dequeue trace. This function will be explicitly called when
-  // the packet will be actually dequeued.
-  if (!m_peeked)
+  // the packet will be actually dequeued. The same holds for a packet being
+  // moved within this queue disc.
+  if (!m_peeked && !m_moving)
     {
       m_nPackets--;
       m_nBytes -= item->GetSize ();
@@ -720,33 +982,32 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
-  NS_LOG_FUNCTION (this << item << reason);
+  DropBeforeEnqueue (item, GetReasonId (reason), reason);
+}
+
+void
+QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << id << reason);
+
+  // a packet being moved within this queue disc had been enqueued, hence it
+  // is dequeued and dropped
+  if (m_moving)
+    {
+      m_moving = false;
+      PacketDequeued (item);
+      DropAfterDequeue (item, id, reason);
+      m_moving = true;
+      return;
+    }
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and the amount of bytes dropped for the given reason
+  UpdateReasonCounters (m_droppedBeforeEnqueue, id, item);
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -759,33 +1020,21 @@ QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 {
-  NS_LOG_FUNCTION (this << item << reason);
+  DropAfterDequeue (item, GetReasonId (reason), reason);
+}
+
+void
+QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << id << reason);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and the amount of bytes dropped for the given reason
+  UpdateReasonCounters (m_droppedAfterDequeue, id, item);
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -821,26 +1070,8 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and the amount of bytes marked for the given reason
+  UpdateReasonCounters (m_marked, GetReasonId (reason), item);
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
@@ -849,6 +1080,32 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   return true;
 }
 
+void
+QueueDisc::Collided (Ptr<const QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  m_stats.nTotalCollidedPackets++;
+
+  NS_LOG_DEBUG ("Total packets collided: " << m_stats.nTotalCollidedPackets);
+}
+
+void
+QueueDisc::StartMovingPackets (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_moving);
+  m_moving = true;
+}
+
+void
+QueueDisc::FinishMovingPackets (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_moving);
+  m_moving = false;
+}
+
 bool
 QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
 {
@@ -950,10 +1207,11 @@ QueueDisc::Run (void)
 
   if (RunBegin ())
     {
-      uint32_t quota = m_quota;
-      while (Restart ())
+      int64_t quota = m_quota;
+      uint32_t packets;
+      while (Restart (packets))
         {
-          quota -= 1;
+          quota -= packets;
           if (quota <= 0)
             {
               /// \todo netif_schedule (q);
@@ -985,16 +1243,24 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &packets)
 {
   NS_LOG_FUNCTION (this);
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
       NS_LOG_LOGIC ("No packet to send");
+      packets = 0;
       return false;
     }
 
+  if (!m_burst.empty ())
+    {
+      packets = m_burst.size ();
+      return TransmitBurst ();
+    }
+
+  packets = 1;
   return Transmit (item);
 }
 
@@ -1040,13 +1306,65 @@ QueueDisc::DequeuePacket ()
           if (item != 0)
             {
               item->AddHeader ();
+              // Here, Linux tries bulk dequeues
+              if (m_bulkLimit > 1)
+                {
+                  TryBulkDequeue (item);
+                }
             }
-          // Here, Linux tries bulk dequeues
         }
     }
   return item;
 }
 
+void
+QueueDisc::TryBulkDequeue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT (m_burst.empty ());
+
+  // As in Linux, bulk dequeues are only performed if the device has a single
+  // transmission queue. Also, the device queue must report its free room, so
+  // that a burst never overflows it
+  if (!m_sendBurst || !m_devQueueIface || m_devQueueIface->GetNTxQueues () > 1)
+    {
+      return;
+    }
+
+  Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+  uint32_t budget = txq->GetNSlots (m_bulkLimit);
+
+  // As in Linux, the burst cannot exceed the bytes still allowed by the queue
+  // limits of the device (if any), including the packet already dequeued.
+  // Linux does not perform bulk dequeues if BQL is not enabled, while here the
+  // burst is only bounded by the room in the device queue and the BulkDequeueLimit
+  int64_t byteLimit = std::numeric_limits<int64_t>::max ();
+  Ptr<QueueLimits> queueLimits = txq->GetQueueLimits ();
+  if (queueLimits)
+    {
+      byteLimit = static_cast<int64_t> (queueLimits->Available ()) - item->GetSize ();
+    }
+
+  m_burst.push_back (item);
+  while (m_burst.size () < budget && byteLimit > 0)
+    {
+      Ptr<QueueDiscItem> next = Dequeue ();
+      if (next == 0)
+        {
+          break;
+        }
+      next->AddHeader ();
+      m_burst.push_back (next);
+      byteLimit -= next->GetSize ();
+    }
+
+  if (m_burst.size () == 1)
+    {
+      m_burst.clear ();
+    }
+  NS_LOG_LOGIC ("Bulk dequeue of " << m_burst.size () << " packets");
+}
+
 void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
@@ -1100,9 +1418,39 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   // returned by ndo_start_xmit.
 
   // if the queue disc is empty or the device queue is now stopped, return false so
-  // that the Run method does not attempt to dequeue other packets and exits
+  // that the Run method does not attempt to dequeue other packets and exits. A
+  // multi-queue aware queue disc goes on dequeuing packets for the other device
+  // queues, and returns no packet when all of them are stopped
   if (GetNPackets () == 0 ||
-      (m_devQueueIface && m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ()))
+      (m_devQueueIface && m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ()
+       && !(IsMultiQueueAware () && m_devQueueIface->GetNTxQueues () > 1)))
+    {
+      return false;
+    }
+
+  return true;
+}
+
+bool
+QueueDisc::TransmitBurst (void)
+{
+  NS_LOG_FUNCTION (this << m_burst.size ());
+  NS_ASSERT (m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1);
+  NS_ASSERT (!m_devQueueIface->GetTxQueue (0)->IsStopped ());
+
+  // a single queue device makes no use of the priority tag
+  SocketPriorityTag priorityTag;
+  for (auto& item : m_burst)
+    {
+      item->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+  m_sendBurst (m_burst);
+  m_burst.clear ();
+
+  // as in Transmit, the packets are assumed to be consumed by the netdevice.
+  // If the queue disc is empty or the device queue is now stopped, return false
+  // so that the Run method does not attempt to dequeue other packets and exits
+  if (GetNPackets () == 0 || m_devQueueIface->GetTxQueue (0)->IsStopped ())
     {
       return false;
     }
@@ -28,6 +28,7 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <initializer_list>
 #include <string>
 #include "packet-filter.h"
 
@@ -76,6 +77,8 @@ protected:
   virtual void DoDispose (void);
 
 private:
+  friend class QueueDisc;
+
   Ptr<QueueDisc> m_queueDisc;        //!< Queue disc attached to this class
 };
 
@@ -232,6 +235,8 @@ public:
     uint32_t nTotalMarkedBytes;
     /// Marked bytes, for each reason
     std::map<std::string, uint64_t> nMarkedBytes;
+    /// Total packets classified into a queue holding packets of a different flow
+    uint32_t nTotalCollidedPackets;
 
     /// constructor
     Stats ();
@@ -372,6 +377,26 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a burst of packets to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBurstCallback;
+
+  /**
+   * \param func the callback to send a burst of packets to the receiving object.
+   *
+   * Set the callback used by the TransmitBurst method (called eventually by the
+   * Run method) to send the packets obtained by a bulk dequeue to the receiving
+   * object. Bulk dequeues are only performed if this callback is set.
+   */
+  void SetSendBurstCallback (SendBurstCallback func);
+
+  /**
+   * \return the callback to send a burst of packets to the receiving object.
+   *
+   * Get the callback used by the TransmitBurst method (called eventually by the
+   * Run method) to send a burst of packets to the receiving object.
+   */
+  SendBurstCallback GetSendBurstCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -461,6 +486,11 @@ public:
 
   /**
    * \brief Add a queue disc class to the tail of the list of classes.
+   *
+   * The class must have a queue disc attached, unless it is added once this
+   * queue disc is initialized, by a queue disc that stores the packets of the
+   * class itself.
+   *
    * \param qdClass the queue disc class to be added
    */
   void AddQueueDiscClass (Ptr<QueueDiscClass> qdClass);
@@ -512,10 +542,50 @@ public:
    */
   virtual WakeMode GetWakeMode (void) const;
 
+  /**
+   * A root queue disc installed on a multi-queue device that is aware of the
+   * device transmission queues only dequeues packets destined to transmission
+   * queues that are not stopped. Hence, when the transmission queue of a packet
+   * that has been sent is stopped, packets can still be dequeued for the other
+   * transmission queues, instead of waiting for the stopped queue to be woken.
+   * The implementation of this method for the base class returns false.
+   *
+   * \return true if this queue disc skips the packets destined to stopped
+   *         device transmission queues.
+   */
+  virtual bool IsMultiQueueAware (void) const;
+
+  /**
+   * \brief Get an estimate of the memory used by this queue disc, excluding
+   *        the queued packets.
+   *
+   * The estimate includes the queue disc object, its internal queues and its
+   * classes along with their queue discs (recursively). Queue discs holding
+   * further state, e.g., flow tables, add the memory they allocate for it. The
+   * memory allocated by the objects for their attributes and aggregates and
+   * by the trace sources for their connected callbacks is not included.
+   *
+   * \return the estimated number of bytes
+   */
+  virtual std::size_t GetMemoryFootprint (void) const;
+
   // Reasons for dropping packets
   static constexpr const char* INTERNAL_QUEUE_DROP = "Dropped by internal queue";    //!< Packet dropped by an internal queue
   static constexpr const char* CHILD_QUEUE_DISC_DROP = "(Dropped by child queue disc) "; //!< Packet dropped by a child queue disc
 
+  /**
+   * \brief Register the given reasons why packets are dropped or marked
+   * \param reasons the reasons, which must be string literals
+   * \return true
+   *
+   * Reasons are interned to small integer identifiers, which index the flat
+   * arrays holding the per-reason counters of a queue disc. Queue discs are
+   * expected to register the reasons they use when their TypeId is registered,
+   * so that the identifier of a reason is found by address when a packet is
+   * dropped or marked. Reasons that are not registered are looked up by name.
+   */
+  static bool RegisterReasons (std::initializer_list<const char*> reasons);
+
 protected:
   /**
    * \brief Dispose of the object
@@ -560,6 +630,56 @@ protected:
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
+  /**
+   *  \brief Updates the counters when a packet is classified into a queue
+   *         already holding packets of a different flow (hash collision)
+   *  \param item the collided item
+   */
+  void Collided (Ptr<const QueueDiscItem> item);
+
+  /**
+   *  \brief Start moving packets among the internal queues or the child queue
+   *         discs of this queue disc
+   *
+   *  Until FinishMovingPackets is called, the packets dequeued from and enqueued
+   *  into the internal queues or the child queue discs are still held by this
+   *  queue disc, hence statistics are not updated and traces are not fired. A
+   *  packet that cannot be enqueued is reported as dropped after dequeue.
+   */
+  void StartMovingPackets (void);
+
+  /**
+   *  \brief Finish moving packets among the internal queues or the child queue
+   *         discs of this queue disc
+   */
+  void FinishMovingPackets (void);
+
+  /**
+   *  \brief Replace the queue disc attached to a class of this queue disc
+   *
+   *  This allows queue discs creating a class per flow to release the queue
+   *  disc of a class that is no longer used, and to attach a new queue disc to
+   *  the class when it is used again. The previous queue disc, if any, must be
+   *  empty and is disposed of.
+   *
+   *  \param i the index of the class
+   *  \param qd the queue disc to attach to the class, or 0 to leave the class
+   *         without a queue disc
+   */
+  void ReplaceQueueDiscClassChild (std::size_t i, Ptr<QueueDisc> qd);
+
+  /**
+   *  \brief Connect a queue to this queue disc as an internal queue, without
+   *         adding it to the list of internal queues
+   *
+   *  This queue disc is then notified of the packets enqueued, dequeued or
+   *  dropped by the queue, as for its internal queues. This allows queue discs
+   *  to keep a queue per class instead of attaching a queue disc to the class.
+   *
+   *  \param queue the queue
+   */
+  void ConnectInternalQueue (Ptr<InternalQueue> queue);
+
 private:
   /**
    * \brief Copy constructor
@@ -578,6 +698,72 @@ private:
    */
   QueueDisc &operator = (const QueueDisc &o);
 
+  /// \brief Counters of the packets dropped or marked for a given reason
+  struct ReasonCounters
+  {
+    uint32_t nPackets;  //!< Number of packets
+    uint64_t nBytes;    //!< Number of bytes
+  };
+
+  /**
+   * \brief Get the identifier of the given reason, interning it if needed
+   * \param reason the reason why a packet is dropped or marked
+   * \return the identifier of the reason
+   */
+  static uint32_t GetReasonId (const char* reason);
+
+  /**
+   * \brief Get the identifier of the reason why a packet dropped by a child
+   *        queue disc for the given reason is dropped by its parent
+   * \param childId the identifier of the reason of the child queue disc
+   * \return the identifier of the reason of the parent queue disc
+   */
+  static uint32_t GetChildReasonId (uint32_t childId);
+
+  /**
+   * \brief Get the name of the reason with the given identifier
+   * \param id the identifier of the reason
+   * \return the name of the reason, which remains valid until the end of the program
+   */
+  static const char* GetReasonName (uint32_t id);
+
+  /**
+   * \brief Update the counters of the given reason
+   * \param counters the per-reason counters
+   * \param id the identifier of the reason
+   * \param item the item dropped or marked
+   */
+  static void UpdateReasonCounters (std::vector<ReasonCounters>& counters, uint32_t id,
+                                    Ptr<const QueueDiscItem> item);
+
+  /**
+   * \brief Copy the per-reason counters into the per-reason maps of the statistics
+   * \param counters the per-reason counters
+   * \param packets the map of the number of packets for each reason
+   * \param bytes the map of the amount of bytes for each reason
+   */
+  static void CopyReasonCounters (const std::vector<ReasonCounters>& counters,
+                                  std::map<std::string, uint32_t>& packets,
+                                  std::map<std::string, uint64_t>& bytes);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped before enqueue for the reason with the given identifier
+   *  \param item item that was dropped
+   *  \param id the identifier of the reason why the item was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
+  /**
+   *  \brief Perform the actions required when the queue disc is notified of
+   *         a packet dropped after dequeue for the reason with the given identifier
+   *  \param item item that was dropped
+   *  \param id the identifier of the reason why the item was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void DropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
   /**
    * This function actually enqueues a packet into the queue disc.
    * \param item item to enqueue
@@ -639,10 +825,12 @@ private:
 
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
-   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit),
+   * or send to the device the burst of packets obtained by a bulk dequeue (by calling TransmitBurst).
+   * \param packets the number of packets sent to the device
+   * \return true if packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &packets);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -650,6 +838,16 @@ private:
    */
   Ptr<QueueDiscItem> DequeuePacket (void);
 
+  /**
+   * Modelled after the Linux function try_bulk_dequeue_skb (net/sched/sch_generic.c)
+   * Dequeue further packets after the given one, as long as they fit in the room
+   * left in the device queue, in the bytes allowed by the queue limits of the
+   * device and in the BulkDequeueLimit. If at least one further packet is
+   * dequeued, the given packet and the further packets are stored in m_burst.
+   * \param item the packet just dequeued
+   */
+  void TryBulkDequeue (Ptr<QueueDiscItem> item);
+
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
    * Requeues a packet whose transmission failed.
@@ -666,6 +864,22 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
+   * when called with a list of packets.
+   * Sends the packets in m_burst to the device. The device queue cannot be
+   * stopped because the burst does not exceed the room left in the device queue.
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBurst (void);
+
+  /**
+   *  \brief Set the parent callbacks on a child queue disc, so that it notifies
+   *         this queue disc of the packets enqueued, dequeued or dropped
+   *  \param qd the child queue disc
+   */
+  void ConnectChildQueueDisc (Ptr<QueueDisc> qd);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -692,13 +906,19 @@ private:
   QueueSize m_maxSize;              //!< max queue size
 
   Stats m_stats;                    //!< The collected statistics
+  std::vector<ReasonCounters> m_droppedBeforeEnqueue;  //!< Packets dropped before enqueue, for each reason identifier
+  std::vector<ReasonCounters> m_droppedAfterDequeue;   //!< Packets dropped after dequeue, for each reason identifier
+  std::vector<ReasonCounters> m_marked;                //!< Packets marked, for each reason identifier
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBurstCallback m_sendBurst;    //!< Callback used to send a burst of packets to the receiving object
+  uint32_t m_bulkLimit;             //!< Maximum number of packets sent to the device in a burst
+  std::vector<Ptr<QueueDiscItem> > m_burst;  //!< The packets obtained by the last bulk dequeue
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
+  bool m_moving;                    //!< Packets are being moved within this queue disc
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
 
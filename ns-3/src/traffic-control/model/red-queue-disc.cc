@@ -57,6 +57,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/unused.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
@@ -220,6 +221,8 @@ TypeId RedQueueDisc::GetTypeId (void)
                    MakeBooleanChecker ())
   ;
 
+  static const bool reasonsRegistered = RegisterReasons ({UNFORCED_DROP, FORCED_DROP, UNFORCED_MARK, FORCED_MARK});
+  NS_UNUSED (reasonsRegistered);
   return tid;
 }
 
@@ -94,6 +94,7 @@ TbfQueueDisc::TbfQueueDisc ()
   : QueueDisc (QueueDiscSizePolicy::SINGLE_CHILD_QUEUE_DISC)
 {
   NS_LOG_FUNCTION (this);
+  m_id.SetFunction (MakeCallback (&QueueDisc::Run, this));
 }
 
 TbfQueueDisc::~TbfQueueDisc ()
@@ -105,6 +106,7 @@ void
 TbfQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_id.Cancel ();
   QueueDisc::DoDispose ();
 }
 
@@ -257,12 +259,12 @@ TbfQueueDisc::DoDequeue (void)
       /* A packet gets blocked if the above if condition is not satisfied, i.e.
       both the ptoks and btoks are less than zero. In that case we have to 
       schedule the waking of queue when enough tokens are available. */
-      if (m_id.IsExpired () == true)
+      if (!m_id.IsRunning ())
         {
           Time requiredDelayTime = std::max (m_rate.CalculateBytesTxTime (-btoks),
                                              m_peakRate.CalculateBytesTxTime (-ptoks));
 
-          m_id = Simulator::Schedule (requiredDelayTime, &QueueDisc::Run, this);
+          m_id.Schedule (requiredDelayTime);
           NS_LOG_LOGIC("Waking Event Scheduled in " << requiredDelayTime);
         }
     }
@@ -352,7 +354,7 @@ TbfQueueDisc::InitializeParams (void)
   m_ptokens = m_mtu;
   // Initialising other variables to 0.
   m_timeCheckPoint = Seconds (0);
-  m_id = EventId ();
+  m_id.Cancel ();
 }
 
 } // namespace ns3
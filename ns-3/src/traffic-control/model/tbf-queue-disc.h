@@ -36,7 +36,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
-#include "ns3/event-id.h"
+#include "ns3/queue-disc-timer.h"
 
 namespace ns3 {
 
@@ -162,7 +162,7 @@ private:
   TracedValue<uint32_t> m_btokens; //!< Current number of tokens in first bucket
   TracedValue<uint32_t> m_ptokens; //!< Current number of tokens in second bucket
   Time m_timeCheckPoint;           //!< Time check-point
-  EventId m_id;                    //!< EventId of the scheduled queue waking event when enough tokens are available
+  QueueDiscTimer m_id;             //!< Timer waking the queue when enough tokens are available
 
 };
 
@@ -179,13 +179,24 @@ TrafficControlLayer::ScanDevices (void)
               ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc);
             }
 
-          // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
-          // into which packets are enqueued and dequeued by calling Run
+          // set the NetDeviceQueueInterface object and the SendCallback (as well as
+          // the SendBurstCallback, used by bulk dequeues) on the queue discs into
+          // which packets are enqueued and dequeued by calling Run
           for (auto& q : ndi->second.m_queueDiscsToWake)
             {
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              std::vector<NetDevice::BurstPacket> burst;
+              q->SetSendBurstCallback ([dev, burst] (const std::vector<Ptr<QueueDiscItem> > &items) mutable
+                                       {
+                                         burst.clear ();
+                                         for (auto& item : items)
+                                           {
+                                             burst.push_back ({item->GetPacket (), item->GetAddress (), item->GetProtocol ()});
+                                           }
+                                         dev->SendBurst (burst);
+                                       });
             }
         }
     }
@@ -349,7 +360,7 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 
   // determine the transmission queue of the device where the packet will be enqueued
   std::size_t txq = 0;
-  if (devQueueIface && devQueueIface->GetNTxQueues () > 1)
+  if (devQueueIface && devQueueIface->GetNTxQueues () > 1 && devQueueIface->GetSelectQueueCallback ())
     {
       txq = devQueueIface->GetSelectQueueCallback () (item);
       // otherwise, Linux determines the queue index by using a hash function
@@ -357,7 +368,9 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
       // so that subsequent packets of the same socket will be mapped to the
       // same tx queue (__netdev_pick_tx function in net/core/dev.c). It is
       // pointless to implement this in ns-3 because currently the multi-queue
-      // devices provide a select queue callback
+      // devices provide a select queue callback. If they do not, packets are
+      // associated with the first tx queue, unless the root queue disc steers
+      // them (e.g., DRR maps each flow to a tx queue)
     }
 
   NS_ASSERT (!devQueueIface || txq < devQueueIface->GetNTxQueues ());
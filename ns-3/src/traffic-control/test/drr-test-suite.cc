@@ -33,7 +33,26 @@
 #include "ns3/tcp-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/pointer.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/drr-flow-stats-sampler.h"
+#include "ns3/tbf-queue-disc.h"
+#include "ns3/data-rate.h"
+#include "ns3/output-stream-wrapper.h"
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -571,6 +590,1908 @@ DRRQueueDiscDeficitVariableSizeDifferentFlow::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * This class tests that the packet stealing mechanism picks the flow with the
+ * largest backlog after the backlogs changed because of dequeue operations
+ */
+
+class DRRQueueDiscFatFlowSelection : public TestCase
+{
+public:
+  DRRQueueDiscFatFlowSelection ();
+  virtual ~DRRQueueDiscFatFlowSelection ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr, uint32_t size);
+};
+
+DRRQueueDiscFatFlowSelection::DRRQueueDiscFatFlowSelection ()
+  : TestCase ("Test the selection of the fat flow")
+{
+}
+
+DRRQueueDiscFatFlowSelection::~DRRQueueDiscFatFlowSelection ()
+{
+}
+
+void
+DRRQueueDiscFatFlowSelection::AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+DRRQueueDiscFatFlowSelection::DoRun (void)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (3000));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Add three packets of 520 bytes from the first flow
+  hdr.SetPayloadSize (500);
+  AddPacket (queueDisc, hdr, 500);
+  AddPacket (queueDisc, hdr, 500);
+  AddPacket (queueDisc, hdr, 500);
+
+  // Add two packets of 720 bytes from the second flow
+  hdr.SetDestination (Ipv4Address ("10.10.1.3"));
+  hdr.SetPayloadSize (700);
+  AddPacket (queueDisc, hdr, 700);
+  AddPacket (queueDisc, hdr, 700);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNBytes (), 3000, "unexpected number of bytes in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNBytes (), 1560, "unexpected number of bytes in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNBytes (), 1440, "unexpected number of bytes in the second flow queue");
+
+  // Dequeue a packet from the first flow, which is no longer the fat flow
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNBytes (), 1040, "unexpected number of bytes in the first flow queue");
+
+  // Add two packets of 520 bytes from the third flow. The second one exceeds
+  // the limit and a packet must be stolen from the second flow
+  hdr.SetDestination (Ipv4Address ("10.10.1.4"));
+  hdr.SetPayloadSize (500);
+  AddPacket (queueDisc, hdr, 500);
+  AddPacket (queueDisc, hdr, 500);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNBytes (), 2800, "unexpected number of bytes in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (2)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the third flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP), 1, "unexpected number of overlimit drops");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that packets are dropped in batches from the fat flow
+ */
+
+class DRRQueueDiscDropBatch : public TestCase
+{
+public:
+  DRRQueueDiscDropBatch ();
+  virtual ~DRRQueueDiscDropBatch ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr);
+};
+
+DRRQueueDiscDropBatch::DRRQueueDiscDropBatch ()
+  : TestCase ("Test the drop of packets in batches from the fat flow")
+{
+}
+
+DRRQueueDiscDropBatch::~DRRQueueDiscDropBatch ()
+{
+}
+
+void
+DRRQueueDiscDropBatch::AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (500);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+DRRQueueDiscDropBatch::DoRun (void)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (3000),
+                                                                         "DropBatchSize", UintegerValue (64));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Add four packets from the first flow
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+
+  // Add two packets from the second flow. The second one exceeds the limit and
+  // half of the backlog of the first flow (1040 bytes, i.e., two packets) is dropped
+  hdr.SetDestination (Ipv4Address ("10.10.1.7"));
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 4, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the second flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP), 2, "unexpected number of overlimit drops");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().GetNDroppedBytes (DRRQueueDisc::OVERLIMIT_DROP), 1040, "unexpected number of overlimit dropped bytes");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the DRR scheduler reuses its flow queues, i.e., once
+ * all the flow queues have been created, packets are enqueued and dequeued
+ * through the flat flow table and the intrusive active list without creating
+ * flow queues. It does not count heap allocations, which are counted by the
+ * drr-benchmark example
+ */
+
+class DRRQueueDiscFlowReuse : public TestCase
+{
+public:
+  DRRQueueDiscFlowReuse ();
+  virtual ~DRRQueueDiscFlowReuse ();
+
+private:
+  virtual void DoRun (void);
+  void CheckFlowReuse (void);
+  Ptr<QueueDiscItem> CreateItem (uint32_t flow);
+};
+
+DRRQueueDiscFlowReuse::DRRQueueDiscFlowReuse ()
+  : TestCase ("Test that DRR reuses its flow queues")
+{
+}
+
+DRRQueueDiscFlowReuse::~DRRQueueDiscFlowReuse ()
+{
+}
+
+Ptr<QueueDiscItem>
+DRRQueueDiscFlowReuse::CreateItem (uint32_t flow)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+  hdr.SetProtocol (7);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (500), dest, 0, hdr);
+}
+
+void
+DRRQueueDiscFlowReuse::DoRun (void)
+{
+  Simulator::Schedule (Seconds (0), &DRRQueueDiscFlowReuse::CheckFlowReuse, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+DRRQueueDiscFlowReuse::CheckFlowReuse (void)
+{
+  const uint32_t nFlows = 8;
+  const uint32_t nRounds = 50;
+
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ();
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  // create all the flow queues
+  for (uint32_t f = 0; f < nFlows; f++)
+    {
+      queueDisc->Enqueue (CreateItem (f));
+    }
+  while (queueDisc->Dequeue ())
+    {
+    }
+  uint32_t nClasses = queueDisc->GetNQueueDiscClasses ();
+
+  // enqueue two packets per flow and dequeue them, for a number of rounds
+  uint32_t nDequeued = 0;
+  for (uint32_t r = 0; r < nRounds; r++)
+    {
+      for (uint32_t i = 0; i < 2 * nFlows; i++)
+        {
+          queueDisc->Enqueue (CreateItem (i % nFlows));
+        }
+      for (uint32_t i = 0; i < 2 * nFlows; i++)
+        {
+          nDequeued += queueDisc->Dequeue () ? 1 : 0;
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), nClasses, "no flow queue should have been created");
+  NS_TEST_EXPECT_MSG_EQ (nDequeued, 2 * nRounds * nFlows, "every packet should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "all the packets should have been dequeued");
+}
+
+/**
+ * This class tests that skipping rounds does not change the order in which
+ * packets are dequeued. The same random sequence of enqueue and dequeue
+ * operations, including packet stealing, is applied to a DRR queue disc
+ * visiting the flows one at a time and to a DRR queue disc skipping rounds
+ */
+
+class DRRQueueDiscSkipRoundsEquivalence : public TestCase
+{
+public:
+  DRRQueueDiscSkipRoundsEquivalence ();
+  virtual ~DRRQueueDiscSkipRoundsEquivalence ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<DRRQueueDisc> CreateQueueDisc (bool skipRounds, uint32_t dropBatchSize);
+  void RunDifferentialTest (uint32_t nFlows, uint32_t quantum, uint32_t dropBatchSize);
+};
+
+DRRQueueDiscSkipRoundsEquivalence::DRRQueueDiscSkipRoundsEquivalence ()
+  : TestCase ("Test that skipping rounds preserves the dequeue order")
+{
+}
+
+DRRQueueDiscSkipRoundsEquivalence::~DRRQueueDiscSkipRoundsEquivalence ()
+{
+}
+
+Ptr<DRRQueueDisc>
+DRRQueueDiscSkipRoundsEquivalence::CreateQueueDisc (bool skipRounds, uint32_t dropBatchSize)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (20000),
+                                                                         "DropBatchSize", UintegerValue (dropBatchSize),
+                                                                         "SkipRounds", BooleanValue (skipRounds));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  return queueDisc;
+}
+
+void
+DRRQueueDiscSkipRoundsEquivalence::RunDifferentialTest (uint32_t nFlows, uint32_t quantum, uint32_t dropBatchSize)
+{
+  Ptr<DRRQueueDisc> visiting = CreateQueueDisc (false, dropBatchSize);
+  Ptr<DRRQueueDisc> skipping = CreateQueueDisc (true, dropBatchSize);
+  visiting->SetQuantum (quantum);
+  skipping->SetQuantum (quantum);
+  // the flows whose packets are marked as AF21 have a larger quantum
+  visiting->SetDscpQuantum (Ipv4Header::DSCP_AF21, 3 * quantum);
+  skipping->SetDscpQuantum (Ipv4Header::DSCP_AF21, 3 * quantum);
+  visiting->Initialize ();
+  skipping->Initialize ();
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetProtocol (7);
+  Address dest;
+
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      // enqueue slightly more often than dequeue, so that the byte limit is reached
+      if (rng->GetValue () < 0.55)
+        {
+          uint32_t size = rng->GetInteger (40, 1500);
+          uint32_t flow = rng->GetInteger (0, nFlows - 1);
+          hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+          hdr.SetDscp (flow % 3 ? Ipv4Header::DscpDefault : Ipv4Header::DSCP_AF21);
+          hdr.SetPayloadSize (size);
+          Ptr<Packet> p = Create<Packet> (size);
+          visiting->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+          skipping->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+        }
+      else
+        {
+          Ptr<QueueDiscItem> item1 = visiting->Dequeue ();
+          Ptr<QueueDiscItem> item2 = skipping->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ ((item1 == 0), (item2 == 0), "only one queue disc dequeued a packet");
+          if (item1)
+            {
+              NS_TEST_ASSERT_MSG_EQ (item1->GetPacket (), item2->GetPacket (), "the queue discs dequeued different packets");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (visiting->QueueDisc::GetNBytes (), skipping->QueueDisc::GetNBytes (), "the backlogs differ");
+    }
+
+  while (Ptr<QueueDiscItem> item1 = visiting->Dequeue ())
+    {
+      Ptr<QueueDiscItem> item2 = skipping->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item2, 0, "the queue disc skipping rounds is empty too early");
+      NS_TEST_ASSERT_MSG_EQ (item1->GetPacket (), item2->GetPacket (), "the queue discs dequeued different packets");
+    }
+  NS_TEST_ASSERT_MSG_EQ (skipping->Dequeue (), 0, "the queue disc skipping rounds is not empty");
+
+  NS_TEST_EXPECT_MSG_GT (visiting->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP), 0, "no packet has been stolen");
+  NS_TEST_EXPECT_MSG_EQ (visiting->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP),
+                         skipping->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP),
+                         "the queue discs stole a different number of packets");
+
+  visiting->Dispose ();
+  skipping->Dispose ();
+}
+
+void
+DRRQueueDiscSkipRoundsEquivalence::DoRun (void)
+{
+  RunDifferentialTest (4, 600, 1);
+  RunDifferentialTest (50, 90, 1);
+  RunDifferentialTest (50, 600, 8);
+  RunDifferentialTest (300, 1500, 1);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the type and the attributes of the queue disc of the
+ * flow queues can be configured
+ */
+
+class DRRQueueDiscFlowQueueDiscType : public TestCase
+{
+public:
+  DRRQueueDiscFlowQueueDiscType ();
+  virtual ~DRRQueueDiscFlowQueueDiscType ();
+
+private:
+  virtual void DoRun (void);
+  void AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr);
+};
+
+DRRQueueDiscFlowQueueDiscType::DRRQueueDiscFlowQueueDiscType ()
+  : TestCase ("Test the configuration of the queue disc of the flow queues")
+{
+}
+
+DRRQueueDiscFlowQueueDiscType::~DRRQueueDiscFlowQueueDiscType ()
+{
+}
+
+void
+DRRQueueDiscFlowQueueDiscType::AddPacket (Ptr<DRRQueueDisc> queue, Ipv4Header hdr)
+{
+  Ptr<Packet> p = Create<Packet> (500);
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (p, dest, 0, hdr);
+  queue->Enqueue (item);
+}
+
+void
+DRRQueueDiscFlowQueueDiscType::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FifoQueueDisc");
+  factory.Set ("MaxSize", QueueSizeValue (QueueSize ("2p")));
+
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("FlowQueueDisc", ObjectFactoryValue (factory));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+
+  // Add three packets from the first flow, the last of which is dropped by the flow queue
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+  AddPacket (queueDisc, hdr);
+
+  // Add a packet from the second flow
+  hdr.SetDestination (Ipv4Address ("10.10.1.7"));
+  AddPacket (queueDisc, hdr);
+
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 2, "two flow queues should have been created");
+  NS_TEST_ASSERT_MSG_NE (DynamicCast<FifoQueueDisc> (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()), 0,
+                         "the flow queue disc should be a FIFO queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 3, "unexpected number of packets in the queue disc");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 2, "unexpected number of packets in the first flow queue");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetStats ().nTotalDroppedPacketsBeforeEnqueue, 1, "the flow queue should have dropped a packet");
+
+  // packets are served in round robin, one per round
+  Ptr<QueueDiscItem> item = queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->GetSize (), 500, "unexpected packet size");
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (0)->GetQueueDisc ()->GetNPackets (), 1, "unexpected number of packets in the first flow queue");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->GetQueueDiscClass (1)->GetQueueDisc ()->GetNPackets (), 0, "unexpected number of packets in the second flow queue");
+  queueDisc->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (queueDisc->QueueDisc::GetNPackets (), 0, "unexpected number of packets in the queue disc");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that flows are served in proportion to the quantum set for
+ * their DSCP or for their flow queue
+ */
+
+class DRRQueueDiscWeightedFairness : public TestCase
+{
+public:
+  DRRQueueDiscWeightedFairness ();
+  virtual ~DRRQueueDiscWeightedFairness ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Keep three flows backlogged, whose quanta are in the ratio 1:2:3, and check
+   * that the bytes dequeued from each flow are in the same ratio
+   * \param skipRounds whether the queue disc skips rounds
+   * \param fixedSize whether all the packets have the same size
+   */
+  void RunWeightedTest (bool skipRounds, bool fixedSize);
+};
+
+DRRQueueDiscWeightedFairness::DRRQueueDiscWeightedFairness ()
+  : TestCase ("Test the throughput ratios of flows with different quanta")
+{
+}
+
+DRRQueueDiscWeightedFairness::~DRRQueueDiscWeightedFairness ()
+{
+}
+
+void
+DRRQueueDiscWeightedFairness::RunWeightedTest (bool skipRounds, bool fixedSize)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (100000000),
+                                                                          "SkipRounds", BooleanValue (skipRounds));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+  queueDisc->SetQuantum (500);
+  queueDisc->Initialize ();
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // the first flow uses the default quantum, the second one the quantum of its
+  // DSCP and the third one the quantum of its flow queue, which takes precedence
+  // over the quantum of its DSCP
+  Ipv4Header hdr[3];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      hdr[i].SetSource (Ipv4Address ("10.10.1.1"));
+      hdr[i].SetDestination (Ipv4Address (0x0a0a0200 + i));
+      hdr[i].SetProtocol (7);
+    }
+  hdr[1].SetDscp (Ipv4Header::DSCP_AF21);
+  hdr[2].SetDscp (Ipv4Header::DSCP_AF21);
+  queueDisc->SetDscpQuantum (Ipv4Header::DSCP_AF21, 1000);
+
+  Address dest;
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (Create<Packet> (480), dest, 0, hdr[2]);
+  queueDisc->SetFlowQuantum (ipv4Filter->Classify (item) % 1024, 1500);
+
+  // the flow queues (CoDel queue discs) hold up to 1500 packets
+  const uint32_t nPackets = 1500;
+  for (uint32_t n = 0; n < nPackets; n++)
+    {
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          // the size of the queue disc items is the size of the packet plus 20 bytes
+          uint32_t size = fixedSize ? 480 : rng->GetInteger (20, 1480);
+          hdr[i].SetPayloadSize (size);
+          queueDisc->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (size), dest, 0, hdr[i]));
+        }
+    }
+
+  // all the flows stay backlogged, since the third flow is served at most half the time
+  uint64_t bytes[3] = {0, 0, 0};
+  for (uint32_t n = 0; n < nPackets; n++)
+    {
+      item = DynamicCast<Ipv4QueueDiscItem> (queueDisc->Dequeue ());
+      NS_TEST_ASSERT_MSG_NE (item, 0, "the queue disc should not be empty");
+      bytes[item->GetHeader ().GetDestination ().Get () - 0x0a0a0200] += item->GetSize ();
+    }
+
+  if (fixedSize)
+    {
+      // each round, the flows send one, two and three packets, respectively
+      NS_TEST_EXPECT_MSG_EQ (bytes[0], 250 * 500, "unexpected number of bytes dequeued from the first flow");
+      NS_TEST_EXPECT_MSG_EQ (bytes[1], 500 * 500, "unexpected number of bytes dequeued from the second flow");
+      NS_TEST_EXPECT_MSG_EQ (bytes[2], 750 * 500, "unexpected number of bytes dequeued from the third flow");
+    }
+  else
+    {
+      // the bytes sent by a flow differ from the sum of its quanta by less than
+      // a packet, i.e., by less than 1% after about 380 rounds
+      NS_TEST_EXPECT_MSG_EQ_TOL (bytes[1] / (double) bytes[0], 2.0, 0.05, "unexpected throughput ratio of the second flow");
+      NS_TEST_EXPECT_MSG_EQ_TOL (bytes[2] / (double) bytes[0], 3.0, 0.075, "unexpected throughput ratio of the third flow");
+    }
+
+  queueDisc->Dispose ();
+}
+
+void
+DRRQueueDiscWeightedFairness::DoRun (void)
+{
+  RunWeightedTest (false, true);
+  RunWeightedTest (true, true);
+  RunWeightedTest (false, false);
+  RunWeightedTest (true, false);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the ports read from the packet buffer match those of
+ * the transport headers and that the hash of the 5-tuple is cached
+ */
+
+class DRRQueueDiscTransportPorts : public TestCase
+{
+public:
+  DRRQueueDiscTransportPorts ();
+  virtual ~DRRQueueDiscTransportPorts ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DRRQueueDiscTransportPorts::DRRQueueDiscTransportPorts ()
+  : TestCase ("Test the extraction of the ports and the hash cache")
+{
+}
+
+DRRQueueDiscTransportPorts::~DRRQueueDiscTransportPorts ()
+{
+}
+
+void
+DRRQueueDiscTransportPorts::DoRun (void)
+{
+  Address dest;
+  uint16_t srcPort, destPort;
+
+  // IPv4 item carrying a TCP segment
+  TcpHeader tcpHdr;
+  tcpHdr.SetSourcePort (40000);
+  tcpHdr.SetDestinationPort (80);
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (tcpHdr);
+  Ipv4Header ipv4Hdr;
+  ipv4Hdr.SetPayloadSize (p->GetSize ());
+  ipv4Hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  ipv4Hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  ipv4Hdr.SetProtocol (6);
+  Ptr<Ipv4QueueDiscItem> ipv4Item = Create<Ipv4QueueDiscItem> (p, dest, 0, ipv4Hdr);
+
+  NS_TEST_ASSERT_MSG_EQ (ipv4Item->GetTransportPorts (srcPort, destPort), true, "the ports of a TCP segment should be read");
+  NS_TEST_EXPECT_MSG_EQ (srcPort, 40000, "unexpected source port");
+  NS_TEST_EXPECT_MSG_EQ (destPort, 80, "unexpected destination port");
+
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  uint32_t hash = static_cast<uint32_t> (ipv4Filter->Classify (ipv4Item));
+  NS_TEST_EXPECT_MSG_EQ (hash, ipv4Item->Hash (0), "the filter should return the hash of the 5-tuple");
+  NS_TEST_EXPECT_MSG_NE (ipv4Item->Hash (1), hash, "the perturbation should change the hash");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (ipv4Filter->Classify (ipv4Item)), hash, "a packet should be classified consistently");
+
+  // the ports of a packet including the IPv4 header are read after the header
+  ipv4Item->AddHeader ();
+  NS_TEST_ASSERT_MSG_EQ (ipv4Item->GetTransportPorts (srcPort, destPort), true, "the ports of a TCP segment should be read");
+  NS_TEST_EXPECT_MSG_EQ (srcPort, 40000, "unexpected source port");
+  NS_TEST_EXPECT_MSG_EQ (destPort, 80, "unexpected destination port");
+
+  // non-first fragments carry no transport header
+  ipv4Hdr.SetFragmentOffset (8);
+  ipv4Item = Create<Ipv4QueueDiscItem> (Create<Packet> (100), dest, 0, ipv4Hdr);
+  NS_TEST_EXPECT_MSG_EQ (ipv4Item->GetTransportPorts (srcPort, destPort), false, "a fragment should have no ports");
+
+  // IPv6 item carrying a UDP datagram
+  UdpHeader udpHdr;
+  udpHdr.SetSourcePort (5000);
+  udpHdr.SetDestinationPort (53);
+  p = Create<Packet> (100);
+  p->AddHeader (udpHdr);
+  Ipv6Header ipv6Hdr;
+  ipv6Hdr.SetPayloadLength (p->GetSize ());
+  ipv6Hdr.SetSourceAddress (Ipv6Address ("2001:db8::1"));
+  ipv6Hdr.SetDestinationAddress (Ipv6Address ("2001:db8::2"));
+  ipv6Hdr.SetNextHeader (17);
+  Ptr<Ipv6QueueDiscItem> ipv6Item = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Hdr);
+
+  NS_TEST_ASSERT_MSG_EQ (ipv6Item->GetTransportPorts (srcPort, destPort), true, "the ports of a UDP datagram should be read");
+  NS_TEST_EXPECT_MSG_EQ (srcPort, 5000, "unexpected source port");
+  NS_TEST_EXPECT_MSG_EQ (destPort, 53, "unexpected destination port");
+
+  Ptr<DRRIpv6PacketFilter> ipv6Filter = CreateObject<DRRIpv6PacketFilter> ();
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) ipv6Filter->Classify (ipv6Item), ipv6Item->Hash (0), "the filter should return the hash of the 5-tuple");
+
+  // the ports are part of the 5-tuple
+  udpHdr.SetSourcePort (5001);
+  p = Create<Packet> (100);
+  p->AddHeader (udpHdr);
+  Ptr<Ipv6QueueDiscItem> otherItem = Create<Ipv6QueueDiscItem> (p, dest, 0, ipv6Hdr);
+  NS_TEST_EXPECT_MSG_NE (otherItem->Hash (0), ipv6Item->Hash (0), "different ports should give a different hash");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests the collision counter and the periodic change of the salt
+ * of the hash function, which must preserve the order of the packets of a flow
+ */
+
+class DRRQueueDiscHashPerturbation : public TestCase
+{
+public:
+  DRRQueueDiscHashPerturbation ();
+  virtual ~DRRQueueDiscHashPerturbation ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet of the given flow
+   * \param queue the queue disc
+   * \param flow the flow index
+   */
+  void AddPacket (Ptr<DRRQueueDisc> queue, uint32_t flow);
+  /**
+   * Dequeue a packet and check that it follows the last packet of its flow
+   * \param queue the queue disc
+   * \return true if a packet has been dequeued
+   */
+  bool RemovePacket (Ptr<DRRQueueDisc> queue);
+  /**
+   * Get the number of packets in each flow queue
+   * \param queue the queue disc
+   * \return the number of packets in each flow queue
+   */
+  std::vector<uint32_t> GetOccupancy (Ptr<DRRQueueDisc> queue);
+  /**
+   * Enqueue packets after the salt has changed and check that the packets
+   * queued with the previous salt have been moved to other flow queues
+   * \param queue the queue disc
+   */
+  void CheckRehash (Ptr<DRRQueueDisc> queue);
+  /**
+   * Enqueue and dequeue packets while the packets are migrated, then drain
+   * the queue disc
+   * \param queue the queue disc
+   */
+  void CheckOrder (Ptr<DRRQueueDisc> queue);
+  /**
+   * Run the test with a salt changing every second
+   * \param skipRounds whether the queue disc skips rounds
+   */
+  void RunPerturbationTest (bool skipRounds);
+
+  static const uint32_t m_nFlows = 20;  //!< number of flows
+  std::vector<uint64_t> m_lastUid;      //!< uid of the last dequeued packet of each flow
+  uint32_t m_nEnqueued;                 //!< number of enqueued packets
+  uint32_t m_nDequeued;                 //!< number of dequeued packets
+};
+
+DRRQueueDiscHashPerturbation::DRRQueueDiscHashPerturbation ()
+  : TestCase ("Test the hash collisions and the change of the hash salt")
+{
+}
+
+DRRQueueDiscHashPerturbation::~DRRQueueDiscHashPerturbation ()
+{
+}
+
+void
+DRRQueueDiscHashPerturbation::AddPacket (Ptr<DRRQueueDisc> queue, uint32_t flow)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+  hdr.SetProtocol (7);
+  Ptr<Packet> p = Create<Packet> (500);
+  Address dest;
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+  m_nEnqueued++;
+}
+
+bool
+DRRQueueDiscHashPerturbation::RemovePacket (Ptr<DRRQueueDisc> queue)
+{
+  Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+  if (!item)
+    {
+      return false;
+    }
+  m_nDequeued++;
+  uint32_t flow = item->GetHeader ().GetDestination ().Get () - 0x0a0a0200;
+  uint64_t uid = item->GetPacket ()->GetUid ();
+  NS_TEST_EXPECT_MSG_GT (uid, m_lastUid[flow], "the packets of flow " << flow << " have been reordered");
+  m_lastUid[flow] = uid;
+  return true;
+}
+
+std::vector<uint32_t>
+DRRQueueDiscHashPerturbation::GetOccupancy (Ptr<DRRQueueDisc> queue)
+{
+  std::vector<uint32_t> occupancy;
+  for (uint32_t i = 0; i < queue->GetNQueueDiscClasses (); i++)
+    {
+      occupancy.push_back (queue->GetQueueDiscClass (i)->GetQueueDisc ()->GetNPackets ());
+    }
+  return occupancy;
+}
+
+void
+DRRQueueDiscHashPerturbation::CheckRehash (Ptr<DRRQueueDisc> queue)
+{
+  std::vector<uint32_t> before = GetOccupancy (queue);
+
+  // there are no more flow queues to migrate than flow queues
+  for (uint32_t i = 0; i < before.size (); i++)
+    {
+      AddPacket (queue, 0);
+    }
+
+  std::vector<uint32_t> after = GetOccupancy (queue);
+  uint32_t moved = 0;
+  for (uint32_t i = 0; i < before.size (); i++)
+    {
+      moved += (after[i] > before[i] ? after[i] - before[i] : before[i] - after[i]);
+    }
+  NS_TEST_EXPECT_MSG_GT (moved, before.size (), "the packets should have been moved to other flow queues");
+  NS_TEST_EXPECT_MSG_EQ (queue->QueueDisc::GetNPackets (), m_nEnqueued, "no packet should have been lost");
+}
+
+void
+DRRQueueDiscHashPerturbation::CheckOrder (Ptr<DRRQueueDisc> queue)
+{
+  for (uint32_t i = 0; i < 20 * m_nFlows; i++)
+    {
+      AddPacket (queue, i % m_nFlows);
+      RemovePacket (queue);
+    }
+  while (RemovePacket (queue))
+    {
+    }
+}
+
+void
+DRRQueueDiscHashPerturbation::RunPerturbationTest (bool skipRounds)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FifoQueueDisc");
+  factory.Set ("MaxSize", QueueSizeValue (QueueSize ("10000p")));
+
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (8),
+                                                                          "SkipRounds", BooleanValue (skipRounds),
+                                                                          "FlowQueueDisc", ObjectFactoryValue (factory),
+                                                                          "PerturbationPeriod", TimeValue (Seconds (1)));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+  queueDisc->SetQuantum (600);
+  queueDisc->AssignStreams (1);
+  queueDisc->Initialize ();
+
+  m_lastUid.assign (m_nFlows, 0);
+  m_nEnqueued = 0;
+  m_nDequeued = 0;
+
+  for (uint32_t i = 0; i < 10 * m_nFlows; i++)
+    {
+      AddPacket (queueDisc, i % m_nFlows);
+    }
+
+  // the salt changes at 1s and 2s
+  Simulator::Schedule (Seconds (1.5), &DRRQueueDiscHashPerturbation::CheckRehash, this, queueDisc);
+  Simulator::Schedule (Seconds (2.5), &DRRQueueDiscHashPerturbation::CheckOrder, this, queueDisc);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  QueueDisc::Stats st = queueDisc->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_nDequeued, m_nEnqueued, "all the packets should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalEnqueuedPackets, m_nEnqueued, "moved packets should not be counted as enqueued");
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalDequeuedPackets, m_nDequeued, "moved packets should not be counted as dequeued");
+  NS_TEST_EXPECT_MSG_EQ (st.nTotalDroppedPackets, 0, "no packet should have been dropped");
+
+  Simulator::Destroy ();
+}
+
+void
+DRRQueueDiscHashPerturbation::DoRun (void)
+{
+  // all the flows share the same flow queue, hence a packet collides if the
+  // flow queue holds packets of another flow
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (1));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  m_nEnqueued = 0;
+  AddPacket (queueDisc, 0);
+  AddPacket (queueDisc, 1);
+  AddPacket (queueDisc, 0);
+  AddPacket (queueDisc, 1);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 2, "the packets of the second flow should have collided");
+
+  // once the flow queue is empty, the next flow takes it over
+  while (queueDisc->Dequeue ())
+    {
+    }
+  AddPacket (queueDisc, 1);
+  AddPacket (queueDisc, 0);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 3, "the packet of the first flow should have collided");
+  Simulator::Destroy ();
+
+  // the perturbation is an input of the hash function
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address ("10.10.1.2"));
+  hdr.SetProtocol (7);
+  Address dest;
+  Ptr<DRRIpv4PacketFilter> salted = CreateObjectWithAttributes<DRRIpv4PacketFilter> ("Perturbation", UintegerValue (1));
+  int32_t ret = ipv4Filter->Classify (Create<Ipv4QueueDiscItem> (Create<Packet> (100), dest, 0, hdr));
+  int32_t saltedRet = salted->Classify (Create<Ipv4QueueDiscItem> (Create<Packet> (100), dest, 0, hdr));
+  NS_TEST_EXPECT_MSG_NE (saltedRet, ret, "the perturbation should change the hash");
+
+  RunPerturbationTest (false);
+  RunPerturbationTest (true);
+}
+
+/**
+ * This class tests that the ways of a set-associative flow table are allocated
+ * to distinct flows
+ */
+
+class DRRQueueDiscSetAssociativeFlowTable : public TestCase
+{
+public:
+  DRRQueueDiscSetAssociativeFlowTable ();
+  virtual ~DRRQueueDiscSetAssociativeFlowTable ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet of the given flow
+   * \param queue the queue disc
+   * \param flow the flow index
+   */
+  void AddPacket (Ptr<DRRQueueDisc> queue, uint32_t flow);
+  /**
+   * Enqueue a packet of each of the given number of flows into a queue disc
+   * with the given number of flow queues and ways
+   * \param flows the number of flow queues
+   * \param ways the number of ways of each set
+   * \param nFlows the number of flows
+   * \return the queue disc
+   */
+  Ptr<DRRQueueDisc> FillQueueDisc (uint32_t flows, uint32_t ways, uint32_t nFlows);
+};
+
+DRRQueueDiscSetAssociativeFlowTable::DRRQueueDiscSetAssociativeFlowTable ()
+  : TestCase ("Test the allocation of the ways of a set-associative flow table")
+{
+}
+
+DRRQueueDiscSetAssociativeFlowTable::~DRRQueueDiscSetAssociativeFlowTable ()
+{
+}
+
+void
+DRRQueueDiscSetAssociativeFlowTable::AddPacket (Ptr<DRRQueueDisc> queue, uint32_t flow)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+  hdr.SetProtocol (7);
+  Ptr<Packet> p = Create<Packet> (500);
+  Address dest;
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+}
+
+Ptr<DRRQueueDisc>
+DRRQueueDiscSetAssociativeFlowTable::FillQueueDisc (uint32_t flows, uint32_t ways, uint32_t nFlows)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("Flows", UintegerValue (flows),
+                                                                          "Ways", UintegerValue (ways));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      AddPacket (queueDisc, i);
+    }
+  return queueDisc;
+}
+
+void
+DRRQueueDiscSetAssociativeFlowTable::DoRun (void)
+{
+  // with a direct-mapped flow table, some of the 16 flows share a flow queue
+  Ptr<DRRQueueDisc> queueDisc = FillQueueDisc (16, 1, 16);
+  NS_TEST_EXPECT_MSG_LT (queueDisc->GetNQueueDiscClasses (), 16, "some flows should share a flow queue");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 16 - queueDisc->GetNQueueDiscClasses (),
+                         "a packet should collide for each shared flow queue");
+  Simulator::Destroy ();
+
+  // with a single set of 16 ways, every flow gets its own flow queue
+  queueDisc = FillQueueDisc (16, 16, 16);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 16, "every flow should get a flow queue");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 0, "no packet should collide");
+
+  // the packets of a flow go into its way
+  AddPacket (queueDisc, 3);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 16, "no flow queue should be created");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 0, "no packet should collide");
+  uint32_t maxBacklog = 0;
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      maxBacklog = std::max (maxBacklog, queueDisc->GetQueueDiscClass (i)->GetQueueDisc ()->GetNPackets ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (maxBacklog, 2, "the two packets of the flow should be in the same flow queue");
+
+  // once all the ways are allocated, the packets of a new flow collide
+  AddPacket (queueDisc, 16);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNQueueDiscClasses (), 16, "no flow queue should be created");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 1, "the packet of the new flow should collide");
+
+  // the ways freed by the flows that leave are allocated to new flows
+  while (queueDisc->Dequeue ())
+    {
+    }
+  AddPacket (queueDisc, 17);
+  AddPacket (queueDisc, 18);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalCollidedPackets, 1, "no further packet should collide");
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that, on a multi-queue device, the packets of a flow are
+ * sent to the same transmission queue and that the flows whose transmission
+ * queue is stopped do not prevent the other flows from being served
+ */
+
+class DRRQueueDiscMultiQueue : public TestCase
+{
+public:
+  DRRQueueDiscMultiQueue ();
+  virtual ~DRRQueueDiscMultiQueue ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet of the given flow through the traffic control layer
+   * \param tc the traffic control layer
+   * \param dev the device
+   * \param flow the flow index
+   */
+  void SendPacket (Ptr<TrafficControlLayer> tc, Ptr<NetDevice> dev, uint32_t flow);
+  /**
+   * Record the transmission queue of a dequeued packet
+   * \param item the dequeued packet
+   */
+  void Dequeued (Ptr<const QueueDiscItem> item);
+
+  std::map<uint32_t, uint8_t> m_txQueues;  //!< transmission queue of each flow
+  uint32_t m_dequeued[2];                  //!< number of packets dequeued for each transmission queue
+  bool m_consistent;                       //!< whether the packets of each flow went to the same transmission queue
+};
+
+DRRQueueDiscMultiQueue::DRRQueueDiscMultiQueue ()
+  : TestCase ("Test the mapping of the flows to the transmission queues of a multi-queue device")
+{
+}
+
+DRRQueueDiscMultiQueue::~DRRQueueDiscMultiQueue ()
+{
+}
+
+void
+DRRQueueDiscMultiQueue::SendPacket (Ptr<TrafficControlLayer> tc, Ptr<NetDevice> dev, uint32_t flow)
+{
+  Ipv4Header hdr;
+  hdr.SetPayloadSize (500);
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+  hdr.SetProtocol (7);
+  Ptr<Packet> p = Create<Packet> (500);
+  tc->Send (dev, Create<Ipv4QueueDiscItem> (p, dev->GetBroadcast (), 0x0800, hdr));
+}
+
+void
+DRRQueueDiscMultiQueue::Dequeued (Ptr<const QueueDiscItem> item)
+{
+  Ipv4Header hdr = DynamicCast<const Ipv4QueueDiscItem> (item)->GetHeader ();
+  uint32_t flow = hdr.GetDestination ().Get () - 0x0a0a0200;
+  uint8_t txq = item->GetTxQueueIndex ();
+
+  std::map<uint32_t, uint8_t>::iterator it = m_txQueues.find (flow);
+  if (it == m_txQueues.end ())
+    {
+      m_txQueues[flow] = txq;
+    }
+  else if (it->second != txq)
+    {
+      m_consistent = false;
+    }
+  m_dequeued[txq]++;
+}
+
+void
+DRRQueueDiscMultiQueue::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::Allocate ());
+  dev->SetChannel (CreateObject<SimpleChannel> ());
+  dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  node->AddDevice (dev);
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObjectWithAttributes<NetDeviceQueueInterface> ("NTxQueues", UintegerValue (2));
+  dev->AggregateObject (ndqi);
+
+  Ptr<DRRQueueDisc> queueDisc = CreateObject<DRRQueueDisc> ();
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->TraceConnectWithoutContext ("Dequeue", MakeCallback (&DRRQueueDiscMultiQueue::Dequeued, this));
+  tc->SetRootQueueDiscOnDevice (dev, queueDisc);
+  tc->Initialize ();
+
+  m_dequeued[0] = m_dequeued[1] = 0;
+  m_consistent = true;
+
+  // the second transmission queue is stopped, hence only the packets of the
+  // flows mapped to the first transmission queue are sent
+  ndqi->GetTxQueue (1)->Stop ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      for (uint32_t flow = 0; flow < 8; flow++)
+        {
+          SendPacket (tc, dev, flow);
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (m_dequeued[0], 0, "packets should have been sent to the first transmission queue");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued[1], 0, "no packet should have been sent to the stopped transmission queue");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNPackets (), 24 - m_dequeued[0],
+                         "the packets for the stopped transmission queue should be kept by the queue disc");
+  NS_TEST_EXPECT_MSG_GT (queueDisc->GetNPackets (), 0, "some flows should be mapped to the second transmission queue");
+
+  // waking the second transmission queue runs the queue disc again
+  ndqi->GetTxQueue (1)->Wake ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNPackets (), 0, "all the packets should have been sent");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued[0] + m_dequeued[1], 24, "all the packets should have been dequeued");
+  NS_TEST_EXPECT_MSG_EQ (m_consistent, true, "the packets of a flow should be sent to the same transmission queue");
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetStats ().nTotalRequeuedPackets, 0, "no packet should have been requeued");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the latency-critical flows (DRR+) are served before
+ * the other flows, one packet per turn, and that a latency-critical flow
+ * holding more than one quantum is demoted to a regular flow
+ */
+
+class DRRQueueDiscLatencyCritical : public TestCase
+{
+public:
+  DRRQueueDiscLatencyCritical ();
+  virtual ~DRRQueueDiscLatencyCritical ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet
+   * \param queue the queue disc
+   * \param dst the last byte of the destination address, identifying the flow
+   * \param dscp the DSCP of the packet
+   * \param size the size of the queue disc item
+   */
+  void AddPacket (Ptr<DRRQueueDisc> queue, uint8_t dst, Ipv4Header::DscpType dscp, uint32_t size);
+  /**
+   * Dequeue a packet and check its flow
+   * \param queue the queue disc
+   * \param dst the last byte of the destination address of the expected flow
+   */
+  void CheckDequeue (Ptr<DRRQueueDisc> queue, uint8_t dst);
+  /**
+   * Check the service of the latency-critical flows
+   * \param skipRounds whether the queue disc skips rounds
+   */
+  void RunLatencyCriticalTest (bool skipRounds);
+};
+
+DRRQueueDiscLatencyCritical::DRRQueueDiscLatencyCritical ()
+  : TestCase ("Test the priority of the latency-critical flows and their policing")
+{
+}
+
+DRRQueueDiscLatencyCritical::~DRRQueueDiscLatencyCritical ()
+{
+}
+
+void
+DRRQueueDiscLatencyCritical::AddPacket (Ptr<DRRQueueDisc> queue, uint8_t dst, Ipv4Header::DscpType dscp, uint32_t size)
+{
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + dst));
+  hdr.SetProtocol (7);
+  hdr.SetDscp (dscp);
+  // the size of the queue disc items is the size of the packet plus 20 bytes
+  hdr.SetPayloadSize (size - 20);
+  Address dest;
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (size - 20), dest, 0, hdr));
+}
+
+void
+DRRQueueDiscLatencyCritical::CheckDequeue (Ptr<DRRQueueDisc> queue, uint8_t dst)
+{
+  Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+  NS_TEST_ASSERT_MSG_NE (item, 0, "the queue disc should not be empty");
+  NS_TEST_EXPECT_MSG_EQ (item->GetHeader ().GetDestination ().Get () - 0x0a0a0200, dst,
+                         "the packet was dequeued from an unexpected flow");
+}
+
+void
+DRRQueueDiscLatencyCritical::RunLatencyCriticalTest (bool skipRounds)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("SkipRounds", BooleanValue (skipRounds));
+  Ptr<DRRIpv4PacketFilter> ipv4Filter = CreateObject<DRRIpv4PacketFilter> ();
+  queueDisc->AddPacketFilter (ipv4Filter);
+  queueDisc->SetQuantum (600);
+  queueDisc->SetDscpLatencyCritical (Ipv4Header::DSCP_EF, true);
+  queueDisc->Initialize ();
+
+  // the bulk flow 1 becomes active first, then the latency-critical flows 2
+  // and 3 become active and hold two packets each, i.e., less than a quantum
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      AddPacket (queueDisc, 1, Ipv4Header::DscpDefault, 600);
+    }
+  AddPacket (queueDisc, 2, Ipv4Header::DSCP_EF, 200);
+  AddPacket (queueDisc, 3, Ipv4Header::DSCP_EF, 200);
+  AddPacket (queueDisc, 2, Ipv4Header::DSCP_EF, 200);
+  AddPacket (queueDisc, 3, Ipv4Header::DSCP_EF, 200);
+
+  // the latency-critical flows are served first, one packet per turn
+  CheckDequeue (queueDisc, 2);
+  CheckDequeue (queueDisc, 3);
+  CheckDequeue (queueDisc, 2);
+  CheckDequeue (queueDisc, 3);
+  CheckDequeue (queueDisc, 1);
+
+  // a latency-critical flow becoming active while a bulk flow is served is
+  // served next
+  AddPacket (queueDisc, 2, Ipv4Header::DSCP_EF, 200);
+  CheckDequeue (queueDisc, 2);
+  CheckDequeue (queueDisc, 1);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNDemotedFlows (), 0, "no flow should have been demoted");
+
+  // the latency-critical flow 3 holds more than one quantum and is demoted,
+  // hence it is served in turn with the bulk flow 1, whose deficit is exhausted
+  AddPacket (queueDisc, 3, Ipv4Header::DSCP_EF, 400);
+  AddPacket (queueDisc, 3, Ipv4Header::DSCP_EF, 400);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNDemotedFlows (), 1, "the abusive flow should have been demoted");
+  CheckDequeue (queueDisc, 3);
+  CheckDequeue (queueDisc, 1);
+  CheckDequeue (queueDisc, 3);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNPackets (), 0, "the queue disc should be empty");
+
+  // the flow queue setting takes precedence over the DSCP setting
+  Address dest;
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + 4));
+  hdr.SetProtocol (7);
+  Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (Create<Packet> (180), dest, 0, hdr);
+  queueDisc->SetFlowLatencyCritical (static_cast<uint32_t> (ipv4Filter->Classify (item)) % 1024, false);
+  AddPacket (queueDisc, 4, Ipv4Header::DSCP_EF, 200);
+  AddPacket (queueDisc, 2, Ipv4Header::DSCP_EF, 200);
+  CheckDequeue (queueDisc, 2);
+  CheckDequeue (queueDisc, 4);
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetNPackets (), 0, "the queue disc should be empty");
+
+  queueDisc->Dispose ();
+}
+
+void
+DRRQueueDiscLatencyCritical::DoRun (void)
+{
+  RunLatencyCriticalTest (false);
+  RunLatencyCriticalTest (true);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that the flow queues that have been idle for IdleTimeout
+ * are released and reused for new flows
+ */
+
+class DRRQueueDiscIdleFlows : public TestCase
+{
+public:
+  DRRQueueDiscIdleFlows ();
+  virtual ~DRRQueueDiscIdleFlows ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet of each of the given flows
+   * \param queue the queue disc
+   * \param first the index of the first flow
+   * \param n the number of flows
+   */
+  void AddPackets (Ptr<DRRQueueDisc> queue, uint32_t first, uint32_t n);
+  /**
+   * Enqueue a packet of 100 flows, dequeue them, then enqueue a packet of 50
+   * other flows after two seconds
+   * \param idleTimeout the value of the IdleTimeout attribute
+   * \param lightweightFlows the value of the LightweightFlows attribute
+   */
+  void RunIdleFlowsTest (Time idleTimeout, bool lightweightFlows);
+  /**
+   * Enqueue a packet of the 50 other flows and check the number of flow queues
+   * \param queue the queue disc
+   * \param idleTimeout the value of the IdleTimeout attribute
+   */
+  void AddNewFlows (Ptr<DRRQueueDisc> queue, Time idleTimeout);
+
+  uint32_t m_nFlowQueues;        //!< number of flow queues created by the first flows
+  std::size_t m_footprint;       //!< memory footprint once the first flows are idle
+};
+
+DRRQueueDiscIdleFlows::DRRQueueDiscIdleFlows ()
+  : TestCase ("Test the release and the reuse of the idle flow queues")
+{
+}
+
+DRRQueueDiscIdleFlows::~DRRQueueDiscIdleFlows ()
+{
+}
+
+void
+DRRQueueDiscIdleFlows::AddPackets (Ptr<DRRQueueDisc> queue, uint32_t first, uint32_t n)
+{
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      Ipv4Header hdr;
+      hdr.SetPayloadSize (500);
+      hdr.SetSource (Ipv4Address ("10.10.1.1"));
+      hdr.SetDestination (Ipv4Address (0x0a0a0200 + i));
+      hdr.SetProtocol (7);
+      Address dest;
+      queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (500), dest, 0, hdr));
+    }
+}
+
+void
+DRRQueueDiscIdleFlows::AddNewFlows (Ptr<DRRQueueDisc> queue, Time idleTimeout)
+{
+  // the first packet releases the idle flow queues, if any
+  AddPackets (queue, 100, 1);
+  if (!idleTimeout.IsZero ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNReleasedFlows (), m_nFlowQueues, "every idle flow queue should be released");
+      NS_TEST_EXPECT_MSG_LT (queue->GetMemoryFootprint (), m_footprint,
+                             "releasing the idle flow queues should reduce the memory footprint");
+    }
+
+  AddPackets (queue, 101, 49);
+  if (idleTimeout.IsZero ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNReleasedFlows (), 0, "no flow queue should be released");
+      NS_TEST_EXPECT_MSG_GT (queue->GetNQueueDiscClasses (), m_nFlowQueues,
+                             "new flow queues should be created for the new flows");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNQueueDiscClasses (), m_nFlowQueues,
+                             "the released flow queues should be reused for the new flows");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 50, "every packet should be queued");
+
+  uint32_t nPackets = 0;
+  while (queue->Dequeue ())
+    {
+      nPackets++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nPackets, 50, "every packet should be dequeued");
+}
+
+void
+DRRQueueDiscIdleFlows::RunIdleFlowsTest (Time idleTimeout, bool lightweightFlows)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("IdleTimeout", TimeValue (idleTimeout),
+                                                                          "LightweightFlows", BooleanValue (lightweightFlows));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  AddPackets (queueDisc, 0, 100);
+  m_nFlowQueues = queueDisc->GetNQueueDiscClasses ();
+  while (queueDisc->Dequeue ())
+    {
+    }
+  m_footprint = queueDisc->GetMemoryFootprint ();
+
+  Simulator::Schedule (Seconds (2), &DRRQueueDiscIdleFlows::AddNewFlows, this, queueDisc, idleTimeout);
+  Simulator::Run ();
+
+  queueDisc->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+DRRQueueDiscIdleFlows::DoRun (void)
+{
+  RunIdleFlowsTest (Seconds (0), false);
+  RunIdleFlowsTest (Seconds (1), false);
+  RunIdleFlowsTest (Seconds (0), true);
+  RunIdleFlowsTest (Seconds (1), true);
+}
+
+/**
+ * This class tests that the flow queues storing their packets in a FIFO queue
+ * (LightweightFlows) behave as flow queues with a FIFO queue disc, without
+ * creating a queue disc per flow queue
+ */
+
+class DRRQueueDiscLightweightFlows : public TestCase
+{
+public:
+  DRRQueueDiscLightweightFlows ();
+  virtual ~DRRQueueDiscLightweightFlows ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Apply the same random sequence of enqueue and dequeue operations, including
+   * packet stealing, to a DRR queue disc with FIFO queue discs and to a DRR
+   * queue disc with lightweight flows
+   * \param nFlows the number of flows
+   * \param skipRounds whether the queue discs skip rounds
+   */
+  void RunDifferentialTest (uint32_t nFlows, bool skipRounds);
+};
+
+DRRQueueDiscLightweightFlows::DRRQueueDiscLightweightFlows ()
+  : TestCase ("Test that lightweight flow queues behave as FIFO queue discs")
+{
+}
+
+DRRQueueDiscLightweightFlows::~DRRQueueDiscLightweightFlows ()
+{
+}
+
+void
+DRRQueueDiscLightweightFlows::RunDifferentialTest (uint32_t nFlows, bool skipRounds)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FifoQueueDisc");
+  Ptr<DRRQueueDisc> fifo = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (20000),
+                                                                    "SkipRounds", BooleanValue (skipRounds),
+                                                                    "FlowQueueDisc", ObjectFactoryValue (factory));
+  Ptr<DRRQueueDisc> lightweight = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (20000),
+                                                                           "SkipRounds", BooleanValue (skipRounds),
+                                                                           "LightweightFlows", BooleanValue (true));
+  fifo->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  lightweight->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  fifo->SetQuantum (600);
+  lightweight->SetQuantum (600);
+  fifo->Initialize ();
+  lightweight->Initialize ();
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetProtocol (7);
+  Address dest;
+
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      // enqueue slightly more often than dequeue, so that the byte limit is reached
+      if (rng->GetValue () < 0.55)
+        {
+          uint32_t size = rng->GetInteger (40, 1500);
+          hdr.SetDestination (Ipv4Address (0x0a0a0200 + rng->GetInteger (0, nFlows - 1)));
+          hdr.SetPayloadSize (size);
+          Ptr<Packet> p = Create<Packet> (size);
+          fifo->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+          lightweight->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+        }
+      else
+        {
+          Ptr<const QueueDiscItem> peeked = lightweight->Peek ();
+          Ptr<QueueDiscItem> item1 = fifo->Dequeue ();
+          Ptr<QueueDiscItem> item2 = lightweight->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ ((item1 == 0), (item2 == 0), "only one queue disc dequeued a packet");
+          NS_TEST_ASSERT_MSG_EQ (peeked, item2, "the peeked packet is not the dequeued one");
+          if (item1)
+            {
+              NS_TEST_ASSERT_MSG_EQ (item1->GetPacket (), item2->GetPacket (), "the queue discs dequeued different packets");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (fifo->QueueDisc::GetNPackets (), lightweight->QueueDisc::GetNPackets (), "the numbers of packets differ");
+      NS_TEST_ASSERT_MSG_EQ (fifo->QueueDisc::GetNBytes (), lightweight->QueueDisc::GetNBytes (), "the backlogs differ");
+    }
+
+  NS_TEST_EXPECT_MSG_GT (lightweight->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP), 0, "no packet has been stolen");
+  NS_TEST_EXPECT_MSG_EQ (fifo->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP),
+                         lightweight->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP),
+                         "the queue discs stole a different number of packets");
+  NS_TEST_EXPECT_MSG_EQ (fifo->GetNQueueDiscClasses (), lightweight->GetNQueueDiscClasses (),
+                         "the queue discs created a different number of flow queues");
+  for (uint32_t i = 0; i < lightweight->GetNQueueDiscClasses (); i++)
+    {
+      Ptr<DRRFlow> flow = StaticCast<DRRFlow> (lightweight->GetQueueDiscClass (i));
+      NS_TEST_EXPECT_MSG_EQ (flow->GetQueueDisc (), 0, "a lightweight flow queue should have no queue disc");
+      NS_TEST_EXPECT_MSG_NE (flow->GetQueue (), 0, "a lightweight flow queue should have a queue");
+    }
+  NS_TEST_EXPECT_MSG_LT (lightweight->GetMemoryFootprint (), fifo->GetMemoryFootprint (),
+                         "lightweight flow queues should use less memory than FIFO queue discs");
+
+  while (Ptr<QueueDiscItem> item1 = fifo->Dequeue ())
+    {
+      Ptr<QueueDiscItem> item2 = lightweight->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item2, 0, "the queue disc with lightweight flows is empty too early");
+      NS_TEST_ASSERT_MSG_EQ (item1->GetPacket (), item2->GetPacket (), "the queue discs dequeued different packets");
+    }
+  NS_TEST_ASSERT_MSG_EQ (lightweight->Dequeue (), 0, "the queue disc with lightweight flows is not empty");
+
+  NS_TEST_EXPECT_MSG_EQ (fifo->GetStats ().nTotalEnqueuedPackets, lightweight->GetStats ().nTotalEnqueuedPackets,
+                         "the queue discs enqueued a different number of packets");
+  NS_TEST_EXPECT_MSG_EQ (fifo->GetStats ().nTotalDequeuedPackets, lightweight->GetStats ().nTotalDequeuedPackets,
+                         "the queue discs dequeued a different number of packets");
+
+  fifo->Dispose ();
+  lightweight->Dispose ();
+}
+
+void
+DRRQueueDiscLightweightFlows::DoRun (void)
+{
+  RunDifferentialTest (4, false);
+  RunDifferentialTest (50, false);
+  RunDifferentialTest (50, true);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests the statistics of the flows, their snapshot and sampling,
+ * and the Jain's fairness index
+ */
+
+class DRRQueueDiscFlowStats : public TestCase
+{
+public:
+  DRRQueueDiscFlowStats ();
+  virtual ~DRRQueueDiscFlowStats ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet
+   * \param queue the queue disc
+   * \param dst the last byte of the destination address, identifying the flow
+   * \param size the size of the queue disc item
+   */
+  void AddPacket (Ptr<DRRQueueDisc> queue, uint8_t dst, uint32_t size);
+  /**
+   * Check the statistics of the flows served by the round robin
+   * \param skipRounds whether the queue disc skips rounds
+   */
+  void RunFlowStatsTest (bool skipRounds);
+};
+
+DRRQueueDiscFlowStats::DRRQueueDiscFlowStats ()
+  : TestCase ("Test the statistics of the flows")
+{
+}
+
+DRRQueueDiscFlowStats::~DRRQueueDiscFlowStats ()
+{
+}
+
+void
+DRRQueueDiscFlowStats::AddPacket (Ptr<DRRQueueDisc> queue, uint8_t dst, uint32_t size)
+{
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + dst));
+  hdr.SetProtocol (7);
+  // the size of the queue disc items is the size of the packet plus 20 bytes
+  hdr.SetPayloadSize (size - 20);
+  Address dest;
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (size - 20), dest, 0, hdr));
+}
+
+void
+DRRQueueDiscFlowStats::RunFlowStatsTest (bool skipRounds)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("SkipRounds", BooleanValue (skipRounds));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (queueDisc->GetJainFairnessIndex (), 0, "no flow has been served yet");
+
+  // flow 1 holds three packets, flow 2 one packet. Flow 1 is served in three
+  // rounds, flow 2 in the first one
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      AddPacket (queueDisc, 1, 600);
+    }
+  AddPacket (queueDisc, 2, 600);
+  while (queueDisc->Dequeue ())
+    {
+    }
+
+  std::vector<DRRQueueDisc::FlowSnapshot> snapshot = queueDisc->GetFlowsSnapshot ();
+  NS_TEST_ASSERT_MSG_EQ (snapshot.size (), 2, "two flows should have been created");
+  // the flows are created in the order their first packet is enqueued
+  const DRRFlow::Stats &stats1 = snapshot[0].stats;
+  const DRRFlow::Stats &stats2 = snapshot[1].stats;
+  NS_TEST_EXPECT_MSG_EQ (stats1.nServedPackets, 3, "flow 1 should have sent three packets");
+  NS_TEST_EXPECT_MSG_EQ (stats1.nServedBytes, 1800, "flow 1 should have sent 1800 bytes");
+  NS_TEST_EXPECT_MSG_EQ (stats1.maxBacklog, 1800, "the largest backlog of flow 1 should be 1800 bytes");
+  NS_TEST_EXPECT_MSG_EQ (stats1.nRoundsWaited, 3, "flow 1 should have been served in three rounds");
+  NS_TEST_EXPECT_MSG_EQ (stats2.nServedPackets, 1, "flow 2 should have sent one packet");
+  NS_TEST_EXPECT_MSG_EQ (stats2.nServedBytes, 600, "flow 2 should have sent 600 bytes");
+  NS_TEST_EXPECT_MSG_EQ (stats2.nRoundsWaited, 1, "flow 2 should have been served in one round");
+  NS_TEST_EXPECT_MSG_EQ (snapshot[0].status, DRRFlow::INACTIVE, "flow 1 should be inactive");
+  NS_TEST_EXPECT_MSG_EQ (snapshot[0].backlog, 0, "flow 1 should be empty");
+
+  // (1800 + 600)^2 / (2 * (1800^2 + 600^2))
+  NS_TEST_EXPECT_MSG_EQ_TOL (queueDisc->GetJainFairnessIndex (), 0.8, 1e-9, "unexpected fairness index");
+
+  queueDisc->Dispose ();
+}
+
+void
+DRRQueueDiscFlowStats::DoRun (void)
+{
+  RunFlowStatsTest (false);
+  RunFlowStatsTest (true);
+
+  // the packets dropped because the byte limit is exceeded are stolen from the fat flow
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (1500));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->Initialize ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      AddPacket (queueDisc, 1, 600);
+    }
+  AddPacket (queueDisc, 2, 500);
+  const DRRFlow::Stats &stats = StaticCast<DRRFlow> (queueDisc->GetQueueDiscClass (0))->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nStolenPackets, 2, "two packets should have been stolen from flow 1");
+  NS_TEST_EXPECT_MSG_EQ (stats.nStolenBytes, 1200, "1200 bytes should have been stolen from flow 1");
+  NS_TEST_EXPECT_MSG_EQ (stats.maxBacklog, 1800, "the largest backlog of flow 1 should be 1800 bytes");
+
+  // the flows are sampled now and then every interval, a line per flow
+  std::ostringstream csv;
+  Ptr<DRRFlowStatsSampler> sampler = CreateObjectWithAttributes<DRRFlowStatsSampler> ("Interval", TimeValue (Seconds (1)));
+  sampler->Start (queueDisc, Create<OutputStreamWrapper> (&csv));
+  Simulator::Stop (Seconds (2.5));
+  Simulator::Run ();
+  sampler->Dispose ();
+
+  std::istringstream lines (csv.str ());
+  std::string line;
+  std::string lastLine;
+  uint32_t nLines = 0;
+  while (std::getline (lines, line))
+    {
+      lastLine = line;
+      nLines++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nLines, 1 + 3 * 2, "a header and a line per flow for each of the three samples");
+  NS_TEST_EXPECT_MSG_EQ (lastLine.substr (0, 4), "2,1,", "the last line should be the one of the second flow at 2 s");
+
+  std::ostringstream bin;
+  sampler = CreateObjectWithAttributes<DRRFlowStatsSampler> ("Interval", TimeValue (Seconds (1)),
+                                                             "Binary", BooleanValue (true));
+  sampler->Start (queueDisc, Create<OutputStreamWrapper> (&bin));
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+  sampler->Dispose ();
+  NS_TEST_EXPECT_MSG_EQ (bin.str ().size (), 2 * 2 * DRRFlowStatsSampler::BINARY_RECORD_SIZE,
+                         "a record per flow for each of the two samples");
+
+  queueDisc->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * This class tests that peeking a DRR queue disc returns the packet that the
+ * next dequeue returns, that peeking does not change the dequeue order and that
+ * a DRR queue disc used as the child of a TBF queue disc (which peeks its child
+ * before dequeuing) serves the flows in the same order as a standalone one,
+ * without packets being held outside the flow queues
+ */
+
+class DRRQueueDiscPeek : public TestCase
+{
+public:
+  DRRQueueDiscPeek ();
+  virtual ~DRRQueueDiscPeek ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a DRR queue disc
+   * \param skipRounds whether the queue disc skips rounds
+   * \return the queue disc
+   */
+  Ptr<DRRQueueDisc> CreateQueueDisc (bool skipRounds);
+  /**
+   * Create a queue disc item
+   * \param flow the flow
+   * \param size the size of the packet
+   * \return the queue disc item
+   */
+  Ptr<QueueDiscItem> CreateItem (uint32_t flow, uint32_t size);
+  /**
+   * Check that peeking preserves the dequeue order and returns the packet
+   * the next dequeue returns, even if packets are enqueued in between
+   * \param skipRounds whether the queue disc skips rounds
+   */
+  void RunPeekTest (bool skipRounds);
+  /**
+   * Check the dequeue order of a DRR queue disc used as the child of a TBF
+   * \param skipRounds whether the queue disc skips rounds
+   */
+  void RunTbfChildTest (bool skipRounds);
+  /**
+   * Store a packet transmitted by the TBF queue disc and check that all the
+   * packets stored in the DRR queue disc are in the flow queues
+   * \param item the transmitted packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+  /**
+   * Check that all the packets stored in the DRR queue disc are in the flow queues
+   */
+  void CheckNoHeldPacket (void);
+
+  Ptr<UniformRandomVariable> m_rng;          //!< Random variable
+  Ptr<DRRQueueDisc> m_child;                 //!< The DRR queue disc child of the TBF
+  std::vector<Ptr<Packet> > m_sent;          //!< Packets transmitted by the TBF
+};
+
+DRRQueueDiscPeek::DRRQueueDiscPeek ()
+  : TestCase ("Test peeking a DRR queue disc")
+{
+}
+
+DRRQueueDiscPeek::~DRRQueueDiscPeek ()
+{
+}
+
+Ptr<DRRQueueDisc>
+DRRQueueDiscPeek::CreateQueueDisc (bool skipRounds)
+{
+  Ptr<DRRQueueDisc> queueDisc = CreateObjectWithAttributes<DRRQueueDisc> ("ByteLimit", UintegerValue (20000),
+                                                                         "SkipRounds", BooleanValue (skipRounds));
+  queueDisc->AddPacketFilter (CreateObject<DRRIpv4PacketFilter> ());
+  queueDisc->SetQuantum (600);
+  queueDisc->SetDscpLatencyCritical (Ipv4Header::DSCP_EF, true);
+  return queueDisc;
+}
+
+Ptr<QueueDiscItem>
+DRRQueueDiscPeek::CreateItem (uint32_t flow, uint32_t size)
+{
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.10.1.1"));
+  hdr.SetDestination (Ipv4Address (0x0a0a0200 + flow));
+  hdr.SetProtocol (7);
+  // one flow out of eight is latency-critical
+  hdr.SetDscp (flow % 8 ? Ipv4Header::DscpDefault : Ipv4Header::DSCP_EF);
+  hdr.SetPayloadSize (size);
+  Address dest;
+  return Create<Ipv4QueueDiscItem> (Create<Packet> (size), dest, 0, hdr);
+}
+
+void
+DRRQueueDiscPeek::RunPeekTest (bool skipRounds)
+{
+  Ptr<DRRQueueDisc> peeking = CreateQueueDisc (skipRounds);
+  Ptr<DRRQueueDisc> reference = CreateQueueDisc (skipRounds);
+  peeking->Initialize ();
+  reference->Initialize ();
+
+  // the queue discs are peeked before every dequeue, but never before an
+  // enqueue, which may change the next packet to dequeue
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      if (m_rng->GetValue () < 0.55)
+        {
+          Ptr<QueueDiscItem> item = CreateItem (m_rng->GetInteger (0, 19), m_rng->GetInteger (40, 1500));
+          peeking->Enqueue (item);
+          reference->Enqueue (Create<Ipv4QueueDiscItem> (item->GetPacket (), item->GetAddress (), 0,
+                                                         DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ()));
+        }
+      else
+        {
+          Ptr<const QueueDiscItem> peeked = peeking->Peek ();
+          NS_TEST_ASSERT_MSG_EQ (peeking->Peek (), peeked, "peeking twice returned different packets");
+          Ptr<QueueDiscItem> item1 = peeking->Dequeue ();
+          Ptr<QueueDiscItem> item2 = reference->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (item1, peeked, "the dequeued packet is not the peeked one");
+          NS_TEST_ASSERT_MSG_EQ ((item1 == 0), (item2 == 0), "only one queue disc dequeued a packet");
+          if (item1)
+            {
+              NS_TEST_ASSERT_MSG_EQ (item1->GetPacket (), item2->GetPacket (), "peeking changed the dequeue order");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (peeking->GetNBytes (), reference->GetNBytes (), "the backlogs differ");
+    }
+  NS_TEST_EXPECT_MSG_GT (peeking->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP), 0, "no packet has been stolen");
+
+  // now the packets are also enqueued between a peek and the next dequeue,
+  // possibly stealing the peeked packet
+  uint32_t enqueued = 0;
+  uint32_t dequeued = 0;
+  uint32_t dropped = peeking->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP);
+  Ptr<const QueueDiscItem> peeked;
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      double op = m_rng->GetValue ();
+      if (op < 0.4)
+        {
+          peeking->Enqueue (CreateItem (m_rng->GetInteger (0, 19), m_rng->GetInteger (40, 1500)));
+          enqueued++;
+          peeked = 0;
+        }
+      else if (op < 0.7)
+        {
+          peeked = peeking->Peek ();
+        }
+      else
+        {
+          Ptr<QueueDiscItem> item = peeking->Dequeue ();
+          if (peeked)
+            {
+              NS_TEST_ASSERT_MSG_EQ (item, peeked, "the dequeued packet is not the peeked one");
+            }
+          peeked = 0;
+          dequeued += (item ? 1 : 0);
+        }
+    }
+  while (peeking->Peek ())
+    {
+      NS_TEST_ASSERT_MSG_NE (peeking->Dequeue (), 0, "a packet was peeked but none was dequeued");
+      dequeued++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (peeking->GetNPackets (), 0, "the queue disc is not empty");
+  NS_TEST_EXPECT_MSG_EQ (dequeued + peeking->GetStats ().GetNDroppedPackets (DRRQueueDisc::OVERLIMIT_DROP),
+                         enqueued + dropped + reference->GetNPackets (), "packets have been lost or duplicated");
+
+  peeking->Dispose ();
+  reference->Dispose ();
+}
+
+void
+DRRQueueDiscPeek::Send (Ptr<QueueDiscItem> item)
+{
+  m_sent.push_back (item->GetPacket ());
+  CheckNoHeldPacket ();
+}
+
+void
+DRRQueueDiscPeek::CheckNoHeldPacket (void)
+{
+  uint32_t nPackets = 0;
+  for (uint32_t i = 0; i < m_child->GetNQueueDiscClasses (); i++)
+    {
+      Ptr<QueueDisc> qd = m_child->GetQueueDiscClass (i)->GetQueueDisc ();
+      nPackets += (qd ? qd->GetNPackets () : 0);
+    }
+  NS_TEST_EXPECT_MSG_EQ (nPackets, m_child->GetNPackets (), "a packet is held outside the flow queues");
+}
+
+void
+DRRQueueDiscPeek::RunTbfChildTest (bool skipRounds)
+{
+  m_child = CreateQueueDisc (skipRounds);
+  Ptr<DRRQueueDisc> reference = CreateQueueDisc (skipRounds);
+  // no packet is dropped, neither by the queue discs nor by the flow queues
+  // (CoDel would drop the packets waiting for the TBF to be allowed to send)
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::FifoQueueDisc");
+  m_child->SetAttribute ("ByteLimit", UintegerValue (200000));
+  m_child->SetAttribute ("FlowQueueDisc", ObjectFactoryValue (factory));
+  reference->SetAttribute ("ByteLimit", UintegerValue (200000));
+  reference->SetAttribute ("FlowQueueDisc", ObjectFactoryValue (factory));
+  Ptr<TbfQueueDisc> tbf = CreateObjectWithAttributes<TbfQueueDisc> ("MaxSize", QueueSizeValue (QueueSize ("1000p")),
+                                                                    "Burst", UintegerValue (3000),
+                                                                    "Mtu", UintegerValue (1500),
+                                                                    "Rate", DataRateValue (DataRate ("1Mbps")));
+  Ptr<QueueDiscClass> c = CreateObject<QueueDiscClass> ();
+  c->SetQueueDisc (m_child);
+  tbf->AddQueueDiscClass (c);
+  tbf->SetSendCallback ([this] (Ptr<QueueDiscItem> item) { Send (item); });
+  tbf->Initialize ();
+  reference->Initialize ();
+
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<QueueDiscItem> item = CreateItem (m_rng->GetInteger (0, 9), m_rng->GetInteger (40, 1500));
+      tbf->Enqueue (item);
+      // the header is added to the packets transmitted by the TBF, hence the
+      // standalone queue disc stores copies of the packets
+      reference->Enqueue (Create<Ipv4QueueDiscItem> (item->GetPacket ()->Copy (), item->GetAddress (), 0,
+                                                     DynamicCast<Ipv4QueueDiscItem> (item)->GetHeader ()));
+    }
+
+  // the TBF transmits the packets it is allowed to and then, whenever it is
+  // blocked, having peeked the DRR queue disc, schedules its next run
+  m_sent.clear ();
+  tbf->Run ();
+  for (uint32_t t = 1; t <= 1000; t++)
+    {
+      Simulator::Schedule (MilliSeconds (t), &DRRQueueDiscPeek::CheckNoHeldPacket, this);
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (tbf->GetNPackets (), 0, "the TBF queue disc is not empty");
+  NS_TEST_ASSERT_MSG_EQ (m_sent.size (), 100, "not all the packets have been transmitted");
+  for (uint32_t i = 0; i < m_sent.size (); i++)
+    {
+      Ptr<QueueDiscItem> item = reference->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (item, 0, "the standalone queue disc is empty too early");
+      NS_TEST_ASSERT_MSG_EQ (m_sent[i]->GetUid (), item->GetPacket ()->GetUid (), "the TBF changed the order the flows are served in");
+    }
+
+  tbf->Dispose ();
+  reference->Dispose ();
+  m_child = 0;
+  Simulator::Destroy ();
+}
+
+void
+DRRQueueDiscPeek::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  RunPeekTest (false);
+  RunPeekTest (true);
+  RunTbfChildTest (false);
+  RunTbfChildTest (true);
+
+  Simulator::Destroy ();
+}
+
 class DRRQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -586,6 +2507,21 @@ DRRQueueDiscTestSuite::DRRQueueDiscTestSuite ()
   AddTestCase (new DRRQueueDiscUDPFlowsSeparation, TestCase::QUICK);
   AddTestCase (new DRRQueueDiscDeficitVariableSizeSameFlow, TestCase::QUICK);
   AddTestCase (new DRRQueueDiscDeficitVariableSizeDifferentFlow, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscFatFlowSelection, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscDropBatch, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscFlowReuse, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscSkipRoundsEquivalence, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscFlowQueueDiscType, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscWeightedFairness, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscTransportPorts, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscHashPerturbation, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscSetAssociativeFlowTable, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscMultiQueue, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscLatencyCritical, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscIdleFlows, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscLightweightFlows, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscFlowStats, TestCase::QUICK);
+  AddTestCase (new DRRQueueDiscPeek, TestCase::QUICK);
 
 
 }
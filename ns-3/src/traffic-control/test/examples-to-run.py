@@ -38,6 +38,7 @@ cpp_examples = [
     ("red-vs-ared --queueDiscType=RED --modeBytes=true", "True", "False"),
     ("red-vs-ared --queueDiscType=ARED", "True", "True"),
     ("red-vs-ared --queueDiscType=ARED --modeBytes=true", "True", "False"),
+    ("drr-benchmark --minFlows=16 --maxFlows=16 --packets=2000 --childFlows=64 --minTableFlows=100 --maxTableFlows=100 --maxWays=2", "True", "False"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
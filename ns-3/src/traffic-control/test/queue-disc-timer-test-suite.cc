@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/queue-disc-timer.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Timer Test Case
+ *
+ * Timers are scheduled with random delays spanning several levels of the
+ * timer wheel, some of them are cancelled and some are scheduled again when
+ * they expire. Checks that every timer expires at its expiration time rounded
+ * up to the granularity of the wheel, that the cancelled timers do not expire,
+ * and that the wheel executes a simulator event per distinct expiration time.
+ */
+class QueueDiscTimerTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param granularity the granularity of the timer wheel
+   * \param wheel whether the timers are stored in a timer wheel
+   */
+  QueueDiscTimerTestCase (Time granularity, bool wheel);
+  virtual ~QueueDiscTimerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The state of a timer
+  struct TimerState
+  {
+    QueueDiscTimerTestCase *test;  //!< the test case
+    uint32_t index;                //!< the index of the timer
+    Time expected;                 //!< the expected expiration time
+    uint32_t reschedules;          //!< the number of times the timer is still to be scheduled again
+    bool cancelled;                //!< whether the timer has been cancelled
+    bool expired;                  //!< whether the timer has expired when expected
+  };
+
+  /**
+   * Invoked when a timer expires
+   * \param state the state of the timer
+   */
+  static void Expired (TimerState *state);
+  /**
+   * Schedule a timer with a random delay
+   * \param index the index of the timer
+   */
+  void ScheduleTimer (uint32_t index);
+  /**
+   * Cancel a timer
+   * \param index the index of the timer
+   */
+  void CancelTimer (uint32_t index);
+
+  Time m_granularity;                     //!< the granularity of the timer wheel
+  bool m_wheel;                           //!< whether the timers are stored in a timer wheel
+  std::vector<QueueDiscTimer*> m_timers;  //!< the timers
+  std::vector<TimerState> m_states;       //!< the state of the timers
+  std::set<int64_t> m_expirations;        //!< the distinct expiration times
+  Ptr<UniformRandomVariable> m_delay;     //!< the random delays
+  uint32_t m_nErrors;                     //!< the number of timers not expiring when expected
+};
+
+QueueDiscTimerTestCase::QueueDiscTimerTestCase (Time granularity, bool wheel)
+  : TestCase ("Test the expiration of the queue disc timers"),
+    m_granularity (granularity),
+    m_wheel (wheel),
+    m_nErrors (0)
+{
+}
+
+QueueDiscTimerTestCase::~QueueDiscTimerTestCase ()
+{
+}
+
+void
+QueueDiscTimerTestCase::Expired (TimerState *state)
+{
+  QueueDiscTimerTestCase *test = state->test;
+  if (state->cancelled || Simulator::Now () != state->expected)
+    {
+      test->m_nErrors++;
+    }
+  test->m_expirations.insert (Simulator::Now ().GetTimeStep ());
+
+  if (state->reschedules > 0)
+    {
+      state->reschedules--;
+      test->ScheduleTimer (state->index);
+    }
+  else
+    {
+      state->expired = true;
+    }
+}
+
+void
+QueueDiscTimerTestCase::ScheduleTimer (uint32_t index)
+{
+  // short delays (within the first levels), long delays and no delay
+  Time delay;
+  switch (index % 3)
+    {
+    case 0:
+      delay = NanoSeconds (m_delay->GetInteger (0, 5000));
+      break;
+    case 1:
+      delay = MicroSeconds (m_delay->GetInteger (0, 10000000));
+      break;
+    default:
+      delay = Seconds (0);
+    }
+
+  int64_t expiry = (Simulator::Now () + delay).GetTimeStep ();
+  int64_t steps = m_granularity.GetTimeStep ();
+  m_states[index].expected = TimeStep ((expiry + steps - 1) / steps * steps);
+  m_timers[index]->Schedule (delay);
+}
+
+void
+QueueDiscTimerTestCase::CancelTimer (uint32_t index)
+{
+  if (m_timers[index]->IsRunning ())
+    {
+      m_timers[index]->Cancel ();
+      m_states[index].cancelled = true;
+    }
+}
+
+void
+QueueDiscTimerTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::QueueDiscTimerWheel::Granularity", TimeValue (m_granularity));
+  GlobalValue::Bind ("QueueDiscTimerWheel", BooleanValue (m_wheel));
+
+  const uint32_t nTimers = 1000;
+  m_delay = CreateObject<UniformRandomVariable> ();
+  m_delay->SetStream (1);
+  m_states.resize (nTimers);
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      m_timers.push_back (new QueueDiscTimer);
+      m_states[i] = {this, i, Seconds (0), i % 4, false, false};
+      m_timers[i]->SetFunction (MakeBoundCallback (&QueueDiscTimerTestCase::Expired, &m_states[i]));
+      Simulator::Schedule (MicroSeconds (i), &QueueDiscTimerTestCase::ScheduleTimer, this, i);
+      if (i % 7 == 0)
+        {
+          Simulator::Schedule (Seconds (1) + MicroSeconds (i), &QueueDiscTimerTestCase::CancelTimer, this, i);
+        }
+    }
+
+  Simulator::Run ();
+
+  uint32_t nCancelled = 0;
+  uint32_t nExpired = 0;
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_timers[i]->IsRunning (), false, "No timer should be running");
+      nCancelled += m_states[i].cancelled ? 1 : 0;
+      nExpired += m_states[i].expired ? 1 : 0;
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nErrors, 0, "Timers expired at an unexpected time");
+  NS_TEST_EXPECT_MSG_GT (nCancelled, 0, "Some timers should have been cancelled");
+  NS_TEST_EXPECT_MSG_EQ (nCancelled + nExpired, nTimers, "Every timer should be cancelled or expire");
+
+  if (m_wheel)
+    {
+      Ptr<QueueDiscTimerWheel> wheel = QueueDiscTimerWheel::GetWheel ();
+      NS_TEST_EXPECT_MSG_EQ (wheel->GetNTimers (), 0, "No timer should be stored in the wheel");
+      NS_TEST_EXPECT_MSG_EQ (wheel->GetNEvents (), m_expirations.size (),
+                             "The wheel should execute an event per distinct expiration time");
+    }
+
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      delete m_timers[i];
+    }
+  m_timers.clear ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("QueueDiscTimerWheel", BooleanValue (false));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Timer Order Test Case
+ *
+ * Timers are scheduled at different times to expire at the same time, while
+ * another timer expiring periodically moves the current tick of the timer
+ * wheel, so that the first timers are cascaded from the upper levels and the
+ * last ones are stored directly in the first level. Checks that the timers
+ * expire in the order they were scheduled, as with a simulator event each.
+ */
+class QueueDiscTimerOrderTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param granularity the granularity of the timer wheel
+   * \param wheel whether the timers are stored in a timer wheel
+   */
+  QueueDiscTimerOrderTestCase (Time granularity, bool wheel);
+  virtual ~QueueDiscTimerOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Invoked when a timer expires
+   * \param test the test case
+   * \param index the index of the timer
+   */
+  static void Expired (QueueDiscTimerOrderTestCase *test, uint32_t index);
+  /**
+   * Invoked when the periodic timer expires
+   */
+  void Tick (void);
+  /**
+   * Schedule a timer to expire at the expiration time of all the timers
+   * \param index the index of the timer
+   */
+  void ScheduleTimer (uint32_t index);
+
+  Time m_granularity;                     //!< the granularity of the timer wheel
+  bool m_wheel;                           //!< whether the timers are stored in a timer wheel
+  std::vector<QueueDiscTimer*> m_timers;  //!< the timers
+  QueueDiscTimer m_ticker;                //!< the periodic timer
+  std::vector<uint32_t> m_order;          //!< the indices of the timers, in the order they expired
+};
+
+QueueDiscTimerOrderTestCase::QueueDiscTimerOrderTestCase (Time granularity, bool wheel)
+  : TestCase ("Test the order of the queue disc timers expiring at the same time"),
+    m_granularity (granularity),
+    m_wheel (wheel)
+{
+}
+
+QueueDiscTimerOrderTestCase::~QueueDiscTimerOrderTestCase ()
+{
+}
+
+void
+QueueDiscTimerOrderTestCase::Expired (QueueDiscTimerOrderTestCase *test, uint32_t index)
+{
+  test->m_order.push_back (index);
+}
+
+void
+QueueDiscTimerOrderTestCase::Tick (void)
+{
+  if (Simulator::Now () < Seconds (2))
+    {
+      m_ticker.Schedule (MilliSeconds (1));
+    }
+}
+
+void
+QueueDiscTimerOrderTestCase::ScheduleTimer (uint32_t index)
+{
+  m_timers[index]->Schedule (Seconds (1) - Simulator::Now ());
+}
+
+void
+QueueDiscTimerOrderTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::QueueDiscTimerWheel::Granularity", TimeValue (m_granularity));
+  GlobalValue::Bind ("QueueDiscTimerWheel", BooleanValue (m_wheel));
+
+  const uint32_t nTimers = 100;
+  m_ticker.SetFunction (MakeCallback (&QueueDiscTimerOrderTestCase::Tick, this));
+  Simulator::ScheduleNow (&QueueDiscTimerOrderTestCase::Tick, this);
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      m_timers.push_back (new QueueDiscTimer);
+      m_timers[i]->SetFunction (MakeBoundCallback (&QueueDiscTimerOrderTestCase::Expired, this, i));
+      Simulator::Schedule (MicroSeconds (i * i * 100), &QueueDiscTimerOrderTestCase::ScheduleTimer, this, i);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), nTimers, "Every timer should expire");
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], i, "The timers should expire in the order they were scheduled");
+    }
+
+  for (uint32_t i = 0; i < nTimers; i++)
+    {
+      delete m_timers[i];
+    }
+  m_timers.clear ();
+  Simulator::Destroy ();
+  GlobalValue::Bind ("QueueDiscTimerWheel", BooleanValue (false));
+  Config::Reset ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Queue Disc Timer Test Suite
+ */
+static class QueueDiscTimerTestSuite : public TestSuite
+{
+public:
+  QueueDiscTimerTestSuite ()
+    : TestSuite ("queue-disc-timer", UNIT)
+  {
+    AddTestCase (new QueueDiscTimerTestCase (TimeStep (1), true), TestCase::QUICK);
+    AddTestCase (new QueueDiscTimerTestCase (MicroSeconds (100), true), TestCase::QUICK);
+    AddTestCase (new QueueDiscTimerTestCase (TimeStep (1), false), TestCase::QUICK);
+    AddTestCase (new QueueDiscTimerOrderTestCase (TimeStep (1), true), TestCase::QUICK);
+    AddTestCase (new QueueDiscTimerOrderTestCase (MicroSeconds (100), true), TestCase::QUICK);
+    AddTestCase (new QueueDiscTimerOrderTestCase (TimeStep (1), false), TestCase::QUICK);
+  }
+} g_queueDiscTimerTestSuite; ///< the test suite
@@ -555,6 +555,28 @@ QueueDiscTracesTestCase::DoRun (void)
   CheckDroppedBeforeEnqueue (child, 1, pktSizeUnit * 5);
   CheckDroppedAfterDequeue (child, 2, pktSizeUnit * 3);
 
+  // Check the packets and bytes dropped for each reason. The packets dropped by
+  // the child queue disc are dropped by the root queue disc for a reason made
+  // of the CHILD_QUEUE_DISC_DROP prefix followed by the reason of the child
+  QueueDisc::Stats childStats = child->GetStats ();
+  QueueDisc::Stats rootStats = root->GetStats ();
+  std::string prefix = QueueDisc::CHILD_QUEUE_DISC_DROP;
+
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the packets dropped for each reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedBytes (TestChildQueueDisc::AFTER_DEQUEUE), pktSizeUnit * 3,
+                         "Verify that the bytes dropped for each reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedPackets (prefix + TestChildQueueDisc::BEFORE_ENQUEUE), 1,
+                         "Verify that the packets dropped for each reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedBytes (prefix + TestChildQueueDisc::BEFORE_ENQUEUE), pktSizeUnit * 5,
+                         "Verify that the bytes dropped for each reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.GetNDroppedPackets (prefix + TestChildQueueDisc::AFTER_DEQUEUE), 2,
+                         "Verify that the packets dropped for each reason are counted correctly");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.nDroppedPacketsBeforeEnqueue.size (), 1,
+                         "Verify that only the reasons packets were dropped for are reported");
+  NS_TEST_EXPECT_MSG_EQ (rootStats.nDroppedBytesAfterDequeue.size (), 1,
+                         "Verify that only the reasons packets were dropped for are reported");
+
   Simulator::Destroy ();
 }
 
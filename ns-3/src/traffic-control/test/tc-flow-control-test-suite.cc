@@ -34,6 +34,7 @@
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
 #include "ns3/config.h"
+#include <map>
 
 using namespace ns3;
 
@@ -363,6 +364,236 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ *
+ * Ten packets are enqueued in the root queue disc, which is then run once.
+ * Checks the number of packets sent to the device, which depends on the quota,
+ * on the BulkDequeueLimit and on the room left in the device queue.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param tt the test type
+   * \param bulkLimit the value of the BulkDequeueLimit attribute of the root queue disc
+   * \param quota the quota of the root queue disc
+   * \param devPackets the expected number of packets in the device queue
+   * \param qdiscPackets the expected number of packets in the queue disc
+   */
+  TcBulkDequeueTestCase (QueueSizeUnit tt, uint32_t bulkLimit, uint32_t quota,
+                         uint32_t devPackets, uint32_t qdiscPackets);
+  virtual ~TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue the given number of packets in the queue disc and run it
+   * \param qdisc the queue disc
+   * \param nPackets the number of packets to enqueue
+   */
+  void EnqueueAndRun (Ptr<QueueDisc> qdisc, uint16_t nPackets);
+  /**
+   * Check the number of packets in the device queue and in the queue disc
+   * \param dev the device
+   * \param qdisc the queue disc
+   */
+  void CheckPackets (Ptr<NetDevice> dev, Ptr<QueueDisc> qdisc);
+  QueueSizeUnit m_type;       //!< the test type
+  uint32_t m_bulkLimit;       //!< the BulkDequeueLimit of the queue disc
+  uint32_t m_quota;           //!< the quota of the queue disc
+  uint32_t m_devPackets;      //!< the expected number of packets in the device queue
+  uint32_t m_qdiscPackets;    //!< the expected number of packets in the queue disc
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase (QueueSizeUnit tt, uint32_t bulkLimit, uint32_t quota,
+                                              uint32_t devPackets, uint32_t qdiscPackets)
+  : TestCase ("Test the bulk dequeue of packets sent to the device in bursts"),
+    m_type (tt),
+    m_bulkLimit (bulkLimit),
+    m_quota (quota),
+    m_devPackets (devPackets),
+    m_qdiscPackets (qdiscPackets)
+{
+}
+
+TcBulkDequeueTestCase::~TcBulkDequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueTestCase::EnqueueAndRun (Ptr<QueueDisc> qdisc, uint16_t nPackets)
+{
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      qdisc->Enqueue (Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+  qdisc->Run ();
+}
+
+void
+TcBulkDequeueTestCase::CheckPackets (Ptr<NetDevice> dev, Ptr<QueueDisc> qdisc)
+{
+  PointerValue ptr;
+  dev->GetAttributeFailSafe ("TxQueue", ptr);
+  Ptr<Queue<Packet> > queue = ptr.Get<Queue<Packet> > ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), m_devPackets,
+                         "Unexpected number of packets in the device queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 0,
+                         "A burst must not overflow the device queue");
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetNPackets (), m_qdiscPackets,
+                         "Unexpected number of packets in the queue disc");
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize",
+                   StringValue (m_type == QueueSizeUnit::PACKETS ? "5p" : "5000B"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+  txDev->SetMtu (2500);
+
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  QueueDiscContainer qdiscs = tch.Install (txDev);
+  Ptr<QueueDisc> qdisc = qdiscs.Get (0);
+  qdisc->SetAttribute ("BulkDequeueLimit", UintegerValue (m_bulkLimit));
+  qdisc->SetQuota (m_quota);
+
+  // The transmission of each packet takes 1000B/1Mbps = 8ms, hence after 1ms
+  // the packet sent first is still being transmitted
+  Simulator::Schedule (Time (Seconds (0)), &TcBulkDequeueTestCase::EnqueueAndRun,
+                       this, qdisc, 10);
+  Simulator::Schedule (Time (MilliSeconds (1)), &TcBulkDequeueTestCase::CheckPackets,
+                       this, txDev, qdisc);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Send Burst Test Case
+ *
+ * The same packets are sent by a SimpleNetDevice through SendBurst (i.e., the
+ * default implementation of NetDevice) and by another SimpleNetDevice through
+ * SendFrom. One of the packets exceeds the MTU
+ * and the device queues are too small for the other packets. Checks that the
+ * return values, the statistics of the device queues and the packets received
+ * are the same for both devices.
+ */
+class TcSendBurstTestCase : public TestCase
+{
+public:
+  TcSendBurstTestCase ();
+  virtual ~TcSendBurstTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive callback of the device on the other end of the channel
+   * \param dev the receiving device
+   * \param p the packet received
+   * \param protocol the protocol number
+   * \param from the address of the sender
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+  std::map<Address, uint32_t> m_received;    //!< number of packets received per sender
+};
+
+TcSendBurstTestCase::TcSendBurstTestCase ()
+  : TestCase ("Test that SendBurst handles every packet as SendFrom does")
+{
+}
+
+TcSendBurstTestCase::~TcSendBurstTestCase ()
+{
+}
+
+bool
+TcSendBurstTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received[from]++;
+  return true;
+}
+
+void
+TcSendBurstTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (3);
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (2));
+  Ptr<SimpleChannel> channel = DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ());
+  rxDevC.Get (0)->SetReceiveCallback (MakeCallback (&TcSendBurstTestCase::Receive, this));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("2p"));
+
+  Ptr<NetDevice> burstDev = simple.Install (n.Get (0), channel).Get (0);
+  Ptr<NetDevice> sendDev = simple.Install (n.Get (1), channel).Get (0);
+  burstDev->SetMtu (1500);
+  sendDev->SetMtu (1500);
+
+  std::vector<NetDevice::BurstPacket> burst;
+  uint32_t nSent = 0;
+  for (uint32_t size : {1000, 1000, 2000, 1000, 1000, 1000})
+    {
+      NetDevice::BurstPacket b;
+      b.packet = Create<Packet> (size);
+      b.dest = rxDevC.Get (0)->GetAddress ();
+      b.protocolNumber = 0x0800;
+      burst.push_back (b);
+      if (sendDev->SendFrom (Create<Packet> (size), sendDev->GetAddress (), b.dest, b.protocolNumber))
+        {
+          nSent++;
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (burstDev->SendBurst (burst), nSent,
+                         "SendBurst and SendFrom returned a different number of packets sent");
+  NS_TEST_EXPECT_MSG_EQ (nSent, 5, "The packet exceeding the MTU must not be sent");
+
+  Simulator::Run ();
+
+  PointerValue ptr;
+  burstDev->GetAttribute ("TxQueue", ptr);
+  Ptr<Queue<Packet> > burstQueue = ptr.Get<Queue<Packet> > ();
+  sendDev->GetAttribute ("TxQueue", ptr);
+  Ptr<Queue<Packet> > sendQueue = ptr.Get<Queue<Packet> > ();
+
+  NS_TEST_EXPECT_MSG_EQ (burstQueue->GetTotalReceivedPackets (), sendQueue->GetTotalReceivedPackets (),
+                         "Different number of packets enqueued in the device queues");
+  NS_TEST_EXPECT_MSG_EQ (burstQueue->GetTotalDroppedPackets (), sendQueue->GetTotalDroppedPackets (),
+                         "Different number of packets dropped by the device queues");
+  NS_TEST_EXPECT_MSG_EQ (m_received[burstDev->GetAddress ()], m_received[sendDev->GetAddress ()],
+                         "Different number of packets received from the two devices");
+  NS_TEST_EXPECT_MSG_EQ (m_received[burstDev->GetAddress ()], nSent,
+                         "Every packet sent must be received");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -377,5 +608,14 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    // Bulk dequeues disabled: a single packet is sent per unit of quota
+    AddTestCase (new TcBulkDequeueTestCase (QueueSizeUnit::PACKETS, 1, 1, 0, 9), TestCase::QUICK);
+    // A burst of 4 packets is sent, the first of which is being transmitted
+    AddTestCase (new TcBulkDequeueTestCase (QueueSizeUnit::PACKETS, 4, 1, 3, 6), TestCase::QUICK);
+    // The device queue only has room for 2 MTU-sized packets, hence the burst is of 2 packets
+    AddTestCase (new TcBulkDequeueTestCase (QueueSizeUnit::BYTES, 4, 1, 1, 8), TestCase::QUICK);
+    // The bursts fill the device queue without overflowing it
+    AddTestCase (new TcBulkDequeueTestCase (QueueSizeUnit::PACKETS, 8, 64, 5, 4), TestCase::QUICK);
+    AddTestCase (new TcSendBurstTestCase, TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
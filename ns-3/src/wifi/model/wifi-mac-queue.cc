@@ -102,8 +102,10 @@ WifiMacQueue::TtlExceeded (ConstIterator &it)
     {
       NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
                     Simulator::Now () - (*it)->GetTimeStamp () << ")");
-      auto curr = it++;
-      DoRemove (curr);
+      // the removal invalidates the iterators of a ring buffer, hence the
+      // iterator of the next item is the one returned by the removal
+      auto curr = it;
+      DoRemove (curr, it);
       return true;
     }
   return false;
@@ -45,6 +45,7 @@
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
 #include "ns3/ht-configuration.h"
+#include "ns3/wifi-mac-queue.h"
 
 using namespace ns3;
 
@@ -240,6 +241,81 @@ public:
 };
 
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the removal of the packets whose lifetime has expired, while
+ *        iterating over a WifiMacQueue, with both the storages of the queue
+ */
+class WifiMacQueueTtlTest : public TestCase
+{
+public:
+  WifiMacQueueTtlTest () : TestCase ("Test the removal of the expired packets of a WifiMacQueue")
+  {
+  }
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Enqueue a packet
+   * \param queue the queue
+   * \param packet the packet
+   */
+  static void Enqueue (Ptr<WifiMacQueue> queue, Ptr<Packet> packet);
+  /**
+   * Remove the last packet, after the lifetime of the first two packets has
+   * expired, and check that only the third packet is left
+   * \param queue the queue
+   * \param packets the packets enqueued
+   */
+  void RemoveLast (Ptr<WifiMacQueue> queue, std::vector<Ptr<Packet> > packets);
+};
+
+void
+WifiMacQueueTtlTest::Enqueue (Ptr<WifiMacQueue> queue, Ptr<Packet> packet)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  queue->Enqueue (Create<WifiMacQueueItem> (packet, hdr));
+}
+
+void
+WifiMacQueueTtlTest::RemoveLast (Ptr<WifiMacQueue> queue, std::vector<Ptr<Packet> > packets)
+{
+  // the first two packets are removed while looking for the last one
+  NS_TEST_EXPECT_MSG_EQ (queue->Remove (packets[3]), true, "the last packet should be found");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 1, "only the third packet should be left");
+  Ptr<const WifiMacQueueItem> item = queue->Peek ();
+  NS_TEST_EXPECT_MSG_EQ ((item && item->GetPacket () == packets[2]), true, "the third packet should be left");
+}
+
+void
+WifiMacQueueTtlTest::DoRun (void)
+{
+  QueueStorageType storages[] = {LIST_STORAGE, RING_BUFFER_STORAGE};
+  for (QueueStorageType storage : storages)
+    {
+      Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> ();
+      queue->SetStorage (storage);
+      queue->SetMaxDelay (MilliSeconds (10));
+
+      std::vector<Ptr<Packet> > packets;
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          packets.push_back (Create<Packet> (100 + i));
+        }
+      Enqueue (queue, packets[0]);
+      Enqueue (queue, packets[1]);
+      Simulator::Schedule (MilliSeconds (15), &WifiMacQueueTtlTest::Enqueue, queue, packets[2]);
+      Simulator::Schedule (MilliSeconds (15), &WifiMacQueueTtlTest::Enqueue, queue, packets[3]);
+      Simulator::Schedule (MilliSeconds (20), &WifiMacQueueTtlTest::RemoveLast, this, queue, packets);
+      Simulator::Run ();
+      Simulator::Destroy ();
+    }
+}
+
+
 /**
  * See \bugid{991}
  */
@@ -1942,6 +2018,7 @@ WifiTestSuite::WifiTestSuite ()
 {
   AddTestCase (new WifiTest, TestCase::QUICK);
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueTtlTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new DcfImmediateAccessBroadcastTestCase, TestCase::QUICK);
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
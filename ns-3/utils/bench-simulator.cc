@@ -51,10 +51,20 @@ public:
   Bench (const uint32_t population, const uint32_t total)
     : m_population (population),
       m_total (total),
-      m_count (0)
+      m_count (0),
+      m_nTimers (0)
   {
   }
 
+  /**
+   * Set the number of timers
+   * \param timers the number of timers
+   */
+  void SetTimers (const uint32_t timers)
+  {
+    m_nTimers = timers;
+  }
+
   /**
    * Set random stream
    * \param stream the random variable stream
@@ -87,13 +97,24 @@ public:
 private:
   /// callback function
   void Cb (void);
+  /// timer expiration function
+  void Timeout (void);
 
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
   uint32_t m_total; ///< total
   uint32_t m_count; ///< count 
+  uint32_t m_nTimers; ///< number of timers
+  std::vector<EventId> m_timers; ///< timers
 };
 
+/**
+ * Delay of the timers: much longer than the event intervals, so that
+ * the timers are removed and rescheduled before they expire, like
+ * retransmission timers.
+ */
+static const Time g_timerDelay = MilliSeconds (1);
+
 void
 Bench::RunBench (void)
 {
@@ -110,6 +131,11 @@ Bench::RunBench (void)
       Time at = NanoSeconds (m_rand->GetValue ());
       Simulator::Schedule (at, &Bench::Cb, this);
     }
+  m_timers.clear ();
+  for (uint32_t i = 0; i < m_nTimers; ++i)
+    {
+      m_timers.push_back (Simulator::Schedule (g_timerDelay, &Bench::Timeout, this));
+    }
   init = time.End ();
   init /= 1000;
   DEB ("initialization took " << init << "s");
@@ -141,9 +167,21 @@ Bench::Cb (void)
 
   Time after = NanoSeconds (m_rand->GetValue ());
   Simulator::Schedule (after, &Bench::Cb, this);
+  if (m_nTimers > 0)
+    {
+      // restart one of the timers
+      EventId &timer = m_timers[m_count % m_nTimers];
+      Simulator::Remove (timer);
+      timer = Simulator::Schedule (g_timerDelay, &Bench::Timeout, this);
+    }
   ++m_count;
 }
 
+void
+Bench::Timeout (void)
+{
+}
+
 
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
@@ -155,10 +193,21 @@ GetRandomStream (std::string filename)
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
+      // the same sequence for every scheduler
+      erv->SetStream (1);
       stream = erv;
     }
   else
     {
+      // the file is only read once, for the first scheduler
+      static std::vector<double> nsValues;
+      if (!nsValues.empty ())
+        {
+          Ptr<DeterministicRandomVariable> drv = CreateObject<DeterministicRandomVariable> ();
+          drv->SetValueArray (&nsValues[0], nsValues.size ());
+          return drv;
+        }
+
       std::istream *input;
 
       if (filename == "-")
@@ -173,7 +222,6 @@ GetRandomStream (std::string filename)
         }
 
       double value;
-      std::vector<double> nsValues;
 
       while (!input->eof ())
         {
@@ -207,10 +255,13 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  uint32_t timers =      0;
   std::string filename = "";
 
   CommandLine cmd;
@@ -221,86 +272,122 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Each event schedules a new event (the hold model), hence the\n"
+             "population of pending events stays constant.\n"
+             "\n"
+             "With --timers=N, each event also removes and reschedules one\n"
+             "of N pending timers, as retransmission timers do. Set\n"
+             "--ns3::Scheduler::LazyRemove=true to only mark the removed\n"
+             "events in the event list.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "run the benchmark with each scheduler in turn", schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
+  cmd.AddValue ("timers", "number of timers removed and rescheduled (default 0)", timers);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else if (schedCal)
     {
-      factory.SetTypeId ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
     }
-  if (schedHeap)
+  else if (schedHeap)
     {
-      factory.SetTypeId ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
     }
-  if (schedList)
+  else if (schedList)
     {
-      factory.SetTypeId ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::ListScheduler");
+    }
+  else if (schedLadder)
+    {
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      schedulers.push_back ("ns3::MapScheduler");
     }
-  Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("timers: " << timers);
 
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
-
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator it = schedulers.begin (); it != schedulers.end (); it++)
     {
-      std::cout << std::setw (g_fwidth) << i;
-
+      ObjectFactory factory (*it);
+      Simulator::SetScheduler (factory);
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+
+      Bench *bench = new Bench (pop, total);
+      bench->SetTimers (timers);
+      // every scheduler gets the same sequence of event times
+      bench->SetRandomStream (GetRandomStream (filename));
+
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
-    }
 
-  LOG ("");
-  Simulator::Destroy ();
-  delete bench;
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+
+          bench->RunBench ();
+        }
+
+      LOG ("");
+      Simulator::Destroy ();
+      delete bench;
+    }
   return 0;
 }